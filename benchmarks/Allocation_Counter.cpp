@@ -0,0 +1,72 @@
+#include "Allocation_Counter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+	std::atomic<long long> liveBytes{ 0 };
+	std::atomic<long long> allocations{ 0 };
+	constexpr auto headerSize{ sizeof(std::max_align_t) };		// Keeps the returned block suitably aligned
+
+#ifdef _WIN32
+	void* AlignedAlloc(const std::size_t alignment, const std::size_t size) { return _aligned_malloc(size, alignment); }
+	void AlignedFree(void* p) { _aligned_free(p); }
+#else
+	void* AlignedAlloc(const std::size_t alignment, const std::size_t size) { return std::aligned_alloc(alignment, size); }
+	void AlignedFree(void* p) { std::free(p); }
+#endif
+}
+
+long long ALLOCATION_COUNTER::LiveBytes() { return liveBytes; }
+long long ALLOCATION_COUNTER::AllocationCount() { return allocations; }
+
+void* operator new(std::size_t size) {
+	auto block = static_cast<std::size_t*>(std::malloc(size + headerSize));
+	if (!block) { throw std::bad_alloc{ }; }
+	*block = size;
+	liveBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return reinterpret_cast<char*>(block) + headerSize;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept {
+	if (!p) { return; }
+	auto block = reinterpret_cast<std::size_t*>(static_cast<char*>(p) - headerSize);
+	liveBytes.fetch_sub(static_cast<long long>(*block), std::memory_order_relaxed);
+	std::free(block);
+}
+
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+// The header is widened to the alignment, so the size still sits just before the returned block.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	auto header = std::max(headerSize, static_cast<std::size_t>(alignment));
+	auto total = (size + header + static_cast<std::size_t>(alignment) - 1) & ~(static_cast<std::size_t>(alignment) - 1);
+	auto block = static_cast<char*>(AlignedAlloc(static_cast<std::size_t>(alignment), total));
+	if (!block) { throw std::bad_alloc{ }; }
+	reinterpret_cast<std::size_t*>(block + header)[-1] = size;
+	liveBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	return block + header;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+	if (!p) { return; }
+	liveBytes.fetch_sub(static_cast<long long>(static_cast<std::size_t*>(p)[-1]), std::memory_order_relaxed);
+	AlignedFree(static_cast<char*>(p) - std::max(headerSize, static_cast<std::size_t>(alignment)));
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept { operator delete(p, alignment); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept { operator delete(p, alignment); }
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept { operator delete(p, alignment); }
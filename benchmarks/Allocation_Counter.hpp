@@ -0,0 +1,17 @@
+/*//////////
+// Counts heap use across the benchmark executable by replacing the global operator new & delete.
+// Each block carries its size in a small header, so live bytes are exact rather than estimated.
+// Aligned allocations (over-aligned types, and the chunks memory pools take) are counted too.
+*///////////
+
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+namespace ALLOCATION_COUNTER {
+	long long LiveBytes();				// Bytes currently allocated through operator new
+	long long AllocationCount();		// Calls to operator new so far
+}
+
+#endif // !ALLOCATION_COUNTER_HPP
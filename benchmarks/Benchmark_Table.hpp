@@ -0,0 +1,43 @@
+/*//////////
+// A table that ignores every call, so benchmarks time the cell layer rather than a user interface.
+*///////////
+
+#ifndef BENCHMARK_TABLE_CLASS_HPP
+#define BENCHMARK_TABLE_CLASS_HPP
+
+#include "Cell.hpp"
+#include "Table.hpp"
+#include <span>
+#include <string>
+
+class BENCHMARK_TABLE : public TABLE_BASE {
+public:
+	void InitializeTable() override { }
+	void Redraw() const override { }
+	void Undo() const override { }
+	void Redo() const override { }
+	CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override { return CELL::CELL_PROXY{ nullptr }; }
+	void UpdateCell(const CELL::CELL_POSITION) const override { }
+	void UpdateCells(std::span<const CELL::CELL_POSITION>) const override { }
+protected:
+	void Resize() override { }
+	void AddRow() override { }
+	void AddColumn() override { }
+	void RemoveRow() override { }
+	void RemoveColumn() override { }
+	unsigned int GetNumColumns() const override { return 0; }
+	unsigned int GetNumRows() const override { return 0; }
+	void FocusCell(const CELL::CELL_POSITION) const override { }
+	void UnfocusCell(const CELL::CELL_POSITION) const override { }
+	void FocusEntryBox() const override { }
+	void UnfocusEntryBox(const CELL::CELL_POSITION) const override { }
+	void FocusUp1(const CELL::CELL_POSITION) const override { }
+	void FocusDown1(const CELL::CELL_POSITION) const override { }
+	void FocusRight1(const CELL::CELL_POSITION) const override { }
+	void FocusLeft1(const CELL::CELL_POSITION) const override { }
+	void LockTargetCell(const CELL::CELL_POSITION) const override { }
+	void ReleaseTargetCell() const override { }
+	CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
+};
+
+#endif // !BENCHMARK_TABLE_CLASS_HPP
@@ -0,0 +1,82 @@
+/*//////////
+// Times CSV import & export of 1M cells: 100 columns by 10,000 rows, mostly numbers, with a column of text every 10
+// and a column of formulas every 10 reading their left neighbour.
+// "NewCell" enters the same fields one CELL::NewCell at a time inside one batch, as a hand-written import would.
+// "import" streams the text through CSV_FILE with no pool workers, then with one per core.
+// Each is run once, as a user importing a file would. Throughput is printed in MB of CSV per second.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Csv_File.hpp"
+#include "Snapshot.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+	constexpr auto csvColumns{ 100u };
+	constexpr auto csvRows{ 10000u };
+
+	std::string Field(const unsigned int c, const unsigned int r) {
+		if (c % 10 == 5) { return "label " + std::to_string(r); }
+		if (c % 10 == 0) { return "=&R" + std::to_string(r) + "C" + std::to_string(c - 1) + " * 2"; }
+		return std::to_string(r * c % 9973) + "." + std::to_string(c % 100);
+	}
+
+	std::string BuildCsv() {
+		auto csv = std::string{ };
+		for (auto r = 1u; r <= csvRows; ++r) {
+			for (auto c = 1u; c <= csvColumns; ++c) {
+				csv += Field(c, r);
+				csv += c == csvColumns ? '\n' : ',';
+			}
+		}
+		return csv;
+	}
+
+	template <typename ACTION>
+	double Seconds(ACTION&& action) {
+		auto start = std::chrono::steady_clock::now();
+		action();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+TEST_CASE("CSV Import & Export") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto csv = BuildCsv();
+	auto megabytes = csv.size() / 1e6;
+	std::cout << "1M cells, " << megabytes << " MB of CSV\n";
+
+	{
+		auto cellData = CELL::CELL_DATA{ };
+		auto seconds = Seconds([&cellData] {
+			auto batch = CELL::BATCH{ &cellData };
+			for (auto c = 1u; c <= csvColumns; ++c) {
+				for (auto r = 1u; r <= csvRows; ++r) { batch.NewCell({ c, r }, Field(c, r)); }
+			}
+			batch.Commit();
+		});
+		std::cout << "NewCell, one batch: " << seconds << " s, " << megabytes / seconds << " MB/s\n";
+	}
+
+	for (auto workers : { 0u, std::thread::hardware_concurrency() }) {
+		auto cellData = CELL::CELL_DATA{ workers };
+		auto in = std::istringstream{ csv };
+		auto imported = std::size_t{ 0 };
+		auto seconds = Seconds([&cellData, &in, &imported] { imported = CSV_FILE::Import(cellData, in); });
+		REQUIRE(imported == csvColumns * csvRows);
+		std::cout << "import, " << workers << " workers: " << seconds << " s, " << megabytes / seconds << " MB/s\n";
+
+		if (workers != 0) { continue; }
+		auto out = std::ostringstream{ };
+		auto snapshot = cellData.Snapshot();
+		seconds = Seconds([&snapshot, &out] { CSV_FILE::Export(*snapshot, out); });
+		std::cout << "export: " << seconds << " s, " << out.str().size() / 1e6 / seconds << " MB/s\n";
+	}
+}
@@ -0,0 +1,170 @@
+/*//////////
+// Per-node cost of evaluating a formula.
+// LEGACY_* replicate the original ARGUMENT tree, which handed every result through a new std::promise/std::future pair
+// (a heap allocated shared state per node per evaluation). They are compared against the compiled FORMULA_PROGRAM.
+// Each formula is SUM over 8 values, one of which is a reference that changes on every evaluation.
+// Parse throughput is measured over a corpus of mixed formulas and printed in MB/s.
+// A filled-down column compares compiling every formula against sharing programs through FORMULA_CACHE.
+// A column SUM compares loading every cell by reference against gathering one range into the aggregate kernel.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "Formula.hpp"
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	constexpr auto leafCount{ 8 };
+
+	struct LEGACY_ARGUMENT {
+		virtual ~LEGACY_ARGUMENT() = default;
+		virtual bool UpdateArgument() { return true; }
+		double Get() { return stillValid ? storedArgument : val.get(); }
+	protected:
+		std::future<double> val;
+		double storedArgument{ };
+		bool stillValid{ false };
+		void SetValue(double value) { auto p = std::promise<double>{ }; val = p.get_future(); p.set_value(value); }
+	};
+
+	struct LEGACY_VALUE : LEGACY_ARGUMENT {
+		explicit LEGACY_VALUE(double arg) { storedArgument = arg; SetValue(arg); }
+		bool UpdateArgument() override { SetValue(storedArgument); return false; }
+	};
+
+	struct LEGACY_CHANGING : LEGACY_ARGUMENT {
+		bool UpdateArgument() override { storedArgument += 1; SetValue(storedArgument); return true; }
+	};
+
+	struct LEGACY_SUM : LEGACY_ARGUMENT {
+		std::vector<std::shared_ptr<LEGACY_ARGUMENT>> Arguments;
+		bool UpdateArgument() override {
+			for (auto arg : Arguments) { if (arg->UpdateArgument()) { stillValid = false; } }
+			auto sum = 0.0;
+			for (auto x : Arguments) { sum += x->Get(); }
+			SetValue(sum);
+			return true;
+		}
+	};
+
+}
+
+TEST_CASE("Function Node Evaluation") {
+	BENCHMARK_ADVANCED("promise/future tree")(Catch::Benchmark::Chronometer meter) {
+		auto sum = LEGACY_SUM{ };
+		sum.Arguments.push_back(std::make_shared<LEGACY_CHANGING>());
+		for (auto i = 1; i < leafCount; ++i) { sum.Arguments.push_back(std::make_shared<LEGACY_VALUE>(i)); }
+		meter.measure([&sum] { sum.UpdateArgument(); return sum.Get(); });
+	};
+	BENCHMARK_ADVANCED("compiled program")(Catch::Benchmark::Chronometer meter) {
+		auto text = std::string{ "SUM(&R1C1" };
+		for (auto i = 1; i < leafCount; ++i) { text += ", " + std::to_string(i); }
+		auto program = FORMULA_PROGRAM::Compile(text + ")", CELL::CELL_POSITION{ 2, 2 });
+		auto input = 0.0;
+		auto load = [&input](CELL::CELL_POSITION) { return FORMULA_PROGRAM::RESULT{ ++input }; };
+		meter.measure([&program, &load] { return program.Run(CELL::CELL_POSITION{ 2, 2 }, load).value; });
+	};
+}
+
+namespace {
+	// Formula-heavy sheet: functions, references, operators and nesting in roughly equal measure.
+	std::vector<std::string> FormulaCorpus() {
+		auto corpus = std::vector<std::string>{ };
+		for (auto i = 1; i <= 20000; ++i) {
+			auto r = std::to_string(i);
+			switch (i % 4) {
+			case 0: { corpus.push_back("SUM(&R" + r + "C1, &R" + r + "C2, &R" + r + "C3) * (3 + &R2C2) / 4"); } break;
+			case 1: { corpus.push_back("AVERAGE(PRODUCT(&R" + r + "C1, 1.5), INVERSE(&C2R" + r + "), 12.25)"); } break;
+			case 2: { corpus.push_back("(&R" + r + "C4 - &R" + r + "C5) / (1 + RECIPROCAL(&R" + r + "C6)) * -2"); } break;
+			default: { corpus.push_back("SUM( &R" + r + "C1 , PI() , 100 , -&R" + r + "C7 )"); } break;
+			}
+		}
+		return corpus;
+	}
+}
+
+TEST_CASE("Formula Parse Throughput") {
+	auto corpus = FormulaCorpus();
+	auto bytes = std::size_t{ 0 };
+	for (auto& text : corpus) { bytes += text.size(); }
+
+	auto compileAll = [&corpus] {
+		auto instructions = std::size_t{ 0 };
+		for (auto& text : corpus) { instructions += FORMULA_PROGRAM::Compile(text, CELL::CELL_POSITION{ 8, 1 }).Code().size(); }
+		return instructions;
+	};
+
+	constexpr auto passes{ 20 };
+	auto start = std::chrono::steady_clock::now();
+	for (auto i = 0; i < passes; ++i) { compileAll(); }
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Formula parse throughput: " << (bytes * passes / seconds) / (1024 * 1024) << " MB/s over " << bytes << " bytes\n";
+
+	BENCHMARK("compile " + std::to_string(corpus.size()) + " formulas") { return compileAll(); };
+}
+
+TEST_CASE("Filled Down Formula Compilation") {
+	constexpr auto rows{ 20000u };
+	auto texts = std::vector<std::string>{ };
+	for (auto r = 1u; r <= rows; ++r) { texts.push_back("SUM(&R" + std::to_string(r) + "C1, &R" + std::to_string(r) + "C2) * 2"); }
+
+	auto programs = std::vector<std::shared_ptr<const FORMULA_PROGRAM>>(rows);
+	auto compileEach = [&texts, &programs] {
+		for (auto r = 0u; r < rows; ++r) { programs[r] = std::make_shared<const FORMULA_PROGRAM>(FORMULA_PROGRAM::Compile(texts[r], CELL::CELL_POSITION{ 3, r + 1 })); }
+	};
+	auto shareCached = [&texts, &programs] {
+		auto cache = FORMULA_CACHE{ };
+		for (auto r = 0u; r < rows; ++r) { programs[r] = cache.Get(texts[r], CELL::CELL_POSITION{ 3, r + 1 }); }
+	};
+	auto memory = [&programs] {
+		auto distinct = std::vector<const FORMULA_PROGRAM*>{ };
+		for (auto& program : programs) { if (distinct.empty() || distinct.back() != program.get()) { distinct.push_back(program.get()); } }
+		auto bytes = std::size_t{ 0 };
+		for (auto program : distinct) { bytes += program->MemoryUsage(); }
+		return bytes;
+	};
+
+	compileEach();
+	std::cout << "Compiled separately: " << memory() << " bytes of programs for " << rows << " cells\n";
+	shareCached();
+	std::cout << "Shared through cache: " << memory() << " bytes of programs for " << rows << " cells\n";
+
+	BENCHMARK("compile each formula") { compileEach(); return programs.size(); };
+	BENCHMARK("share through FORMULA_CACHE") { shareCached(); return programs.size(); };
+}
+
+TEST_CASE("Column Range Aggregation") {
+	constexpr auto rows{ 65000u };
+	auto column = std::vector<double>(rows);
+	for (auto r = 0u; r < rows; ++r) { column[r] = r % 97 * 0.5; }
+	auto load = [&column](const CELL::CELL_POSITION pos) { return FORMULA_PROGRAM::RESULT{ column[pos.row - 1] }; };
+	auto loadRange = [&column](const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, double* out) {
+		std::copy(column.begin() + (first.row - 1), column.begin() + last.row, out);
+		return FORMULA_PROGRAM::RANGE_RESULT{ last.row - first.row + 1u };
+	};
+
+	auto text = std::string{ "SUM(&R1C1" };
+	for (auto r = 2u; r <= rows; ++r) { text += ",&R" + std::to_string(r) + "C1"; }
+	auto byReference = FORMULA_PROGRAM::Compile(text + ")", CELL::CELL_POSITION{ 2, 1 });
+	auto byRange = FORMULA_PROGRAM::Compile("SUM(&R1C1:R" + std::to_string(rows) + "C1)", CELL::CELL_POSITION{ 2, 1 });
+
+	constexpr auto passes{ 200 };
+	auto throughput = [&](const FORMULA_PROGRAM& program, const char* label) {
+		auto start = std::chrono::steady_clock::now();
+		auto total = 0.0;
+		for (auto i = 0; i < passes; ++i) { total += program.Run(CELL::CELL_POSITION{ 2, 1 }, load, loadRange).value; }
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << label << ": " << (double(rows) * passes / seconds) / 1e6 << " M values/s (" << total << ")\n";
+	};
+	throughput(byReference, "SUM by reference");
+	throughput(byRange, "SUM over range");
+
+	BENCHMARK("SUM of " + std::to_string(rows) + " references") { return byReference.Run(CELL::CELL_POSITION{ 2, 1 }, load, loadRange).value; };
+	BENCHMARK("SUM of a " + std::to_string(rows) + " cell range") { return byRange.Run(CELL::CELL_POSITION{ 2, 1 }, load, loadRange).value; };
+}
@@ -0,0 +1,109 @@
+/*//////////
+// Compares the tiled cell grid against the unordered map it replaced.
+// The workload is a dense block inside an otherwise empty sheet, which is the typical spreadsheet shape.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "Cell.hpp"
+#include "Slot_Grid.hpp"
+#include <memory>
+#include <unordered_map>
+
+namespace {
+	constexpr auto blockColumns{ 200u };
+	constexpr auto blockRows{ 500u };
+
+	using MAP = std::unordered_map<CELL::CELL_POSITION, std::shared_ptr<int>, CELL::CELL_HASH>;
+	using GRID = SLOT_GRID<const int*, CELL::CELL_POSITION>;
+
+	template <typename INSERT>
+	void FillBlock(INSERT&& insert) {
+		auto value = std::make_shared<int>(1);
+		for (auto c = 1u; c <= blockColumns; ++c) {
+			for (auto r = 1u; r <= blockRows; ++r) { insert(CELL::CELL_POSITION{ c, r }, value); }
+		}
+	}
+}
+
+TEST_CASE("Cell Store Fill") {
+	BENCHMARK("unordered_map") {
+		auto map = MAP{ };
+		FillBlock([&map](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { map[pos] = v; });
+		return map.size();
+	};
+	BENCHMARK("SLOT_GRID") {
+		auto grid = std::make_unique<GRID>();
+		FillBlock([&grid](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { grid->Assign(pos, v.get()); });
+		return grid->Size();
+	};
+}
+
+TEST_CASE("Cell Store Column Scan") {
+	auto map = MAP{ };
+	auto grid = std::make_unique<GRID>();
+	FillBlock([&map](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { map[pos] = v; });
+	FillBlock([&grid](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { grid->Assign(pos, v.get()); });
+
+	// Visit every position in the block (including a margin of empty cells) one column at a time
+	BENCHMARK("unordered_map") {
+		auto total = 0;
+		for (auto c = 1u; c <= blockColumns + 10; ++c) {
+			for (auto r = 1u; r <= blockRows + 10; ++r) {
+				auto it = map.find(CELL::CELL_POSITION{ c, r });
+				if (it != map.end()) { total += *it->second; }
+			}
+		}
+		return total;
+	};
+	BENCHMARK("SLOT_GRID") {
+		auto total = 0;
+		for (auto c = 1u; c <= blockColumns + 10; ++c) {
+			for (auto r = 1u; r <= blockRows + 10; ++r) {
+				auto slot = grid->Find(CELL::CELL_POSITION{ c, r });
+				if (slot) { total += *slot; }
+			}
+		}
+		return total;
+	};
+}
+
+TEST_CASE("Cell Store Row Scan") {
+	auto map = MAP{ };
+	auto grid = std::make_unique<GRID>();
+	FillBlock([&map](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { map[pos] = v; });
+	FillBlock([&grid](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { grid->Assign(pos, v.get()); });
+
+	BENCHMARK("unordered_map") {
+		auto total = 0;
+		for (auto r = 1u; r <= blockRows; ++r) {
+			for (auto c = 1u; c <= blockColumns; ++c) { total += *map.find(CELL::CELL_POSITION{ c, r })->second; }
+		}
+		return total;
+	};
+	BENCHMARK("SLOT_GRID") {
+		auto total = 0;
+		for (auto r = 1u; r <= blockRows; ++r) {
+			for (auto c = 1u; c <= blockColumns; ++c) { total += *grid->Find(CELL::CELL_POSITION{ c, r }); }
+		}
+		return total;
+	};
+}
+
+TEST_CASE("Cell Store Full Iteration") {
+	auto map = MAP{ };
+	auto grid = std::make_unique<GRID>();
+	FillBlock([&map](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { map[pos] = v; });
+	FillBlock([&grid](CELL::CELL_POSITION pos, const std::shared_ptr<int>& v) { grid->Assign(pos, v.get()); });
+
+	BENCHMARK("unordered_map") {
+		auto total = 0;
+		for (auto& [pos, value] : map) { total += *value; }
+		return total;
+	};
+	BENCHMARK("SLOT_GRID") {
+		auto total = 0;
+		grid->ForEachIn({ 0, 0 }, { MaxColumn_, MaxRow_ }, [&total](CELL::CELL_POSITION, const int* value) { total += *value; });
+		return total;
+	};
+}
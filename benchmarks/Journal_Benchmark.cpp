@@ -0,0 +1,91 @@
+/*//////////
+// Times journalled editing & recovery.
+// "edit" enters 2,000 numbers one CELL::NewCell at a time: without a journal, with each change waiting for its own sync,
+// and with a 5 ms group window, where changes return at once & share syncs. Syncs per change are printed.
+// "recover" replays a journal of 100,000 changes (10,000 cells, each entered 10 times, with formulas reading their neighbour)
+// over an empty sheet, which enters each cell once, in one batch. "compact" folds that journal into the workbook.
+// Each is run once, as a user would. Timings depend heavily on how fast the disk syncs.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Journal.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace {
+	constexpr auto editCount{ 2000u };
+	constexpr auto replayColumns{ 10u };
+	constexpr auto replayRows{ 1000u };
+	constexpr auto replayRounds{ 10u };
+
+	std::string TempPath(const std::string& name) {
+		auto path = (std::filesystem::temp_directory_path() / name).string();
+		std::filesystem::remove(path);
+		std::filesystem::remove(JOURNAL::PathFor(path));
+		return path;
+	}
+
+	template <typename ACTION>
+	double Seconds(ACTION&& action) {
+		auto start = std::chrono::steady_clock::now();
+		action();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+TEST_CASE("Journal Edit & Recover") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	const auto path = TempPath("benchmark_journal.sheet");
+
+	for (auto window : { -1, 0, 5 }) {
+		auto cellData = CELL::CELL_DATA{ };
+		auto journal = std::optional<JOURNAL>{ };
+		if (window >= 0) { journal.emplace(cellData, TempPath("benchmark_journal.sheet"), std::chrono::milliseconds{ window }); }		// Each starts afresh
+		auto seconds = Seconds([&cellData, &journal] {
+			for (auto r = 1u; r <= editCount; ++r) { CELL::NewCell(&cellData, { 1, r }, std::to_string(r)); }
+			if (journal) { journal->Flush(); }
+		});
+		std::cout << "edit " << editCount << " cells, " << (window < 0 ? "no journal" : window == 0 ? "sync each" : "5 ms window") << ": " << seconds << " s";
+		if (journal) { std::cout << ", " << static_cast<double>(journal->SyncCount()) / editCount << " syncs per change"; }
+		std::cout << "\n";
+	}
+
+	TempPath("benchmark_journal.sheet");
+	{
+		auto cellData = CELL::CELL_DATA{ };
+		auto journal = JOURNAL{ cellData, path, std::chrono::milliseconds{ 5 }, std::size_t{ 1 } << 40 };
+		for (auto round = 1u; round <= replayRounds; ++round) {
+			for (auto c = 1u; c <= replayColumns; ++c) {
+				for (auto r = 1u; r <= replayRows; ++r) {
+					CELL::NewCell(&cellData, { c, r }, c % 2 ? std::to_string(r * round) : "=&R" + std::to_string(r) + "C" + std::to_string(c - 1) + " * 2");
+				}
+			}
+		}
+		journal.Flush();
+		std::cout << replayRounds * replayColumns * replayRows << " changes journalled, " << journal.Size() / 1024 << " KiB\n";
+	}
+	{
+		auto recovered = CELL::CELL_DATA{ };
+		auto seconds = Seconds([&recovered, &path] { JOURNAL{ recovered, path, std::chrono::milliseconds{ 0 }, std::size_t{ 1 } << 40 }; });
+		REQUIRE(std::get<double>(recovered.GetCellView({ 2, replayRows })->GetValue()) == 2.0 * replayRows * replayRounds);
+		std::cout << "recover: " << seconds << " s, " << recovered.RecalculationCount() << " recalculations\n";
+	}
+	{
+		auto recovered = CELL::CELL_DATA{ };
+		auto journal = JOURNAL{ recovered, path, std::chrono::milliseconds{ 0 }, 1 };
+		auto seconds = Seconds([&recovered, &journal] {
+			CELL::NewCell(&recovered, { 1, 1 }, "0");				// Passes the threshold
+			journal.WaitForCompaction();
+		});
+		REQUIRE(journal.CompactionCount() == 1);
+		std::cout << "compact: " << seconds << " s, journal now " << journal.Size() << " bytes, workbook " << std::filesystem::file_size(path) / 1024 << " KiB\n";
+	}
+	std::filesystem::remove(path);
+	std::filesystem::remove(JOURNAL::PathFor(path));
+}
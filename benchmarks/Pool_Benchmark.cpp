@@ -0,0 +1,55 @@
+/*//////////
+// Counts the heap allocations & times the work of filling, loading & tearing down a sheet of 1M cells:
+// 100 columns by 10,000 rows, alternating numbers and formulas reading their left neighbour.
+// "fill" enters every cell in one batch, "load" reads the same cells back from a saved workbook, and "destroy" drops the sheet.
+// Each is run once. Allocations are counted through the replaced global operator new (see Allocation_Counter.hpp).
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Allocation_Counter.hpp"
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Workbook_File.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace {
+	constexpr auto poolColumns{ 100u };
+	constexpr auto poolRows{ 10000u };
+
+	template <typename ACTION>
+	void Report(const std::string& name, ACTION&& action) {
+		auto allocations = ALLOCATION_COUNTER::AllocationCount();
+		auto start = std::chrono::steady_clock::now();
+		action();
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "1M cells, " << name << ": " << seconds << " s, " << ALLOCATION_COUNTER::AllocationCount() - allocations << " allocations\n";
+	}
+}
+
+TEST_CASE("Cell Allocation") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto path = (std::filesystem::temp_directory_path() / "benchmark_pool.sheet").string();
+	auto sheet = std::optional<CELL::CELL_DATA>{ std::in_place };
+	Report("fill", [&sheet] {
+		auto batch = CELL::BATCH{ &*sheet };
+		for (auto c = 1u; c <= poolColumns; ++c) {
+			for (auto r = 1u; r <= poolRows; ++r) {
+				CELL::NewCell(&*sheet, { c, r }, c % 2 ? std::to_string(r * c) : "=&R" + std::to_string(r) + "C" + std::to_string(c - 1) + " * 2");
+			}
+		}
+		batch.Commit();
+	});
+	WORKBOOK_FILE::Save(*sheet, path);
+	Report("destroy", [&sheet] { sheet.reset(); });
+
+	sheet.emplace();
+	Report("load", [&sheet, &path] { WORKBOOK_FILE::Load(*sheet, path); });
+	Report("destroy loaded", [&sheet] { sheet.reset(); });
+	std::remove(path.c_str());
+}
@@ -0,0 +1,108 @@
+/*//////////
+// Read scaling: several threads looking up cells at once, as a redraw and formula evaluation would.
+// "mutex" replicates the original lookup: a grid of shared_ptr guarded by one mutex, copying the pointer out.
+// "epoch" is the CELL_DATA lookup: no lock, the value is found in a SLOT_GRID under an EPOCH::GUARD.
+// "epoch, borrowed" reads in place under one guard per sweep, as formulas do, with no reference counting at all.
+// Reads per second are printed for each thread count. Scaling is bounded by the number of cores available.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Slot_Grid.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	constexpr auto readColumns{ 8u };
+	constexpr auto readRows{ 64u };
+	constexpr auto sweepsPerThread{ 20000u };
+
+	// Run the sweep on each of the given number of threads at once and return total reads per second.
+	template <typename SWEEP>
+	double ReadsPerSecond(const unsigned int threads, SWEEP&& sweep) {
+		auto go = std::atomic<bool>{ false };
+		auto checksum = std::atomic<double>{ 0 };
+		auto workers = std::vector<std::thread>{ };
+		for (auto t = 0u; t < threads; ++t) {
+			workers.emplace_back([&go, &checksum, &sweep] {
+				while (!go) { std::this_thread::yield(); }
+				auto sum = 0.0;
+				for (auto i = 0u; i < sweepsPerThread; ++i) { sum += sweep(); }
+				checksum = checksum + sum;
+			});
+		}
+		auto start = std::chrono::steady_clock::now();
+		go = true;
+		for (auto& worker : workers) { worker.join(); }
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return double(threads) * sweepsPerThread * readColumns * readRows / seconds;
+	}
+}
+
+TEST_CASE("Concurrent Cell Reads") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto values = std::vector<std::shared_ptr<double>>{ };
+	auto lockedGrid = SLOT_GRID<const std::shared_ptr<double>*, CELL::CELL_POSITION>{ };
+	auto publishedGrid = SLOT_GRID<const double*, CELL::CELL_POSITION>{ };
+	auto lkGrid = std::mutex{ };
+	values.reserve(readColumns * readRows);
+	for (auto c = 1u; c <= readColumns; ++c) {
+		for (auto r = 1u; r <= readRows; ++r) {
+			CELL::NewCell(&cellData, { c, r }, std::to_string(r));
+			auto& value = values.emplace_back(std::make_shared<double>(r));
+			lockedGrid.Assign({ c, r }, &value);
+			publishedGrid.Assign({ c, r }, value.get());
+		}
+	}
+
+	auto mutexSweep = [&lockedGrid, &lkGrid] {
+		auto sum = 0.0;
+		for (auto c = 1u; c <= readColumns; ++c) {
+			for (auto r = 1u; r <= readRows; ++r) {
+				auto value = std::shared_ptr<double>{ };
+				{ auto lk = std::lock_guard<std::mutex>{ lkGrid }; value = *lockedGrid.Find({ c, r }); }
+				sum += *value;
+			}
+		}
+		return sum;
+	};
+	auto epochSweep = [&publishedGrid] {
+		auto sum = 0.0;
+		for (auto c = 1u; c <= readColumns; ++c) {
+			for (auto r = 1u; r <= readRows; ++r) { auto guard = EPOCH::GUARD{ }; sum += *publishedGrid.Find({ c, r }); }
+		}
+		return sum;
+	};
+	auto borrowedSweep = [&publishedGrid] {
+		auto sum = 0.0;
+		auto guard = EPOCH::GUARD{ };
+		for (auto c = 1u; c <= readColumns; ++c) {
+			for (auto r = 1u; r <= readRows; ++r) { sum += *publishedGrid.Find({ c, r }); }
+		}
+		return sum;
+	};
+	auto cellSweep = [&cellData] {
+		auto sum = 0.0;
+		for (auto c = 1u; c <= readColumns; ++c) {
+			for (auto r = 1u; r <= readRows; ++r) { sum += std::get<double>(cellData.GetCellProxy({ c, r })->GetValue()); }
+		}
+		return sum;
+	};
+
+	auto threadCounts = std::vector<unsigned int>{ 1, 2, 4 };
+	if (std::thread::hardware_concurrency() > 4) { threadCounts.push_back(std::thread::hardware_concurrency()); }
+	for (auto threads : threadCounts) {
+		std::cout << threads << " threads: mutex " << ReadsPerSecond(threads, mutexSweep) / 1e6
+			<< " M/s, epoch " << ReadsPerSecond(threads, epochSweep) / 1e6
+			<< " M/s, epoch borrowed " << ReadsPerSecond(threads, borrowedSweep) / 1e6
+			<< " M/s, CELL_DATA proxy " << ReadsPerSecond(threads, cellSweep) / 1e6 << " M/s\n";
+	}
+}
@@ -0,0 +1,66 @@
+/*//////////
+// Times recalculation of a wide fan-out: 100,000 formulas all reading one input cell.
+// Each edit of the input recalculates every formula, which all sit on the same dependency level.
+// The same sheet is measured with the serial fallback and with increasing numbers of pool workers.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	constexpr auto fanOutRows{ 1000u };
+	constexpr auto fanOutColumns{ 100u };		// 100,000 formulas in total
+
+	void BuildFanOut(CELL::CELL_DATA& cellData) {
+		CELL::NewCell(&cellData, { 1, 1 }, "1");
+		for (auto c = 2u; c <= fanOutColumns + 1; ++c) {
+			for (auto r = 1u; r <= fanOutRows; ++r) { CELL::NewCell(&cellData, { c, r }, "=AVERAGE(SUM(&R1C1, " + std::to_string(r) + "), PRODUCT(&R1C1, 3), 2)"); }
+		}
+	}
+}
+
+TEST_CASE("Fan-Out Recalculation") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto workerCounts = std::vector<unsigned int>{ 0, 2, 4 };
+	if (std::thread::hardware_concurrency() > 4) { workerCounts.push_back(std::thread::hardware_concurrency()); }
+
+	for (auto workers : workerCounts) {
+		auto cellData = CELL::CELL_DATA{ workers };
+		BuildFanOut(cellData);
+		auto input = 1;
+		BENCHMARK("100k formulas, " + std::to_string(workers) + " workers") {
+			CELL::NewCell(&cellData, { 1, 1 }, std::to_string(++input));
+			return cellData.RecalculationCount();
+		};
+	}
+}
+
+// Pasting a column of values under a running total: one edit at a time re-sums the column after every cell,
+// while a batch re-sums it once.
+TEST_CASE("Batch Paste") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	constexpr auto pasteRows{ 10000u };
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 3, 1 }, "=SUM(&R1C1:R" + std::to_string(pasteRows) + "C1)");
+	for (auto r = 1u; r <= pasteRows; ++r) { CELL::NewCell(&cellData, { 2, r }, "=&R" + std::to_string(r) + "C1 * 2"); }
+
+	auto input = 0;
+	BENCHMARK("10k cells, one at a time") {
+		++input;
+		for (auto r = 1u; r <= pasteRows; ++r) { CELL::NewCell(&cellData, { 1, r }, std::to_string(input + r)); }
+		return cellData.RecalculationCount();
+	};
+	BENCHMARK("10k cells, one batch") {
+		++input;
+		auto batch = CELL::BATCH{ &cellData };
+		for (auto r = 1u; r <= pasteRows; ++r) { batch.NewCell({ 1, r }, std::to_string(input + r)); }
+		batch.Commit();
+		return cellData.RecalculationCount();
+	};
+}
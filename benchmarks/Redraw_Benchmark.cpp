@@ -0,0 +1,61 @@
+/*//////////
+// Times a redraw of the visible window of a table: 10 rows by 8 columns, as in the console table.
+// The visible values feed 8,000 formulas further down the sheet, so anything that mistakes a read for an edit
+// pays for a recalculation of their downstream cells.
+// "proxies" keeps a handle to each visible cell, as a front end caching what it shows (or an undo stack) would.
+// Copying a proxy used to refresh its cell and notify everything downstream: 4.4 ms per redraw on this sheet.
+// "views" reads through CELL_VIEWs, as the console table now does.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	constexpr auto visibleRows{ 10u };
+	constexpr auto visibleColumns{ 8u };
+	constexpr auto formulasPerCell{ 100u };
+
+	void BuildSheet(CELL::CELL_DATA& cellData) {
+		for (auto c = 1u; c <= visibleColumns; ++c) {
+			for (auto r = 1u; r <= visibleRows; ++r) { CELL::NewCell(&cellData, { c, r }, std::to_string(r * c)); }
+			for (auto r = visibleRows + 1; r <= visibleRows + visibleRows * formulasPerCell; ++r) {
+				CELL::NewCell(&cellData, { c, r }, "=&R" + std::to_string(1 + r % visibleRows) + "C" + std::to_string(c) + " * 2");
+			}
+		}
+	}
+}
+
+TEST_CASE("Redraw") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	BuildSheet(cellData);
+
+	BENCHMARK("80 cells, proxies") {
+		auto visible = std::vector<CELL::CELL_PROXY>{ };
+		visible.reserve(visibleRows * visibleColumns);
+		auto length = std::size_t{ 0 };
+		for (auto r = 1u; r <= visibleRows; ++r) {
+			for (auto c = 1u; c <= visibleColumns; ++c) {
+				visible.push_back(cellData.GetCellProxy({ c, r }));
+				length += visible.back() ? visible.back()->GetOutput().size() : 0;
+			}
+		}
+		return length;
+	};
+
+	BENCHMARK("80 cells, views") {
+		auto length = std::size_t{ 0 };
+		for (auto r = 1u; r <= visibleRows; ++r) {
+			for (auto c = 1u; c <= visibleColumns; ++c) {
+				auto cell = cellData.GetCellView({ c, r });
+				length += cell ? cell->GetOutput().size() : 0;
+			}
+		}
+		return length;
+	};
+}
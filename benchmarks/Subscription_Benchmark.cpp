@@ -0,0 +1,78 @@
+/*//////////
+// Cost of subscribing a formula to a column range, as the range grows.
+// "per cell" registers one edge for every position in the range, as range formulas originally did.
+// "range index" registers the whole rectangle as a single RANGE_INDEX entry.
+// Setup time and the number of stored subscriptions are printed for each range height.
+// Memory per dependency edge is measured on a million-edge sheet, comparing node-based std::set adjacency
+// (as the graph used originally) against the POSITION_SET adjacency it uses now.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "Allocation_Counter.hpp"
+#include "Dependency_Graph.hpp"
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+TEST_CASE("Range Subscription Setup") {
+	for (auto height : { 100u, 1000u, 10000u, 60000u }) {
+		auto timed = [](auto&& subscribe) {
+			auto start = std::chrono::steady_clock::now();
+			subscribe();
+			return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		};
+		auto perCell = DEPENDENCY_GRAPH{ };
+		auto perCellTime = timed([&] { for (auto r = 1u; r <= height; ++r) { perCell.AddEdge({ 1, r }, { 2, 1 }); } });
+		auto indexed = DEPENDENCY_GRAPH{ };
+		auto indexedTime = timed([&] { indexed.AddRangeEdge({ 1, 1 }, { 1, height }, { 2, 1 }); });
+		std::cout << height << " cell range: per cell " << perCell.EdgeCount() << " edges in " << perCellTime << " us, range index "
+			<< indexed.RangeCount() + indexed.EdgeCount() << " entry in " << indexedTime << " us\n";
+	}
+
+	// Lookup cost with many overlapping ranges registered: a running total down one column.
+	auto graph = DEPENDENCY_GRAPH{ };
+	constexpr auto totals{ 20000u };
+	for (auto r = 1u; r <= totals; ++r) { graph.AddRangeEdge({ 1, r }, { 1, r + 99 }, { 2, r }); }
+	auto row = 0u;
+	BENCHMARK("who observes a cell among " + std::to_string(totals) + " ranges") { return graph.RecalculationOrder({ 1, 1 + (row++ % totals) }).size(); };
+}
+
+namespace {
+	// 100,000 formulas reading 10 cells each, scattered over one input column of 60,000 values.
+	constexpr auto edgeFormulas{ 100000u };
+	constexpr auto edgeReferences{ 10u };
+
+	template <typename ADD>
+	void BuildMillionEdges(ADD&& add) {
+		for (auto o = 0u; o < edgeFormulas; ++o) {
+			auto observer = CELL::CELL_POSITION{ 2 + o / 50000, o % 50000 + 1 };
+			for (auto k = 0u; k < edgeReferences; ++k) { add(CELL::CELL_POSITION{ 1, (o * 7 + k * 131) % 60000 + 1 }, observer); }
+		}
+	}
+
+	template <typename SET>
+	long long AdjacencyBytes() {
+		auto before = ALLOCATION_COUNTER::LiveBytes();
+		auto observers = std::unordered_map<CELL::CELL_POSITION, SET, CELL::CELL_HASH>{ };
+		auto subjects = std::unordered_map<CELL::CELL_POSITION, SET, CELL::CELL_HASH>{ };
+		BuildMillionEdges([&](const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer) { observers[subject].insert(observer); subjects[observer].insert(subject); });
+		return ALLOCATION_COUNTER::LiveBytes() - before;
+	}
+}
+
+TEST_CASE("Dependency Edge Memory") {
+	constexpr auto edges{ double(edgeFormulas * edgeReferences) };
+	std::cout << "Adjacency, std::set: " << AdjacencyBytes<std::set<CELL::CELL_POSITION>>() / edges << " bytes per edge\n";
+	std::cout << "Adjacency, POSITION_SET: " << AdjacencyBytes<POSITION_SET<CELL::CELL_POSITION>>() / edges << " bytes per edge\n";
+
+	auto before = ALLOCATION_COUNTER::LiveBytes();
+	auto graph = DEPENDENCY_GRAPH{ };
+	BuildMillionEdges([&graph](const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer) { graph.AddEdge(subject, observer); });
+	std::cout << "DEPENDENCY_GRAPH: " << (ALLOCATION_COUNTER::LiveBytes() - before) / double(graph.EdgeCount()) << " bytes per edge over " << graph.EdgeCount() << " edges\n";
+
+	auto subject = 0u;
+	BENCHMARK("recalculation order over the million-edge graph") { return graph.RecalculationOrder({ 1, 1 + (subject++ % 60000) }).size(); };
+}
@@ -0,0 +1,98 @@
+/*//////////
+// Measures what plain values cost a data-heavy sheet: 1M cells, 100 columns by 10,000 rows, with no formulas but one.
+// Odd columns hold numbers; even columns hold text drawn from a few dozen labels, as a report's category columns would.
+// Heap growth is printed once the sheet is filled, per cell & in total, followed by the time taken to fill it,
+// to read every cell back through a view & to recalculate one formula summing all 500,000 numbers.
+// "Text Heavy Memory" fills a sheet with long labels, repeated as a report's row & column headings would be, and with
+// references showing them. It prints heap growth beside the text entered & the distinct text the sheet's pool keeps.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Allocation_Counter.hpp"
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Snapshot.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace {
+	constexpr auto valueColumns{ 100u };
+	constexpr auto valueRows{ 10000u };
+	constexpr auto labelCount{ 40u };
+	constexpr auto textColumns{ 50u };
+	constexpr auto textRows{ 10000u };
+	constexpr auto headingCount{ 200u };
+
+	template <typename ACTION>
+	double Seconds(ACTION&& action) {
+		auto start = std::chrono::steady_clock::now();
+		action();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+TEST_CASE("Plain Value Memory") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto before = ALLOCATION_COUNTER::LiveBytes();
+	auto sheet = std::optional<CELL::CELL_DATA>{ std::in_place };
+	auto fill = Seconds([&sheet] {
+		auto batch = CELL::BATCH{ &*sheet };
+		for (auto c = 1u; c <= valueColumns; ++c) {
+			for (auto r = 1u; r <= valueRows; ++r) {
+				CELL::NewCell(&*sheet, { c, r }, c % 2 ? std::to_string(r * c) : "label " + std::to_string((r + c) % labelCount));
+			}
+		}
+		batch.Commit();
+	});
+	auto grown = ALLOCATION_COUNTER::LiveBytes() - before;
+	std::cout << "1M plain values: +" << grown / (1 << 20) << " MiB heap, " << grown / (valueColumns * valueRows) << " bytes per cell\n";
+	std::cout << "1M plain values, fill: " << fill << " s\n";
+
+	auto length = std::size_t{ 0 };
+	auto read = Seconds([&sheet, &length] {
+		for (auto c = 1u; c <= valueColumns; ++c) { for (auto r = 1u; r <= valueRows; ++r) { length += sheet->GetCellView({ c, r })->GetOutput().size(); } }
+	});
+	REQUIRE(length > 0);
+	std::cout << "1M plain values, read every view: " << read << " s\n";
+
+	auto sum = CELL::NewCell(&*sheet, { valueColumns + 1, 1 }, "=SUM(&R1C1:R" + std::to_string(valueRows) + "C" + std::to_string(valueColumns) + ")");
+	auto recalculate = Seconds([&sheet] { CELL::NewCell(&*sheet, { 1, 1 }, "2"); });
+	REQUIRE(std::holds_alternative<double>(sum->GetValue()));
+	std::cout << "1M plain values, recalculate a sum over every number: " << recalculate << " s\n";
+	sheet.reset();
+}
+
+// Every other column repeats one of the headings; the rest refer to the first heading of their row, so show its text too.
+TEST_CASE("Text Heavy Memory") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto heading = [](const unsigned int n) { return "Quarterly total for region " + std::to_string(n % headingCount) + ", all product lines"; };
+	auto entered = std::size_t{ 0 };
+	auto before = ALLOCATION_COUNTER::LiveBytes();
+	auto sheet = std::optional<CELL::CELL_DATA>{ std::in_place };
+	auto fill = Seconds([&sheet, &heading, &entered] {
+		auto batch = CELL::BATCH{ &*sheet };
+		for (auto c = 1u; c <= textColumns; ++c) {
+			for (auto r = 1u; r <= textRows; ++r) {
+				auto contents = c % 2 ? heading(r + c) : "&R" + std::to_string(r) + "C1";
+				entered += contents.size();
+				CELL::NewCell(&*sheet, { c, r }, contents);
+			}
+		}
+		batch.Commit();
+	});
+	auto grown = ALLOCATION_COUNTER::LiveBytes() - before;
+	auto cells = textColumns * textRows;
+	std::cout << "500K text cells: +" << grown / (1 << 20) << " MiB heap, " << grown / cells << " bytes per cell, fill " << fill << " s\n";
+	std::cout << "500K text cells: " << entered / (1 << 20) << " MiB of text entered, " << sheet->TextCount() << " distinct texts of "
+		<< sheet->TextBytes() / (1 << 10) << " KiB kept\n";
+
+	auto length = std::size_t{ 0 };
+	auto read = Seconds([&sheet, &length] { sheet->Snapshot()->ForEach([&length](const SHEET_SNAPSHOT::ENTRY& entry) { length += entry.GetOutput().size(); }); });
+	REQUIRE(length > 0);
+	std::cout << "500K text cells, read every snapshot entry: " << read << " s\n";
+	sheet.reset();
+}
@@ -0,0 +1,71 @@
+/*//////////
+// Times opening a sheet of 1M cells: 100 columns by 10,000 rows, alternating numbers and formulas reading their left neighbour.
+// "rebuild" enters every cell again in one batch, which is what opening a sheet would cost without a file format.
+// "load" reads the saved workbook, with and without the dependency graph section.
+// "open" maps it instead, then shows the top left 10 rows by 8 columns and edits one of them, as a user glancing at the file would.
+// Each is run once, as a user opening the file would. Timings, heap growth & the file size are printed.
+*///////////
+
+#include <catch2/catch_test_macros.hpp>
+#include "Allocation_Counter.hpp"
+#include "Benchmark_Table.hpp"
+#include "Cell.hpp"
+#include "Workbook_File.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+	constexpr auto workbookColumns{ 100u };
+	constexpr auto workbookRows{ 10000u };
+
+	void BuildSheet(CELL::CELL_DATA& cellData) {
+		auto batch = CELL::BATCH{ &cellData };
+		for (auto c = 1u; c <= workbookColumns; ++c) {
+			for (auto r = 1u; r <= workbookRows; ++r) {
+				batch.NewCell({ c, r }, c % 2 ? std::to_string(r * c) : "=&R" + std::to_string(r) + "C" + std::to_string(c - 1) + " * 2");
+			}
+		}
+		batch.Commit();
+	}
+
+	template <typename ACTION>
+	double Seconds(ACTION&& action) {
+		auto start = std::chrono::steady_clock::now();
+		action();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+TEST_CASE("Workbook Load") {
+	table = std::make_unique<BENCHMARK_TABLE>();
+	auto path = (std::filesystem::temp_directory_path() / "benchmark.sheet").string();
+	auto original = CELL::CELL_DATA{ };
+	std::cout << "1M cells, rebuild: " << Seconds([&original] { BuildSheet(original); }) << " s\n";
+
+	for (auto includeGraph : { true, false }) {
+		auto saving = Seconds([&original, &path, includeGraph] { WORKBOOK_FILE::Save(original, path, includeGraph); });
+		auto loaded = CELL::CELL_DATA{ };
+		auto before = ALLOCATION_COUNTER::LiveBytes();
+		auto loading = Seconds([&loaded, &path] { WORKBOOK_FILE::Load(loaded, path); });
+		REQUIRE(loaded.RecalculationCount() == 0);
+		std::cout << "1M cells, " << (includeGraph ? "with" : "without") << " graph: save " << saving << " s, load " << loading
+			<< " s, +" << (ALLOCATION_COUNTER::LiveBytes() - before) / (1 << 20) << " MiB heap, " << std::filesystem::file_size(path) / (1 << 20) << " MiB file\n";
+	}
+
+	WORKBOOK_FILE::Save(original, path);
+	auto opened = CELL::CELL_DATA{ };
+	auto before = ALLOCATION_COUNTER::LiveBytes();
+	auto opening = Seconds([&opened, &path] { WORKBOOK_FILE::Open(opened, path); });
+	auto viewing = Seconds([&opened] {
+		for (auto c = 1u; c <= 8; ++c) { for (auto r = 1u; r <= 10; ++r) { REQUIRE(bool{ opened.GetCellView({ c, r }) }); } }
+	});
+	auto editing = Seconds([&opened] { CELL::NewCell(&opened, { 1, 1 }, "5"); });
+	REQUIRE(std::get<double>(opened.GetCellView({ 2, 1 })->GetValue()) == 10.0);
+	std::cout << "1M cells, open: " << opening << " s, view 80 cells " << viewing << " s, edit 1 cell " << editing << " s, "
+		<< opened.CellCount() << " cells built, +" << (ALLOCATION_COUNTER::LiveBytes() - before) / 1024 << " KiB heap\n";
+	std::remove(path.c_str());
+}
@@ -2,37 +2,99 @@
 // I'm not quite sure how that works. Maybe it's some order of operations thing.
 
 #include "Cell.hpp"
+#include "Dependency_Graph.hpp"
+#include "Formula.hpp"
+#include "Journal.hpp"
+#include "Snapshot.hpp"
 #include "Table.hpp"
+#include "Workbook_File.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <memory>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
 
 using namespace std;
 
+constexpr auto ParallelThreshold_ = size_t{ 256 };		// Smaller levels are not worth handing to the thread pool.
+constexpr auto ParallelGrain_ = size_t{ 64 };			// Fewest cells per pool task.
+
+namespace {
+	// Whatever now happens at the position, the saved cell there is no longer wanted.
+	void ReleaseSaved(WORKBOOK_IMAGE* image, const CELL::CELL_POSITION pos) {
+		auto index = image ? image->Find(pos) : WORKBOOK_IMAGE::None;
+		if (index != WORKBOOK_IMAGE::None) { image->SetState(index, WORKBOOK_IMAGE::RELEASED); }
+	}
+
+	// Manually check for alpha characters since std::stod() is more forgiving than is appropriate for this situation.
+	bool ParseNumber(const string& text, double& value) {
+		try {
+			for (auto c : text) { if (!isdigit(static_cast<unsigned char>(c)) && c != '.' && c != '-') { return false; } }
+			value = stod(text);
+			return true;
+		}
+		catch (...) { return false; }
+	}
+}
+
 CELL::CELL_PROXY CELL::NewCell(CELL_DATA* parentContainer, const CELL_POSITION position, const string& contents) {
 	// Check for valid cell position. Disallowing R == 0 && C == 0 not only fits (non-programmer) human intuition,
 	// but also prevents accidental errors in failing to specify a location.
 	// R == 0 || C == 0 almost certainly indicates a failure to specify one or both arguments.
 	if (position.row == 0 || position.column == 0) { return CELL::CELL_PROXY{ nullptr }; }//throw invalid_argument("Neither Row 0, nor Column 0 exist."); }
+	if (position.row > MaxRow_ || position.column > MaxColumn_) { return CELL::CELL_PROXY{ nullptr }; }		// Beyond the extent of the cell grid.
+	parentContainer->RequireJournal();
+	auto region = CELL_DATA::DIRTY_REGION{ parentContainer };		// The GUI hears about the whole edit at once, on return.
 
 	// Empty contents argument not only fails to create a new cell, but deletes any cell that may already exist at that position.
 	// Notify any observing cells about the change *AFTER* the change has occurred.
 	// (Note that control flow immediately goes to any updating cells.)
-	auto oldCell = parentContainer->GetCell(position);
-	if (contents == "") { if (oldCell) { parentContainer->EraseCell(oldCell->position); parentContainer->NotifyAll(position); } return CELL::CELL_PROXY{ nullptr }; }
+	auto oldContent = parentContainer->RawContent(position);
+	if (contents == "") {
+		if (!oldContent.empty()) { parentContainer->EraseCell(position); parentContainer->NotifyAll(position); parentContainer->UpdateTable(position); }
+		return CELL::CELL_PROXY{ nullptr };
+	}
 
 	// Avoid re-creating identical CELLs.
 	// If it already exists and is built from the same raw string, just return a pointer to the stored CELL.
-	if (oldCell && contents == oldCell->rawContent) { table->UpdateCell(position); return CELL::CELL_PROXY{ oldCell }; }
+	if (contents == oldContent) { parentContainer->UpdateTable(position); return parentContainer->GetCellProxy(position); }
+
+	// Plain values need no CELL. They are kept in the grid's slot.
+	if (auto literal = parentContainer->MakeLiteral(contents)) {
+		parentContainer->AssignSlot(position, literal);
+		parentContainer->NotifyAll(position);
+		parentContainer->UpdateTable(position);
+		return parentContainer->GetCellProxy(position);
+	}
+
+	auto cell = MakeCell(contents, *parentContainer);
+	cell->position = position;
+	cell->rawContent = parentContainer->Contents(contents);
+	cell->parentContainer = parentContainer;
+	parentContainer->AssignCell(cell);			// Add cell to cell map upon creation.
+
+	try { cell->InitializeCell(); }			// Call initialize on cell.
+	catch (...) { cell->error = true; }		// Failure of any sort will set the cell into an error state.
+	parentContainer->NotifyAll(position);	// Notify any cells that may be observing this position.
+
+	parentContainer->UpdateTable(position);				// Notify GUI to update cell value.
+	return parentContainer->GetCellProxy(position);		// Return stored cell so that failed numerical cells return the stored fallback text cell rather than the original failed numerical cell.
+}
 
+shared_ptr<CELL> CELL::MakeCell(const string& contents, const CELL_DATA& sheet) {
 	auto cell = shared_ptr<CELL>();
 
 	auto key = contents[0];
 	switch (key){
-	case L'\'': { cell = make_shared<TEXT_CELL>(); } break;			// Enforce textual interpretation for format: '__
-	case L'&': { cell = make_shared<REFERENCE_CELL>(); } break;		// Takes input in the form of: &R__C__ or &C__R__
-	case '=': { cell = make_shared<FUNCTION_CELL>(); } break;		// Partial implementation available
+	case L'\'': { cell = sheet.Allocate<TEXT_CELL>(); } break;			// Enforce textual interpretation for format: '__
+	case L'&': { cell = sheet.Allocate<REFERENCE_CELL>(); } break;		// Takes input in the form of: &R__C__ or &C__R__
+	case '=': { cell = sheet.Allocate<FUNCTION_CELL>(); } break;		// Partial implementation available
 	case L'-': [[fallthrough]];
 	case L'.': [[fallthrough]];
 	case L'1': [[fallthrough]];
@@ -44,92 +106,475 @@ CELL::CELL_PROXY CELL::NewCell(CELL_DATA* parentContainer, const CELL_POSITION p
 	case L'7': [[fallthrough]];
 	case L'8': [[fallthrough]];
 	case L'9': [[fallthrough]];
-	case L'0': { cell = make_shared<NUMERICAL_CELL>(); } break;	// Any cell beginning with a number or decimal is a number.
-	default: { cell = make_shared<TEXT_CELL>(); } break;			// By default, all cells are text cells unless otherwise determined.
+	case L'0': { cell = sheet.Allocate<NUMERICAL_CELL>(); } break;	// Any cell beginning with a number or decimal is a number.
+	default: { cell = sheet.Allocate<TEXT_CELL>(); } break;			// By default, all cells are text cells unless otherwise determined.
 	}
+	return cell;
+}
 
-	cell->position = position;
-	cell->rawContent = contents;
-	cell->parentContainer = parentContainer;
-	parentContainer->AssignCell(cell);			// Add cell to cell map upon creation.
+void CELL::RecreateCell(CELL_DATA* parentContainer, const CELL_PROXY& cell, const CELL_POSITION pos) {
+	parentContainer->RequireJournal();
+	auto region = CELL_DATA::DIRTY_REGION{ parentContainer };
+	if (!cell) { parentContainer->EraseCell(pos); }			// Observers of this position stay subscribed.
+	else if (parentContainer->AssignCell(cell.cell)) {		// Restores the subscriptions of the recreated cell.
+		parentContainer->RefreshCell(*cell.cell);			// Its inputs may have changed while it was out of the grid.
+	}
+	parentContainer->NotifyAll(pos);
+	parentContainer->UpdateTable(pos);
+}
 
-	try { cell->InitializeCell(); }			// Call initialize on cell.
-	catch (...) { cell->error = true; }		// Failure of any sort will set the cell into an error state.
-	parentContainer->NotifyAll(position);	// Notify any cells that may be observing this position.
+CELL::BATCH::BATCH(CELL_DATA* parentContainer) : parentContainer{ parentContainer } { parentContainer->BeginBatch(); }
 
-	table->UpdateCell(position);						// Notify GUI to update cell value.
-	return parentContainer->GetCellProxy(position);		// Return stored cell so that failed numerical cells return the stored fallback text cell rather than the original failed numerical cell.
+CELL::BATCH::~BATCH() {
+	try { Commit(); }
+	catch (...) { /*swallow errors*/ }
 }
 
-void CELL::RecreateCell(CELL_DATA* parentContainer, const CELL_PROXY& cell, const CELL_POSITION pos) {
-	if (!cell) { parentContainer->EraseCell(pos); }			// Cell stays subscribed.
-	else { parentContainer->AssignCell(cell.cell); }
-	parentContainer->NotifyAll(pos);
-	table->UpdateCell(pos);
+CELL::CELL_PROXY CELL::BATCH::NewCell(const CELL_POSITION position, const string& contents) {
+	auto oldCell = parentContainer->GetCellProxy(position);
+	auto nCell = CELL::NewCell(parentContainer, position, contents);
+	auto oldText = oldCell ? oldCell->GetRawContent() : ""s;
+	if (contents != oldText) { edits.emplace_back(oldCell, nCell); }
+	return nCell;
+}
+
+void CELL::BATCH::RecreateCell(const CELL_PROXY& cell, const CELL_POSITION pos) { CELL::RecreateCell(parentContainer, cell, pos); }
+
+vector<CELL::EDIT> CELL::BATCH::Commit() {
+	if (open) { open = false; parentContainer->CommitBatch(); }
+	return std::move(edits);
+}
+
+CELL::CELL_DATA::CELL_DATA() : CELL_DATA(0) { }
+
+CELL::CELL_DATA::CELL_DATA(const size_t workerCount) {
+	data.graph = make_unique<DEPENDENCY_GRAPH>();
+	data.pool = make_unique<THREAD_POOL>(workerCount);
+	data.formulas = make_unique<FORMULA_CACHE>();
+	data.snapshot = make_shared<const SHEET_SNAPSHOT>();
+	data.publishedSnapshot.store(data.snapshot.get(), memory_order_release);
 }
 
-// Notifies observing CELLs of change in underlying data.
-// Each CELL is responsible for checking the new data.
+size_t CELL::CELL_DATA::CachedFormulaCount() const { return data.formulas->Size(); }
+
+size_t CELL::CELL_DATA::ObjectCount() const {
+	auto lk = lock_guard<mutex>{ data.lkCellMap };
+	return data.cells.size();
+}
+
+CELL::CELL_DATA::~CELL_DATA() = default;
+
+// Notifies observing CELLs of change in underlying data. Inside a batch, the change is only recorded.
 void CELL::CELL_DATA::NotifyAll(const CELL_POSITION subject) const {
-	auto notificationSet = std::set<CELL_POSITION>{ };
+	if (Batching()) { data.batchChanged.push_back(subject); return; }
+	Propagate({ subject }, { });
+}
+
+void CELL::CELL_DATA::BeginBatch() { ++data.batchDepth; }
+
+// Only edits made from outside are refused. One made while another propagates (a failed number falling back to text, say)
+// finishes that change, which is already under way.
+void CELL::CELL_DATA::RequireJournal() const {
+	if (data.tableHolds == 0 && data.journal && data.journal->Failed()) { throw runtime_error("The journal could not be written, so the change would be lost in a crash."); }
+}
+
+// Only the outermost batch propagates, once, everything staged inside it.
+void CELL::CELL_DATA::CommitBatch() {
+	if (data.batchDepth == 0 || --data.batchDepth != 0) { return; }
+	auto changed = std::exchange(data.batchChanged, { });
+	auto stale = std::exchange(data.batchStale, { });
+	auto region = DIRTY_REGION{ this };		// Releases everything the batch held back
+	Propagate(changed, stale);
+}
+
+void CELL::CELL_DATA::UpdateTable(const CELL_POSITION pos) const {
+	if (data.tableHolds != 0 || Batching()) { data.dirtyRegion.push_back(pos); }
+	else if (data.shown) { table->UpdateCells(span<const CELL_POSITION>{ &pos, 1 }); }
+}
+
+// Each position is listed once, in position order, however many times it was touched.
+CELL::CELL_DATA::DIRTY_REGION::~DIRTY_REGION() {
+	auto& data = parentContainer->data;
+	if (--data.tableHolds != 0 || parentContainer->Batching()) { return; }
+	try { if (data.journal) { data.journal->Commit(); } }		// The change is complete
+	catch (...) { /*swallow errors*/ }
+	auto region = std::exchange(data.dirtyRegion, { });
+	if (!data.shown) { return; }
+	sort(region.begin(), region.end());
+	region.erase(unique(region.begin(), region.end()), region.end());
+	try { if (!region.empty()) { table->UpdateCells(region); } }
+	catch (...) { /*swallow errors*/ }
+}
+
+bool CELL::CELL_DATA::DeferRecalculation(const CELL_POSITION pos) const {
+	if (!Batching()) { return false; }
+	data.batchStale.push_back(pos);
+	return true;
+}
+
+// Every cell downstream of the changed positions (and every stale cell) is recalculated exactly once, in dependency order,
+// so each reads up-to-date inputs. Cells within a level only read cells from earlier levels, so large levels are split across the thread pool.
+// The GUI is not thread safe, so it is told about the changes afterwards from this thread, in one call.
+// Readers on other threads see the whole change at once, through the snapshot published before the GUI is told.
+void CELL::CELL_DATA::Propagate(const vector<CELL_POSITION>& changed, const vector<CELL_POSITION>& stale) const {
+	auto region = DIRTY_REGION{ this };
+	if (data.image) { Activate(changed); }
+	auto levels = vector<vector<pair<shared_ptr<CELL>, bool>>>{ };
 	{
-		auto lk = lock_guard<mutex>{ data.lkSubMap };		// Lock only to get local copy of notification set
-		auto it = data.subscriptionMap.find(subject);
-		if (it == data.subscriptionMap.end()) { return; }
-		notificationSet = it->second;					// Get local copy of notification set so that lock can be released before updating cells, which will require it's own lock downstream
+		auto lk = lock_guard<mutex>{ data.lkSubMap };		// Lock only to get the recalculation order
+		for (auto& positions : data.graph->RecalculationLevels(changed, stale)) {
+			auto& level = levels.emplace_back();
+			for (auto observer : positions) {
+				auto oCell = GetObject(observer);
+				if (oCell) { level.emplace_back(oCell, data.graph->IsCircular(observer)); }
+			}
+		}
 	}
-	for (auto observer: notificationSet) { 
-		auto oCell = GetCell(observer);
-		if (oCell) { oCell->UpdateCell(); }
+	for (auto& level : levels) {
+		auto recalculate = [this, &level](const size_t i) { RecalculateCell(*level[i].first, level[i].second); };
+		if (level.size() < ParallelThreshold_) { for (auto i = size_t{ 0 }; i < level.size(); ++i) { recalculate(i); } }
+		else { data.pool->ParallelFor(level.size(), recalculate, max(ParallelGrain_, level.size() / (8 * (data.pool->WorkerCount() + 1)))); }
 	}
+	auto published = changed;
+	for (auto& level : levels) { for (auto& [oCell, circular] : level) { published.push_back(oCell->position); } }
+	sort(published.begin(), published.end());
+	published.erase(unique(published.begin(), published.end()), published.end());
+	PublishSnapshot(published);
+	for (auto& level : levels) { for (auto& [oCell, circular] : level) { UpdateTable(oCell->position); } }
 }
 
-void CELL::CELL_DATA::AssignCell(const shared_ptr<CELL> cell) {
+// Build the next version from the previous one, copying only the paths to entries that actually changed.
+// The replaced version is retired through EPOCH, since a reader may be taking hold of it at this moment.
+void CELL::CELL_DATA::PublishSnapshot(const vector<CELL_POSITION>& changed) const {
+	auto changes = vector<SHEET_SNAPSHOT::CHANGE>{ };
+	{
+		auto guard = EPOCH::GUARD{ };
+		for (auto pos : changed) {
+			auto slot = FindSlot(pos);
+			auto old = data.snapshot->Find(pos);
+			if (!slot) { if (old) { changes.emplace_back(pos, nullptr); } continue; }
+			auto entry = slot.IsNumber() ? SHEET_SNAPSHOT::ENTRY{ pos, slot.Number() }
+				: slot.IsText() ? SHEET_SNAPSHOT::ENTRY{ pos, data.strings.Share(*slot.Text()), slot.Value() }
+				: SHEET_SNAPSHOT::ENTRY{ pos, slot.Cell()->rawContent, slot.Cell()->GetValue(), &data.strings };
+			if (old && *old == entry) { continue; }
+			changes.emplace_back(pos, Allocate<SHEET_SNAPSHOT::ENTRY>(std::move(entry)));
+		}
+	}
+	if (changes.empty()) { return; }
+	auto previous = std::exchange(data.snapshot, data.snapshot->Apply(changes));
+	data.publishedSnapshot.store(data.snapshot.get(), memory_order_release);
+	EPOCH::Retire(std::move(previous));
+}
+
+// Lock-free. The published version cannot be destroyed while pinned, so it is safe to take a new reference to it.
+shared_ptr<const SHEET_SNAPSHOT> CELL::CELL_DATA::Snapshot() const {
+	auto guard = EPOCH::GUARD{ };
+	return data.publishedSnapshot.load(memory_order_acquire)->shared_from_this();
+}
+
+// Cells inside a reference loop skip evaluation entirely and report a circular-reference error.
+void CELL::CELL_DATA::RecalculateCell(CELL& cell, const bool circular) const {
+	cell.circular = circular;
+	if (!circular) { cell.Recalculate(); }
+	++cell.recalculationCount;
+	++data.recalculationCount;
+}
+
+void CELL::CELL_DATA::RefreshCell(CELL& cell) const { if (!DeferRecalculation(cell.position)) { RecalculateCell(cell, IsCircular(cell.position)); } }
+
+// The cell at a position owns the subscriptions made from that position.
+// Replacing it drops the old cell's subscriptions and restores any already recorded by the new cell.
+// A cell that merely shows a plain value (one made to be looked at, say) goes back into the grid as that value.
+bool CELL::CELL_DATA::AssignCell(const shared_ptr<CELL> cell) {
+	if (auto literal = MakeLiteral(*cell->rawContent, cell->GetValue())) { AssignSlot(cell->position, literal); return false; }
+	ReleaseSubscriptions(cell->position);
+	for (auto subject : cell->subscriptions) { SubscribeToCell(subject, cell->position); }
+	for (auto [first, last] : cell->rangeSubscriptions) { SubscribeToRange(first, last, cell->position); }
+	auto lk = lock_guard<mutex>{ data.lkCellMap };
+	ReleaseSaved(data.image.get(), cell->position);
+	ReleaseSlot(data.cellGrid.Assign(cell->position, SLOT::FromCell(cell.get())));
+	data.cells[cell->position] = cell;
+	if (data.journal) { data.journal->Append(cell->position, *cell->rawContent); }
+	return true;
+}
+
+void CELL::CELL_DATA::AssignSlot(const CELL_POSITION pos, const SLOT slot) {
+	ReleaseSubscriptions(pos);
 	auto lk = lock_guard<mutex>{ data.lkCellMap };
-	data.cellMap[cell->position] = cell;
+	ReleaseSaved(data.image.get(), pos);
+	ReleaseSlot(data.cellGrid.Assign(pos, slot));
+	if (data.journal) { data.journal->Append(pos, slot.RawContent()); }
 }
 
 void CELL::CELL_DATA::EraseCell(const CELL_POSITION pos) {
+	ReleaseSubscriptions(pos);
 	auto lk = lock_guard<mutex>{ data.lkCellMap };
-	data.cellMap.erase(pos);
+	ReleaseSaved(data.image.get(), pos);
+	ReleaseSlot(data.cellGrid.Erase(pos));
+	if (data.journal) { data.journal->Append(pos, { }); }
 }
 
+// A replaced CELL is retired, since a reader may still be using it. Text is retired by the pool once no slot holds it.
+void CELL::CELL_DATA::ReleaseSlot(const SLOT slot) const {
+	if (slot.IsText()) { data.strings.Release(slot.Text()); }
+	if (!slot.IsCell()) { return; }
+	auto it = data.cells.find(slot.Cell()->position);
+	if (it == data.cells.end() || it->second.get() != slot.Cell()) { return; }
+	EPOCH::Retire(std::move(it->second));
+	data.cells.erase(it);
+}
+
+// Numbers are only kept in the slot if their raw content is how the number is written anyway, since only the number is kept.
+// Anything else that reads as a number (1.50, say) stays a NUMERICAL_CELL. A failed number is kept as text, just as NUMERICAL_CELL re-enters it.
+CELL::SLOT CELL::CELL_DATA::MakeLiteral(const string& contents) const {
+	auto key = contents.empty() ? '&' : contents[0];
+	if (key == '&' || key == '=') { return SLOT{ }; }
+	if (key != '-' && key != '.' && !isdigit(static_cast<unsigned char>(key))) { return SLOT::FromText(data.strings.Intern(contents)); }
+	auto number = 0.0;
+	if (!ParseNumber(contents, number)) { return SLOT::FromText(data.strings.Intern("'" + contents)); }
+	return NumberContent(number) == contents ? SLOT::FromNumber(number) : SLOT{ };
+}
+
+CELL::SLOT CELL::CELL_DATA::MakeLiteral(const string& contents, const CELL_VALUE& shown) const {
+	auto literal = MakeLiteral(contents);
+	if (!literal || literal.Value() == shown) { return literal; }
+	ReleaseSlot(literal);
+	return SLOT{ };
+}
+
+// Text & numbers repeat, as labels do, so are shared through the pool. Formulas & references seldom do, and would cost
+// the pool more than they save, so each has its own copy, carved from the sheet's pools.
+STRING_POOL::TEXT CELL::CELL_DATA::Contents(const string_view contents) const {
+	if (contents.starts_with('=') || contents.starts_with('&')) { return allocate_shared<const string>(POOL_ALLOCATOR<string>{ data.objects }, contents); }
+	return data.strings.Share(contents);
+}
+
+// Built like a saved cell, from its contents & value. Placing it back into the grid (see RecreateCell) stores the value again.
+shared_ptr<CELL> CELL::CELL_DATA::MakeValueCell(const CELL_POSITION pos, const SLOT slot) const {
+	auto cell = slot.IsNumber() ? shared_ptr<CELL>{ Allocate<NUMERICAL_CELL>() } : shared_ptr<CELL>{ Allocate<TEXT_CELL>() };
+	cell->position = pos;
+	cell->rawContent = slot.IsText() ? data.strings.Share(*slot.Text()) : allocate_shared<const string>(POOL_ALLOCATOR<string>{ data.objects }, slot.RawContent());
+	cell->parentContainer = const_cast<CELL_DATA*>(this);
+	cell->RestoreValue(slot.Value());
+	return cell;
+}
+
+// A built cell holds its saved value & subscriptions, but is not subscribed until a change reaches it (see Activate).
+// Cells point back at their container, so building one from a const lookup needs a non-const pointer to the sheet. No contents change.
+CELL::SLOT CELL::CELL_DATA::BuildCell(const CELL_POSITION pos) const {
+	auto index = data.image->Find(pos);
+	if (index == WORKBOOK_IMAGE::None || data.image->State(index) != WORKBOOK_IMAGE::STORED) { return data.cellGrid.Find(pos); }
+	auto lk = lock_guard<mutex>{ data.lkCellMap };
+	if (data.image->State(index) == WORKBOOK_IMAGE::STORED) {		// Another thread may have built it meanwhile
+		PlaceSaved(index);
+		data.image->SetState(index, WORKBOOK_IMAGE::BUILT);
+	}
+	return data.cellGrid.Find(pos);
+}
+
+void CELL::CELL_DATA::BuildCells(const CELL_POSITION first, const CELL_POSITION last) const {
+	if (!data.image) { return; }
+	auto lk = lock_guard<mutex>{ data.lkCellMap };
+	data.image->ForEachIn(first, last, [this](const size_t index) {
+		if (data.image->State(index) != WORKBOOK_IMAGE::STORED) { return; }
+		PlaceSaved(index);
+		data.image->SetState(index, WORKBOOK_IMAGE::BUILT);
+	});
+}
+
+// Plain values go straight into their slot. Anything else is built into a CELL.
+void CELL::CELL_DATA::PlaceSaved(const size_t index) const {
+	auto pos = data.image->Position(index);
+	auto slot = data.image->Literal(index, *this);
+	auto cell = slot ? nullptr : data.image->Build(index, const_cast<CELL_DATA*>(this));
+	if (cell) { slot = SLOT::FromCell(cell.get()); }
+	ReleaseSlot(data.cellGrid.Assign(pos, slot));
+	if (cell) { data.cells[pos] = std::move(cell); }
+}
+
+// Everything downstream of the changes is brought into the graph before the recalculation order is worked out.
+// A subscribed cell hears of later changes through the graph, and its own observers were brought in along with it,
+// so each saved cell is brought in once at most.
+void CELL::CELL_DATA::Activate(const vector<CELL_POSITION>& changed) const {
+	auto pending = changed;
+	auto guard = EPOCH::GUARD{ };
+	while (!pending.empty()) {
+		auto subject = pending.back();
+		pending.pop_back();
+		data.image->ForEachObserver(subject, [this, &pending](const CELL_POSITION observer) {
+			auto index = data.image->Find(observer);
+			if (index == WORKBOOK_IMAGE::None || data.image->State(index) == WORKBOOK_IMAGE::RELEASED) { return; }
+			auto slot = BuildCell(observer);
+			data.image->SetState(index, WORKBOOK_IMAGE::RELEASED);
+			if (!slot.IsCell()) { return; }		// A plain value observes nothing
+			auto cell = slot.Cell();
+			auto lk = lock_guard<mutex>{ data.lkSubMap };
+			for (auto subject : cell->subscriptions) { data.graph->AddEdge(subject, observer); }
+			for (auto [first, last] : cell->rangeSubscriptions) { data.graph->AddRangeEdge(first, last, observer); }
+			pending.push_back(observer);
+		});
+	}
+}
+
+void CELL::CELL_DATA::Materialize(const CELL_POSITION first, const CELL_POSITION last) {
+	BuildCells(first, last);
+	auto positions = vector<CELL_POSITION>{ };
+	{
+		auto guard = EPOCH::GUARD{ };
+		data.cellGrid.ForEachIn(first, last, [&positions](const CELL_POSITION pos, const SLOT) { positions.push_back(pos); });
+	}
+	PublishSnapshot(positions);
+}
+
+void CELL::Evaluate() { if (!parentContainer->DeferRecalculation(position)) { Recalculate(); } }
+
 // Subscribe to notification of changes in target CELL.
-void CELL::SubscribeToCell(const CELL_POSITION subject) const { parentContainer->SubscribeToCell(subject, position); }
+void CELL::SubscribeToCell(const CELL_POSITION subject) {
+	subscriptions.push_back(subject);
+	parentContainer->SubscribeToCell(subject, position);
+}
 
-// Use static overload below
-void CELL::UnsubscribeFromCell(const CELL_POSITION subject) const { parentContainer->UnsubscribeFromCell(subject, position); }
+void CELL::SubscribeToRange(const CELL_POSITION first, const CELL_POSITION last) {
+	rangeSubscriptions.emplace_back(first, last);
+	parentContainer->SubscribeToRange(first, last, position);
+}
+
+CELL::SLOT CELL::LookupSlot(const CELL_POSITION pos) const { return parentContainer->FindSlot(pos); }
+
+STRING_POOL::TEXT CELL::ShareText(const string_view text) const { return parentContainer->ShareText(text); }
+
+shared_ptr<const FORMULA_PROGRAM> CELL::CompileFormula(const string_view text) const { return parentContainer->CompileFormula(text, position); }
+
+shared_ptr<const FORMULA_PROGRAM> CELL::CELL_DATA::CompileFormula(const string_view text, const CELL_POSITION anchor) { return data.formulas->Get(text, anchor); }
+
+bool CELL::GatherNumbers(const CELL_POSITION first, const CELL_POSITION last, double* out, size_t& count) const { return parentContainer->GatherNumbers(first, last, out, count); }
+
+// One pass over the grid under a single epoch pin, rather than a lookup per cell. Plain numbers are read straight from their slots.
+bool CELL::CELL_DATA::GatherNumbers(const CELL_POSITION first, const CELL_POSITION last, double* out, size_t& count) const {
+	auto failed = false;
+	count = 0;
+	BuildCells(first, last);
+	auto guard = EPOCH::GUARD{ };
+	data.cellGrid.ForEachIn(first, last, [out, &count, &failed](const CELL_POSITION, const SLOT slot) {
+		if (slot.IsNumber()) { out[count++] = slot.Number(); return; }
+		if (!slot.IsCell()) { return; }		// Text
+		auto value = slot.Cell()->GetValue();
+		if (auto number = get_if<double>(&value)) { out[count++] = *number; }
+		else if (holds_alternative<CELL_ERROR>(value)) { failed = true; }
+	});
+	return !failed;
+}
 
 void CELL::CELL_DATA::SubscribeToCell(const CELL_POSITION subject, const CELL_POSITION observer) {
 	auto lk = lock_guard<mutex>{ data.lkSubMap };
-	auto& observerSet = data.subscriptionMap[subject];
-	observerSet.insert(observer);
+	data.graph->AddEdge(subject, observer);
 }
 
-// Remove observer link (Subject, Observer)
-void CELL::CELL_DATA::UnsubscribeFromCell(const CELL_POSITION subject, const CELL_POSITION observer) {
+void CELL::CELL_DATA::SubscribeToRange(const CELL_POSITION first, const CELL_POSITION last, const CELL_POSITION observer) {
 	auto lk = lock_guard<mutex>{ data.lkSubMap };
-	auto itSubject = data.subscriptionMap.find(subject);
-	if (itSubject == data.subscriptionMap.end()) { return; }
-	(*itSubject).second.erase(observer);
+	data.graph->AddRangeEdge(first, last, observer);
 }
 
-std::shared_ptr<CELL> CELL::CELL_DATA::GetCell(const CELL::CELL_POSITION pos) const {
-	auto lk = lock_guard<mutex>{ data.lkCellMap };
-	auto it = data.cellMap.find(pos);
-	return it != data.cellMap.end() ? it->second : nullptr;
+// Remove all observer links (Subject, Observer) for the given observer.
+void CELL::CELL_DATA::ReleaseSubscriptions(const CELL_POSITION observer) {
+	auto lk = lock_guard<mutex>{ data.lkSubMap };
+	data.graph->RemoveObserver(observer);
+}
+
+bool CELL::CELL_DATA::IsCircular(const CELL_POSITION pos) const {
+	auto lk = lock_guard<mutex>{ data.lkSubMap };
+	return data.graph->IsCircular(pos);
+}
+
+// Lock-free. A CELL cannot be destroyed while pinned, so it is safe to take a new reference to it. A plain value is shown through a new one.
+pair<shared_ptr<CELL>, bool> CELL::CELL_DATA::GetCell(const CELL::CELL_POSITION pos) const {
+	auto guard = EPOCH::GUARD{ };
+	auto slot = FindSlot(pos);
+	if (slot.IsCell()) { return { slot.Cell()->shared_from_this(), false }; }
+	return { slot ? MakeValueCell(pos, slot) : nullptr, bool{ slot } };
+}
+
+shared_ptr<CELL> CELL::CELL_DATA::GetObject(const CELL::CELL_POSITION pos) const {
+	auto guard = EPOCH::GUARD{ };
+	auto slot = FindSlot(pos);
+	return slot.IsCell() ? slot.Cell()->shared_from_this() : nullptr;
+}
+
+CELL::SLOT CELL::CELL_DATA::FindSlot(const CELL::CELL_POSITION pos) const {
+	auto slot = data.cellGrid.Find(pos);
+	return slot || !data.image ? slot : BuildCell(pos);
+}
+
+string CELL::CELL_DATA::RawContent(const CELL::CELL_POSITION pos) const {
+	auto guard = EPOCH::GUARD{ };
+	return FindSlot(pos).RawContent();
+}
+
+CELL::CELL_PROXY CELL::CELL_DATA::GetCellProxy(const CELL::CELL_POSITION pos) {
+	auto [cell, literal] = GetCell(pos);
+	return CELL_PROXY{ std::move(cell), literal };
+}
+
+CELL::CELL_VIEW CELL::CELL_DATA::GetCellView(const CELL::CELL_POSITION pos) const {
+	auto [cell, literal] = GetCell(pos);
+	return CELL_VIEW{ std::move(cell), literal };
 }
 
-CELL::CELL_PROXY CELL::CELL_DATA::GetCellProxy(const CELL::CELL_POSITION pos) { return CELL_PROXY{ CELL_DATA::GetCell(pos) }; }
+bool CELL::SameCell(const CELL* lhs, const bool lhsLiteral, const CELL* rhs, const bool rhsLiteral) {
+	if (lhs == rhs) { return true; }
+	if (!lhsLiteral || !rhsLiteral) { return false; }
+	return lhs->parentContainer == rhs->parentContainer && lhs->position == rhs->position && *lhs->rawContent == *rhs->rawContent;
+}
+
+CELL::CELL_VALUE CELL::SLOT::Value() const {
+	if (IsNumber()) { return Number(); }
+	if (IsText()) { return Text()->substr(Text()->starts_with('\'') ? 1 : 0); }		// Shown without the ' that enforces text, as by TEXT_CELL
+	if (IsCell()) { return Cell()->GetValue(); }
+	return CELL_VALUE{ };
+}
+
+string CELL::SLOT::RawContent() const {
+	if (IsNumber()) { return NumberContent(Number()); }
+	if (IsText()) { return *Text(); }
+	if (IsCell()) { return Cell()->GetRawContent(); }
+	return string{ };
+}
 
 void CELL::UpdateCell() {
-	table->UpdateCell(position); 			// Call update cell on GUI base pointer.
-	parentContainer->NotifyAll(position);	// Cascade notification
+	auto region = CELL_DATA::DIRTY_REGION{ parentContainer };
+	parentContainer->RefreshCell(*this);
+	parentContainer->UpdateTable(position);	// Call update cell on GUI base pointer.
+	parentContainer->NotifyAll(position);	// Recalculate downstream cells
 }
 
-void TEXT_CELL::InitializeCell() {
-	CELL::InitializeCell();
-	if (displayValue[0] == L'\'') { displayValue.erase(0, 1); }		// Omit preceeding ' if it was added to enforce a text cell
+// Build display text from a typed value.
+string CELL::DisplayString(const CELL_VALUE& value) {
+	if (auto number = get_if<double>(&value)) { return to_string(*number); }
+	if (auto text = get_if<string>(&value)) { return *text; }
+	if (auto errorCode = get_if<CELL_ERROR>(&value)) {
+		switch (*errorCode) {
+		case CELL_ERROR::REFERENCE: { return "!REF!"s; }
+		case CELL_ERROR::CIRCULAR: { return "!CIRC!"s; }
+		default: { return "!ERROR!"s; }
+		}
+	}
+	return ""s;
+}
+
+// The shortest text that reads back as the same number, without an exponent.
+string CELL::NumberContent(const double value) {
+	auto text = array<char, 400>{ };		// Room for any double written out in full
+	auto [end, error] = to_chars(text.data(), text.data() + text.size(), value, chars_format::fixed);
+	return error == errc{ } ? string(text.data(), end) : string{ };
+}
+
+// Text is shown from the contents, so only an error needs restoring.
+void CELL::RestoreValue(const CELL_VALUE& value) { error = holds_alternative<CELL_ERROR>(value); }
+
+CELL::CELL_VALUE TEXT_CELL::StoredValue() const {
+	auto text = GetRawContent();
+	if (text.starts_with('\'')) { text.erase(0, 1); }		// Omit preceeding ' if it was added to enforce a text cell
+	return text;
 }
 
 // Parese string into Row & Column positions of reference cell
@@ -156,44 +601,95 @@ CELL::CELL_POSITION ReferenceStringToCellPosition(const string& refString) {
 // Subscribe to updates on referenced cell once it's position is determined
 void REFERENCE_CELL::InitializeCell() {
 	try {
-		referencePosition = ReferenceStringToCellPosition(GetRawContent());
-		SubscribeToCell(referencePosition);
+		Subscribe();
+		Evaluate();
 	}
 	catch (...){ error = true; }
 }
 
+void REFERENCE_CELL::Subscribe() {
+	referencePosition = ReferenceStringToCellPosition(GetRawContent());
+	SubscribeToCell(referencePosition);
+}
+
+// Only the position is parsed. The subscription itself is restored with the rest of the dependency graph.
+void REFERENCE_CELL::RestoreValue(const CELL_VALUE& value) {
+	try { referencePosition = ReferenceStringToCellPosition(GetRawContent()); }
+	catch (...) { error = true; }
+	KeepValue(value);
+}
+
+// Take the value of the referenced cell, which has already been brought up to date.
+// Dangling reference & reference to self both cause a reference error.
+void REFERENCE_CELL::Recalculate() {
+	auto guard = EPOCH::GUARD{ };
+	auto slot = LookupSlot(referencePosition);
+	if (!slot || referencePosition == position) { KeepValue(CELL_ERROR::REFERENCE); }
+	else { KeepValue(slot.Value()); }
+}
+
+CELL::CELL_VALUE REFERENCE_CELL::StoredValue() const {
+	if (error) { return CELL_ERROR::GENERIC; }
+	return referencedText ? CELL_VALUE{ *referencedText } : referencedValue;
+}
+
+void REFERENCE_CELL::KeepValue(CELL_VALUE value) {
+	auto text = get_if<string>(&value);
+	referencedText = text ? ShareText(*text) : nullptr;
+	referencedValue = text ? CELL_VALUE{ } : std::move(value);
+}
+
 // Override default error behavior.
 // Any cell that seems like a number, but cannot be converted to such defaults to text.
 // Create a new cell at the same position with a prepended text-enforcement character.
-// Manually check for alpha characters since std::stod() is more forgiving than is appropriate for this situation.
 void NUMERICAL_CELL::InitializeCell() {
-	try { 
-		for (auto c : GetRawContent()) { if (!isdigit(c) && c != '.' && c != '-') { throw invalid_argument("Error parsing input text. \nText could not be interpreted as a number"); } }
-		storedValue = stod(GetRawContent());
-	}
-	catch (...) { CELL::NewCell(parentContainer, position, "'" + GetRawContent()); }
+	if (!Parse()) { CELL::NewCell(parentContainer, position, "'" + GetRawContent()); }
 }
 
-// Parse function text into actual functions.
+bool NUMERICAL_CELL::Parse() { return ParseNumber(GetRawContent(), storedValue); }
+
+void NUMERICAL_CELL::RestoreValue(const CELL_VALUE& value) {
+	if (auto number = get_if<double>(&value)) { storedValue = *number; }
+	else { error = true; }
+}
+
+// Compile function text into a program (or share one already compiled), then subscribe to each referenced cell & range.
 void FUNCTION_CELL::InitializeCell() {
-	auto inputText = GetRawContent().substr(1);
-	auto vArgs = vector<shared_ptr<ARGUMENT>>{ };
-	try { 
-		vArgs.push_back(ParseFunctionString(inputText));	// Recursively parse input string
-		m_Func = make_shared<FUNCTION>(std::move(vArgs));
-		storedValue = m_Func->Get();
-	}
-	catch (...) { m_Func = make_shared<FUNCTION>(); error = true; }
+	Subscribe();
+	if (program) { Evaluate(); }
 }
 
-// Recalculate function when an underlying reference argument is changed.
-void FUNCTION_CELL::UpdateCell() {
-	displayValue = "";
-	error = false;		// Reset error flag in case there was a prior error
-	try { 
-		m_Func->UpdateArgument();
-		storedValue = m_Func->Get();
-	}
-	catch (...) { error = true; }
-	CELL::UpdateCell();
-}
\ No newline at end of file
+void FUNCTION_CELL::Subscribe() {
+	if (!program && !Compile()) { error = true; return; }
+	for (auto pos : program->References(position)) { SubscribeToCell(pos); }
+	for (auto [first, last] : program->Ranges(position)) { SubscribeToRange(first, last); }
+}
+
+bool FUNCTION_CELL::Compile() {
+	auto content = GetRawContent();
+	try { program = CompileFormula(string_view{ content }.substr(1)); }
+	catch (...) { program = nullptr; }
+	return bool{ program };
+}
+
+// Re-run the program when an underlying reference is changed.
+// Dangling reference, reference to self & non-numeric values all stop the program with an error.
+void FUNCTION_CELL::Recalculate() {
+	if (!program && !Compile()) { error = true; return; }
+	auto guard = EPOCH::GUARD{ };		// Covers every load made by the program
+	auto result = program->Run(position, [this](const CELL_POSITION pos) {
+		auto slot = LookupSlot(pos);
+		if (!slot || pos == position) { return FORMULA_PROGRAM::RESULT{ 0, "Reference Error" }; }
+		if (slot.IsNumber()) { return FORMULA_PROGRAM::RESULT{ slot.Number() }; }
+		auto value = slot.Value();
+		auto number = get_if<double>(&value);
+		if (!number) { return FORMULA_PROGRAM::RESULT{ 0, "Value Error" }; }		// Text, empty & error values cannot be used as numbers.
+		return FORMULA_PROGRAM::RESULT{ *number };
+	}, [this](const CELL_POSITION first, const CELL_POSITION last, double* out) {
+		auto gathered = FORMULA_PROGRAM::RANGE_RESULT{ };
+		if (!GatherNumbers(first, last, out, gathered.count)) { gathered.error = "Value Error"; }
+		return gathered;
+	});
+	error = result.error != nullptr;		// Reset error flag in case there was a prior error
+	if (!error) { storedValue = result.value; }
+}
@@ -12,6 +12,12 @@
 // Next, an unordered map (hash table) was used to get constant time O(1) expected operation speed.
 // However, hashing may take long enough that O(1) > O( log(n) ) for small values of n.
 // Also, a 2-D array could be used to get O(1) speed plus cache localization at the cost of many empty slots.
+// CELL data is now held in a tiled grid (see Slot_Grid.hpp), which splits the difference: 2-D array addressing within
+// fixed-size tiles that are only allocated once written. See benchmarks/Grid_Benchmark.cpp for the comparison.
+// Each position of the grid is a single word (see SLOT). Plain numbers & text are kept in the word itself, so only references
+// and formulas are CELL objects; a plain value is shown through a CELL built for the purpose when it is looked up.
+// Lookups do not lock: slots are published atomically into the grid and readers pin an epoch
+// (see Epoch.hpp) so that a cell or text replaced while being read is only destroyed once the read is over.
 // CELL_POSITION defines it's own operator< and operator== for use in map sorting as well as a hash function.
 // The choice of column sorting preempting row sorting is arbitrary. Either way is fine so long as it is consistent.
 *////////////////////////////////////////////////////////////////////////////////////////////////
@@ -19,18 +25,43 @@
 #ifndef CELL_CLASS_HPP
 #define CELL_CLASS_HPP
 
+#include "Epoch.hpp"
+#include "Pool_Allocator.hpp"
+#include "Slot_Grid.hpp"
+#include "String_Pool.hpp"
+#include "Thread_Pool.hpp"
 #include <memory>
 
-#include <future>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+class DEPENDENCY_GRAPH;
+class FORMULA_CACHE;
+class FORMULA_PROGRAM;
+class SHEET_SNAPSHOT;
+class WORKBOOK_FILE;
+class WORKBOOK_IMAGE;
+class CSV_FILE;
+class JOURNAL;
 
 constexpr auto MaxRow_{ UINT16_MAX };
 constexpr auto MaxColumn_{ UINT16_MAX };
 
 // Base class for all cells.
 // It stores the raw input string, a display value of that string, and returns the protected display value.
-class CELL {
+class CELL : public std::enable_shared_from_this<CELL> {
 public:
 	// Position of cell: Column, Row
 	struct CELL_POSITION {
@@ -38,11 +69,18 @@ public:
 		unsigned int row{ 0 };
 	};
 
+	// Error states a cell may evaluate to.
+	enum class CELL_ERROR { GENERIC, REFERENCE, CIRCULAR };
+
+	// Typed result of a cell: empty, number, text, or error.
+	// Cells read one another through this rather than through display strings, which are only built for display.
+	using CELL_VALUE = std::variant<std::monostate, double, std::string, CELL_ERROR>;
+
 	// Hash function of CELL_POSITION
 	// It is simply a bitwise concatination of the column and row bits.
 	struct CELL_HASH {
 		std::size_t operator() (CELL::CELL_POSITION const& pos) const {
-			auto x = unsigned long{ 0 };
+			auto x = std::size_t{ 0 };
 			x = x | pos.column;
 			x = x << 16;
 			x = x | pos.row;
@@ -50,48 +88,78 @@ public:
 		}
 	};
 
+private:
+	// What one position of the grid holds: nothing, a number, a piece of the sheet's interned text (see String_Pool.hpp), or a CELL.
+	// A slot is one word, read & written atomically. Numbers are stored offset by 2^49, which leaves every word with its top
+	// 16 bits clear to pointers (which never use them on the platforms targeted), and text is told from a CELL by its pointer's lowest bit.
+	// A slot holding text counts as one reference to it.
+	class SLOT {
+		static constexpr auto NumberOffset{ std::uint64_t{ 1 } << 49 };
+		static constexpr auto TextTag{ std::uint64_t{ 1 } };
+		std::uint64_t word{ 0 };
+		explicit SLOT(const std::uint64_t word) : word{ word } { }
+	public:
+		SLOT() = default;
+		static SLOT FromNumber(const double value) { return SLOT{ std::bit_cast<std::uint64_t>(value == value ? value : std::numeric_limits<double>::quiet_NaN()) + NumberOffset }; }
+		static SLOT FromText(const std::string* text) { return SLOT{ reinterpret_cast<std::uintptr_t>(text) | TextTag }; }
+		static SLOT FromCell(CELL* cell) { return SLOT{ reinterpret_cast<std::uintptr_t>(cell) }; }
+
+		explicit operator bool() const { return word != 0; }
+		bool IsNumber() const { return word >= NumberOffset; }
+		bool IsText() const { return !IsNumber() && (word & TextTag) != 0; }
+		bool IsCell() const { return word != 0 && !IsNumber() && (word & TextTag) == 0; }
+		double Number() const { return std::bit_cast<double>(word - NumberOffset); }
+		const std::string* Text() const { return reinterpret_cast<const std::string*>(static_cast<std::uintptr_t>(word & ~TextTag)); }
+		CELL* Cell() const { return reinterpret_cast<CELL*>(static_cast<std::uintptr_t>(word)); }
+
+		CELL_VALUE Value() const;				// Caller must hold an EPOCH::GUARD, or the slot's reference to its text.
+		std::string RawContent() const;			// As above.
+		friend bool operator== (const SLOT&, const SLOT&) = default;
+	};
+
+public:
+	// Cells showing plain values are built afresh by each lookup, so any two showing the same contents at the same position are the same cell.
+	static bool SameCell(const CELL* lhs, const bool lhsLiteral, const CELL* rhs, const bool rhsLiteral);
+
+	// Read-only handle to a cell, for lookups, display & bookkeeping.
+	// A view only offers const access, so copying or reading through one never notifies or recalculates anything.
+	class CELL_VIEW {
+		friend class CELL;
+		std::shared_ptr<const CELL> cell;
+		bool literal{ false };		// Built to show a plain value
+		CELL_VIEW(std::shared_ptr<const CELL> target, const bool literal) : cell{ std::move(target) }, literal{ literal } { }
+	public:
+		CELL_VIEW() = default;
+		explicit CELL_VIEW(std::shared_ptr<const CELL> target) : cell{ std::move(target) } { }
+
+		const CELL* operator->() const { return cell.get(); }
+		explicit operator bool() const { return bool{ cell }; }
+
+		friend bool operator== (const CELL::CELL_VIEW& lhs, const CELL::CELL_VIEW& rhs) { return SameCell(lhs.cell.get(), lhs.literal, rhs.cell.get(), rhs.literal); }
+
+		friend bool operator!= (const CELL::CELL_VIEW& lhs, const CELL::CELL_VIEW& rhs) { return !(lhs == rhs); }
+	};
+
 	// Any changes to a CELL should trigger a notification
 	// Utilizing a "Proxy" pattern ensures that a notification is sent whenever a change is made
 	// Users of CELL have only indirect access to CELLs since they should not be responsible for sending notifications.
+	// Changes are only made through the factory functions (NewCell & RecreateCell) or an explicit UpdateCell, which notify.
+	// Copying, moving or assigning a proxy merely shares the handle, so holding on to cells (as a BATCH does with its edits) costs nothing.
 	class CELL_PROXY {
 		friend class CELL;
 		std::shared_ptr<CELL> cell;
+		bool literal{ false };		// Built to show a plain value
 		auto operator*() const { return *cell; }
+		CELL_PROXY(std::shared_ptr<CELL> target, const bool literal) : cell{ std::move(target) }, literal{ literal } { }
 	public:
 		CELL_PROXY() = default;
 		explicit CELL_PROXY(std::shared_ptr<CELL> target) : cell{ std::move(target) } { }
-		~CELL_PROXY() = default;
-
-		// Custom copy & move update cell. Move constructors swallow errors to allow typical noexcept behavior
-		CELL_PROXY& operator=(const CELL_PROXY& target) { cell = target.cell; if (cell) { cell->UpdateCell(); } return *this; }
-		CELL_PROXY(const CELL_PROXY& target) : cell{target.cell} { cell = target.cell; if (cell) { cell->UpdateCell(); } }
-
-		CELL_PROXY& operator=(CELL_PROXY&& target) {
-			cell = std::move(target.cell);
-			try { if (cell) { cell->UpdateCell(); } }
-			catch (...) { /*swallow errors*/ }
-			return *this;
-		}
-
-		CELL_PROXY(CELL_PROXY&& target) noexcept : cell{ std::move(target.cell) } {
-			try { if (cell) { cell->UpdateCell(); } }
-			catch (...) { /*swallow errors*/ }
-		}
-
-		// Can share in or assume ownership of cell pointer
-		CELL_PROXY& operator=(const std::shared_ptr<CELL>& target) { cell = target; if (cell) { cell->UpdateCell(); } return *this; }
-
-		CELL_PROXY& operator=(std::shared_ptr<CELL>&& target) noexcept {
-			cell = std::move(target);
-			try { if (cell) { cell->UpdateCell(); } }
-			catch (...) { /*swallow errors*/ }
-			return *this;
-		}
 
 		auto operator->() const { return cell; }
 		explicit operator bool() const { return bool{ cell }; }
+		CELL_VIEW View() const { return CELL_VIEW{ cell, literal }; }
 
-		friend bool operator== (const CELL::CELL_PROXY& lhs, const CELL::CELL_PROXY& rhs) { return lhs.cell.get() == rhs.cell.get(); }
+		friend bool operator== (const CELL::CELL_PROXY& lhs, const CELL::CELL_PROXY& rhs) { return SameCell(lhs.cell.get(), lhs.literal, rhs.cell.get(), rhs.literal); }
 
 		friend bool operator!= (const CELL::CELL_PROXY& lhs, const CELL::CELL_PROXY& rhs) { return !(lhs == rhs); }
 	};
@@ -99,62 +167,203 @@ public:
 	// Allows client to store all CELL data and subscriptions, allowing any number of sets as needed.
 	// An "Observer" pattern is used to notify relevant cells when changes occur.
 	// Changes may cascade, so notifications need to handle that effectively.
-	// Stores a set of observers for each subject.
+	// Subscriptions form a dependency graph (see Dependency_Graph.hpp). A change recalculates each downstream cell
+	// exactly once, in topological order, rather than cascading recursively through each observer.
 	// Automatically synchronizes data access for threading (even for non-const functions).
-	// While not needed in this use case, it is still valuable for demonstration purposes and may be used later.
+	// Owns a thread pool which recalculates independent cells of the same dependency level in parallel.
+	// With no workers (the default), recalculation runs serially on the calling thread.
+	// Once a change has finished propagating, an immutable snapshot of the sheet is published (see Snapshot.hpp) for readers on other threads.
+	// Inside a BATCH, propagation is held back until the batch commits, so that many edits share one recalculation pass.
+	// A sheet opened from a workbook (see Workbook_File.hpp) builds each saved cell only when it is first looked up, and subscribes it
+	// only once a change reaches it. Untouched cells cost nothing but the mapped file & a byte each.
+	// With a JOURNAL attached, every change is also recorded to disk once its outermost DIRTY_REGION closes.
+	// Once the journal fails to write, later edits throw rather than go unrecorded.
+	// Cells & snapshot entries are allocated from the sheet's own pools (see Pool_Allocator.hpp), a size class per type.
+	// Plain values take no CELL at all: the grid holds them in place, and the text among them once per sheet (see SLOT).
+	// The same pool of text is shared by cells showing text & by snapshot entries (see String_Pool.hpp).
 	// Uses a double layer of encapsulation to provide different levels of access to different clients.
 	// Clients of CELL class get a largely opaque data structure that only provides indirect access to cells through a proxy.
 	// CELL needs some extra privilages to manage cell data, but need to be constrianed to the threadsafe interface.
 	class CELL_DATA {
 		class INNER_CELL_DATA {
-			std::unordered_map<CELL::CELL_POSITION, std::set<CELL::CELL_POSITION>, CELL_HASH> subscriptionMap;	// <Subject, (set of) Observers>
-			std::unordered_map<CELL::CELL_POSITION, std::shared_ptr<CELL>, CELL_HASH> cellMap;					// Cell data
-			mutable std::mutex lkSubMap, lkCellMap;
+			std::unique_ptr<DEPENDENCY_GRAPH> graph;										// Subscriptions to cells & ranges of cells
+			std::unique_ptr<THREAD_POOL> pool;												// Recalculation workers
+			std::unique_ptr<FORMULA_CACHE> formulas;										// Compiled formulas shared between cells
+			std::shared_ptr<std::pmr::memory_resource> objects{ std::make_shared<std::pmr::synchronized_pool_resource>() };		// Pools for cells & snapshot entries, shared with every one of them. Cells are made on pool workers & freed on any thread.
+			mutable STRING_POOL strings;													// Text held by plain-value slots
+			mutable SLOT_GRID<SLOT, CELL::CELL_POSITION> cellGrid;							// Cell data. Read without locking. Lookups may fill it in from the image.
+			mutable std::pmr::unordered_map<CELL::CELL_POSITION, std::shared_ptr<CELL>, CELL::CELL_HASH> cells{ objects.get() };		// Owners of the CELLs in the grid. Writers only.
+			std::unique_ptr<WORKBOOK_IMAGE> image;											// Saved cells not yet needed, if opened from a workbook
+			JOURNAL* journal{ nullptr };													// Records every cell placed or erased, if attached
+			bool shown{ true };																// Tells the GUI about changes. Hidden sheets (see Journal.hpp) do not.
+			mutable std::atomic<std::size_t> recalculationCount{ 0 };
+			mutable std::shared_ptr<const SHEET_SNAPSHOT> snapshot;							// Latest version, owned by the writer
+			mutable std::atomic<const SHEET_SNAPSHOT*> publishedSnapshot{ nullptr };		// The same version, as seen by readers
+			mutable std::mutex lkSubMap, lkCellMap;											// lkCellMap serializes writers to the grid only
+			unsigned int batchDepth{ 0 };													// Open batches. Batches are opened & committed by the writer thread only.
+			mutable std::vector<CELL::CELL_POSITION> batchChanged;							// Positions edited since the outermost batch opened
+			mutable std::vector<CELL::CELL_POSITION> batchStale;							// Cells whose own recalculation was held back
+			mutable unsigned int tableHolds{ 0 };											// Open DIRTY_REGIONs
+			mutable std::vector<CELL::CELL_POSITION> dirtyRegion;							// Positions the GUI has yet to be told about
 			friend class CELL_DATA;
+			friend class WORKBOOK_FILE;
+			friend class CSV_FILE;
+			friend class JOURNAL;
+			friend class WORKBOOK_IMAGE;
 		};
 
 		INNER_CELL_DATA data;
-		std::shared_ptr<CELL> GetCell(const CELL::CELL_POSITION) const;
+
+		// Gathers the positions changed by one edit, so the GUI is told about each once, in a single call, when the outermost region closes.
+		// A batch holds every region open until it commits.
+		class DIRTY_REGION {
+			const CELL_DATA* parentContainer;
+		public:
+			explicit DIRTY_REGION(const CELL_DATA* parentContainer) : parentContainer{ parentContainer } { ++parentContainer->data.tableHolds; }
+			~DIRTY_REGION();
+			DIRTY_REGION(const DIRTY_REGION&) = delete;
+			DIRTY_REGION& operator=(const DIRTY_REGION&) = delete;
+		};
+
+		std::pair<std::shared_ptr<CELL>, bool> GetCell(const CELL::CELL_POSITION) const;		// The cell, and whether it was built to show a plain value.
+		std::shared_ptr<CELL> GetObject(const CELL::CELL_POSITION) const;				// The CELL in the grid, if the position holds one rather than a plain value.
+		SLOT FindSlot(const CELL::CELL_POSITION) const;								// Caller must hold an EPOCH::GUARD.
+		std::string RawContent(const CELL::CELL_POSITION) const;
+		std::shared_ptr<CELL> MakeValueCell(const CELL_POSITION, const SLOT) const;		// A CELL showing the plain value in the slot, outside of the grid.
+		STRING_POOL::TEXT ShareText(const std::string_view text) const { return data.strings.Share(text); }
+		STRING_POOL::TEXT Contents(const std::string_view) const;						// Contents for a new CELL
+		// A slot holding the contents as a plain value, or an empty one if they need a CELL. Takes a reference to any text.
+		// Given the value the contents are to show, the slot is only made if it would show the same.
+		SLOT MakeLiteral(const std::string& contents) const;
+		SLOT MakeLiteral(const std::string& contents, const CELL_VALUE& shown) const;
+		void ReleaseSlot(const SLOT) const;											// Caller must hold lkCellMap.
 		void NotifyAll(const CELL_POSITION) const;
-		void AssignCell(const std::shared_ptr<CELL>);
+		void Propagate(const std::vector<CELL_POSITION>& changed, const std::vector<CELL_POSITION>& stale) const;
+		bool Batching() const { return data.batchDepth != 0; }
+		void RequireJournal() const;						// Throws std::runtime_error before an edit begins if the attached journal has failed.
+		void BeginBatch();
+		void CommitBatch();
+		void UpdateTable(const CELL_POSITION) const;		// Add the position to the open DIRTY_REGION.
+		bool DeferRecalculation(const CELL_POSITION) const;		// True if the cell is to be recalculated when the batch commits instead.
+		bool AssignCell(const std::shared_ptr<CELL>);		// False if the cell only showed a plain value, which was kept in its place.
+		void AssignSlot(const CELL_POSITION, const SLOT);
 		void EraseCell(const CELL_POSITION);
 		void SubscribeToCell(const CELL_POSITION, const CELL_POSITION);
-		void UnsubscribeFromCell(const CELL_POSITION, const CELL_POSITION);
+		void SubscribeToRange(const CELL_POSITION first, const CELL_POSITION last, const CELL_POSITION observer);
+		void ReleaseSubscriptions(const CELL_POSITION);
+		bool IsCircular(const CELL_POSITION) const;
+		void RecalculateCell(CELL&, const bool circular) const;
+		void RefreshCell(CELL&) const;
+		void PublishSnapshot(const std::vector<CELL_POSITION>& changed) const;
+		std::shared_ptr<const FORMULA_PROGRAM> CompileFormula(const std::string_view, const CELL_POSITION anchor);
+		bool GatherNumbers(const CELL_POSITION first, const CELL_POSITION last, double* out, std::size_t& count) const;
+		SLOT BuildCell(const CELL_POSITION) const;									// Build the saved cell at the position, unless already built. Caller must hold an EPOCH::GUARD.
+		void BuildCells(const CELL_POSITION first, const CELL_POSITION last) const;	// As above, for every saved cell in the rectangle.
+		void PlaceSaved(const std::size_t index) const;								// Put the image's record into the grid. Caller must hold lkCellMap.
+		void Activate(const std::vector<CELL_POSITION>& changed) const;				// Subscribe every saved cell downstream of the changes.
 	public:
+		CELL_DATA();
+		explicit CELL_DATA(const std::size_t workerCount);
+		~CELL_DATA();
+		std::size_t WorkerCount() const { return data.pool->WorkerCount(); }
+		std::size_t CachedFormulaCount() const;												// Distinct compiled formulas in use.
 		CELL_PROXY GetCellProxy(const CELL::CELL_POSITION);
+		CELL_VIEW GetCellView(const CELL::CELL_POSITION) const;							// Lock-free. For reading only.
+		std::size_t RecalculationCount() const { return data.recalculationCount; }		// Total number of cell recalculations performed.
+		std::shared_ptr<const SHEET_SNAPSHOT> Snapshot() const;							// Latest fully propagated version. Holding it pins that version.
+		std::size_t CellCount() const { return data.cellGrid.Size(); }					// Cells built so far, plain values included.
+		std::size_t ObjectCount() const;													// Cells held as CELL objects: references & formulas. Plain values need none.
+		std::size_t TextCount() const { return data.strings.Size(); }					// Distinct pieces of text held by the sheet's cells & snapshots.
+		std::size_t TextBytes() const { return data.strings.Bytes(); }					// Characters in them, each distinct text counted once.
+		bool HasImage() const { return bool{ data.image }; }								// Opened from a workbook, whose cells are built as needed.
+		void Materialize(const CELL_POSITION first, const CELL_POSITION last);			// Build every saved cell in the rectangle & publish them, as for an export.
+		template <typename T, typename... ARGS> std::shared_ptr<T> Allocate(ARGS&&... args) const {		// From the sheet's pools.
+			return std::allocate_shared<T>(POOL_ALLOCATOR<T>{ data.objects }, std::forward<ARGS>(args)...);
+		}
 		friend class CELL;
-		friend struct REFERENCE_ARGUMENT;
+		friend class WORKBOOK_FILE;
+		friend class CSV_FILE;
+		friend class JOURNAL;
+		friend class WORKBOOK_IMAGE;
+	};
+
+	using EDIT = std::pair<CELL_PROXY, CELL_PROXY>;		// (Before, After) of one cell
+
+	// Stages any number of edits to a CELL_DATA as one change, for pasting, importing & the like.
+	// While a batch is open, cells are created & subscribed as usual, but nothing is recalculated, published or shown.
+	// Committing (explicitly or on destruction) recalculates every affected cell exactly once, in dependency order,
+	// publishes a single snapshot and tells the GUI about each changed cell once.
+	// Batches nest: only the outermost commit propagates. Edits made through the batch are handed back as one undo step.
+	class BATCH {
+		CELL_DATA* parentContainer;
+		std::vector<EDIT> edits;
+		bool open{ true };
+	public:
+		explicit BATCH(CELL_DATA*);
+		~BATCH();
+		BATCH(const BATCH&) = delete;
+		BATCH& operator=(const BATCH&) = delete;
+
+		CELL_PROXY NewCell(const CELL_POSITION, const std::string&);				// As CELL::NewCell, recording the edit.
+		void RecreateCell(const CELL_PROXY&, const CELL_POSITION);					// As CELL::RecreateCell. Not recorded, since it is how edits are undone.
+		std::vector<EDIT> Commit();													// Propagate the batch & return its edits.
 	};
 
 	// "Factory" function to create new cells
 	// This was previously written as a class, but has devolved over time as it is only a single function in practice
 	// A function parallels the "Singleton" pattern, but implies that users cannot extend it through inheritance
+	// Both throw std::runtime_error, changing nothing, if the sheet's journal can no longer record changes (see Journal.hpp).
 	static CELL_PROXY NewCell(CELL_DATA*, const CELL_POSITION, const std::string&);
 	static void RecreateCell(CELL_DATA*, const CELL_PROXY&, const CELL_POSITION);
 
 protected:
 	CELL() { }		// Hide constructor to force usage of factory function
+	static std::shared_ptr<CELL> MakeCell(const std::string& contents, const CELL_DATA&);		// Empty cell of the type the contents call for, from the sheet's pools.
 private:
 	CELL(const CELL_PROXY cell) { *this = *cell; parentContainer->NotifyAll(position); }		// Create cell from cell proxy and notify of change
 public:
 	virtual ~CELL() { }
 
 private:
-	std::string rawContent;
+	STRING_POOL::TEXT rawContent;				// Shared with the snapshot entries showing the cell, and with any cell holding the same text (see CELL_DATA::Contents).
 protected:
 	bool error{ false };
-	std::string displayValue;
 	CELL_POSITION position;
 	CELL_DATA* parentContainer{ nullptr };
-
-	void SubscribeToCell(const CELL_POSITION) const;
-	void UnsubscribeFromCell(const CELL_POSITION) const;
+	std::size_t recalculationCount{ 0 };
+	bool circular{ false };						// Cell sits inside a reference loop. Takes precedence over any stored value.
+	std::vector<CELL_POSITION> subscriptions;	// Subjects this cell observes. Restored if the cell is placed back into the grid.
+	std::vector<std::pair<CELL_POSITION, CELL_POSITION>> rangeSubscriptions;	// Corners of each range this cell observes. Restored as above.
+
+	virtual void Recalculate() { }		// Re-evaluate from dependencies, which are already up to date. Must not notify.
+	virtual CELL_VALUE StoredValue() const { return error ? CELL_VALUE{ CELL_ERROR::GENERIC } : CELL_VALUE{ GetRawContent() }; }
+	virtual void Subscribe() { }		// Subscribe to every cell this one reads. Also used to load a sheet saved without its dependency graph.
+	virtual void RestoreValue(const CELL_VALUE&);		// Take a saved value in place of evaluating (see Workbook_File.hpp).
+	// The part of initializing that reads nothing outside this cell, so many new cells may be prepared at once on other threads
+	// before joining the grid (see Csv_File.hpp). True if that was all; otherwise InitializeCell must still run once the cell is in the grid.
+	virtual bool Prepare() { return false; }
+	void Evaluate();				// Recalculate now, or once the open batch commits.
+	void SubscribeToCell(const CELL_POSITION);
+	void SubscribeToRange(const CELL_POSITION first, const CELL_POSITION last);		// One subscription covering every cell in the rectangle.
+	SLOT LookupSlot(const CELL_POSITION) const;		// Read another position in the same container without a proxy. Caller must hold an EPOCH::GUARD.
+	STRING_POOL::TEXT ShareText(const std::string_view) const;		// The text, from the same container's pool.
+	std::shared_ptr<const FORMULA_PROGRAM> CompileFormula(const std::string_view) const;	// Program for formula text anchored at this cell, shared through the sheet's cache.
+	// Copy the numbers in a rectangle of cells into out, column by column, skipping empty & text cells. False if any cell holds an error.
+	bool GatherNumbers(const CELL_POSITION first, const CELL_POSITION last, double* out, std::size_t& count) const;
 public:
-	virtual std::string GetOutput() const { return error ? "!ERROR!" : displayValue; }
-	virtual std::string GetRawContent() const { return rawContent; }
-	virtual void InitializeCell() { displayValue = rawContent; }
+	CELL_VALUE GetValue() const { return circular ? CELL_VALUE{ CELL_ERROR::CIRCULAR } : StoredValue(); }
+	virtual std::string GetOutput() const { return DisplayString(GetValue()); }		// Display text is built from the typed value on request.
+	virtual std::string GetRawContent() const { return rawContent ? *rawContent : std::string{ }; }
+	virtual void InitializeCell() { }
 	virtual void UpdateCell();						// Tell a CELL to update its state.
 	CELL_POSITION GetPosition() const { return position; }
+	std::size_t GetRecalculationCount() const { return recalculationCount; }
+
+	static std::string DisplayString(const CELL_VALUE&);
+	static std::string NumberContent(const double);		// The shortest contents that enter exactly this number, as a plain number's are written back.
+	friend class WORKBOOK_FILE;
+	friend class WORKBOOK_IMAGE;
+	friend class CSV_FILE;
 };
 
 inline bool operator< (const CELL::CELL_POSITION& lhs, const CELL::CELL_POSITION& rhs) {
@@ -168,27 +377,28 @@ inline bool operator== (const CELL::CELL_POSITION& lhs, const CELL::CELL_POSITIO
 inline bool operator!= (const CELL::CELL_POSITION& lhs, const CELL::CELL_POSITION& rhs) { return !(lhs == rhs); }
 
 // A cell that is simply raw text merely outputs its text.
+// The text shown is taken from the contents whenever it is asked for, rather than kept as a second copy.
 class TEXT_CELL : public CELL {
 public:
 	virtual ~TEXT_CELL() {}
-	std::string GetOutput() const override { return displayValue; }		// Presumably this will never be in an error state.
-	void InitializeCell() override;
+protected:
+	CELL_VALUE StoredValue() const override;
+	bool Prepare() override { return true; }		// Presumably this will never be in an error state.
 };
 
 // A cell that refers to another cell by referring to it's position.
 class REFERENCE_CELL : public CELL {
 public:
-	virtual ~REFERENCE_CELL() { UnsubscribeFromCell(referencePosition); }
-	std::string GetOutput() const override {
-		auto out = std::string{ };
-		auto cell = parentContainer->GetCellProxy(referencePosition);
-		if (!cell || cell->GetPosition() == position) { out = "!REF!"; }	// Dangling reference & reference to self both cause a reference error.
-		else { out = cell->GetOutput(); }
-		return error ? "!ERROR!" : out;
-	}
 	void InitializeCell() override;
 protected:
+	CELL_VALUE StoredValue() const override;
 	CELL_POSITION referencePosition;
+	CELL_VALUE referencedValue;			// Value of the referenced cell as of the last recalculation, unless text.
+	STRING_POOL::TEXT referencedText;	// Text it showed, shared through the sheet's pool rather than copied into every reference.
+	void KeepValue(CELL_VALUE);
+	void Recalculate() override;
+	void Subscribe() override;
+	void RestoreValue(const CELL_VALUE&) override;
 };
 
 // Parese string into Row & Column positions of reference cell
@@ -202,80 +412,25 @@ protected:
 	//DISPLAY_PARAMETERS parameters;		// Add criteria for textual representation of value. (Ex. 1 vs. 1.0000 vs. $1.00, etc.)
 public:
 	virtual ~NUMERICAL_CELL() {}
-	std::string GetOutput() const override { return error ? "!ERROR!" : std::to_string(storedValue); }
 	void InitializeCell() override;
+protected:
+	CELL_VALUE StoredValue() const override { return error ? CELL_VALUE{ CELL_ERROR::GENERIC } : CELL_VALUE{ storedValue }; }
+	void RestoreValue(const CELL_VALUE&) override;
+	bool Prepare() override { return Parse(); }		// A failed number is re-entered as text by InitializeCell.
+	bool Parse();
 };
 
-struct ARGUMENT;
 // A cell that contains one or more FUNCTION(s).
+// The formula is compiled once into a FORMULA_PROGRAM (see Formula.hpp) and re-run on each recalculation.
 class FUNCTION_CELL : public NUMERICAL_CELL {
 public:
 	void InitializeCell() override;
-	void UpdateCell() override;		// Need to add recalculate logic here for when reference cells update
 protected:
-	std::shared_ptr<ARGUMENT> m_Func;
-	std::shared_ptr<ARGUMENT> ParseFunctionString(std::string&);
+	void Recalculate() override;		// Recalculate when an underlying reference argument is changed.
+	void Subscribe() override;
+	bool Prepare() override { Compile(); return false; }		// Subscribing needs the grid.
+	bool Compile();
+	std::shared_ptr<const FORMULA_PROGRAM> program;		// Shared with other cells of the same shape. Empty until compiled (a loaded cell compiles on first recalculation), or if the formula could not be compiled.
 };
 
-// ARGUMENT serves as the argument for FUNCTIONs, which are in turn ARGUMENTs themselves.
-// It contains a future to get its value from an async call, stores the value, and tracks changes in underlying arguments.
-struct ARGUMENT {
-	virtual bool UpdateArgument() { return true; }				// Logic to update argument when dependent cells update. May be trivial.
-	double Get() { return stillValid ? storedArgument : val.get(); }	// Lazy evaluation
-protected:
-	std::future<double> val;
-	double storedArgument{ };
-	bool stillValid{ false };
-	void SetValue(double);
-	void SetValue(std::exception);
-};
-
-// FUNCTION will utilize the "Strategy" pattern to support numerous function types by specializing the base FUNCTION type for each function used.
-// FUNCTION_CELL will utilize the "Composite" pattern to treat singular and aggregate FUNCTIONS uniformly.
-// Each FUNCTION both takes ARGUMENTs and is itself an ARGUMENT, allowing for recursive composition.
-// Alternatively, FUNCTION could simply store a function pointer that stores the appropriate function at runtime based upon function name lookup.
-// Each function must have the same call signature to fit in the same pointer object (taking a vector of ARGUMENTS and storing a double).
-// The sub-classing option is used here to comport with the broader goal of demonstrating established Object-oriented design patterns.
-// This alternate strategy is shown in comments for completeness.
-// Functions use lazy evaluation and support parallel evaluation and avoid duplicate work.
-struct FUNCTION : public ARGUMENT {
-	FUNCTION() = default;
-	FUNCTION(std::vector<std::shared_ptr<ARGUMENT>>&&);
-	std::vector<std::shared_ptr<ARGUMENT>> Arguments;
-	bool error{ false };
-	//double (*funPTR) (vector<ARGUMENT>);			// Alternate to subclassing, just assign a function to this pointer at runtime.
-	bool UpdateArgument() override;
-};
-
-struct VALUE_ARGUMENT : public ARGUMENT {
-	explicit VALUE_ARGUMENT(double);
-	bool UpdateArgument() override;
-};
-
-struct REFERENCE_ARGUMENT : public ARGUMENT {
-	REFERENCE_ARGUMENT(CELL::CELL_DATA*, FUNCTION_CELL&, CELL::CELL_POSITION);
-	~REFERENCE_ARGUMENT();
-	CELL::CELL_DATA* parentContainer;
-	CELL::CELL_POSITION referencePosition, parentPosition;
-	bool UpdateArgument() override;
-};
-
-/*////////////////////////////////////////////////////////////
-// List of available operations overriding Function
-*/////////////////////////////////////////////////////////////
-
-// I'm not sure how best to implement this mapping of text to function objects.
-// Each one must get a newly created object, lest they share the same arguments.
-std::shared_ptr<FUNCTION> MatchNameToFunction(const std::string& inputText, std::vector<std::shared_ptr<ARGUMENT>>&& args);
-
-struct SUM : public FUNCTION { SUM(std::vector<std::shared_ptr<ARGUMENT>>&& args); bool UpdateArgument() final; };
-struct AVERAGE : public FUNCTION { AVERAGE(std::vector<std::shared_ptr<ARGUMENT>>&& args); bool UpdateArgument() final; };
-struct PRODUCT : public FUNCTION { PRODUCT(std::vector<std::shared_ptr<ARGUMENT>>&& args); bool UpdateArgument() final; };
-struct INVERSE : public FUNCTION { INVERSE(std::vector<std::shared_ptr<ARGUMENT>>&& args); bool UpdateArgument() final; };
-struct RECIPROCAL : public FUNCTION { RECIPROCAL(std::vector<std::shared_ptr<ARGUMENT>>&& args); bool UpdateArgument() final; };
-struct PI : public FUNCTION { PI(); bool UpdateArgument() final; };
-
-// Part of an alternative function mapping scheme
-// std::unordered_map<wstring, shared_ptr<FUNCTION_CELL::FUNCTION>> functionNameMap{ {wstring(L"SUM"), shared_ptr<FUNCTION_CELL::SUM>()}, {wstring(L"AVERAGE"), shared_ptr<FUNCTION_CELL::AVERAGE>()} };
-
 #endif // !CELL_CLASS_HPP
\ No newline at end of file
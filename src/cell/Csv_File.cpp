@@ -0,0 +1,193 @@
+#include "Csv_File.hpp"
+#include "Snapshot.hpp"
+#include "Thread_Pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Whole records cut from the input, and the cells prepared from them.
+struct CSV_FILE::CHUNK {
+	struct FIELD {
+		CELL::CELL_POSITION position;
+		CELL::SLOT literal;					// A plain value, which needs no cell
+		shared_ptr<CELL> cell{ };
+		bool ready{ true };					// A cell that is not ready still needs InitializeCell once in the grid.
+	};
+	string text;
+	uint64_t firstRow{ 0 };
+	vector<FIELD> cells;
+};
+
+namespace {
+	// Quote a field if it holds anything that would otherwise end it early.
+	void AppendField(string& line, const string& field) {
+		if (field.find_first_of(",\"\r\n") == string::npos) { line += field; return; }
+		line += '"';
+		for (auto c : field) {
+			if (c == '"') { line += '"'; }
+			line += c;
+		}
+		line += '"';
+	}
+}
+
+// Cut the input into chunks of whole records as it is read, then prepare & insert them a wave at a time.
+// Only quotes, commas & line breaks are looked at to find where records end, so cutting runs well ahead of parsing.
+// Quotes are read as Prepare reads them: only one opening a field quotes it, so a stray quote inside a field (12" tv) is text.
+size_t CSV_FILE::Import(CELL::CELL_DATA& sheet, istream& in, const CELL::CELL_POSITION origin, const size_t chunkSize) {
+	auto batch = CELL::BATCH{ &sheet };			// Recalculation, publishing & the GUI all wait for the whole import
+	auto waveSize = 2 * (sheet.WorkerCount() + 1);
+	auto wave = vector<CHUNK>{ };
+	auto imported = size_t{ 0 };
+	auto nextRow = uint64_t{ origin.row };
+
+	auto pending = string{ };
+	auto scanned = size_t{ 0 };				// Bytes of pending already looked at
+	auto boundary = size_t{ 0 };			// End of the last whole record in pending
+	auto records = uint64_t{ 0 };			// Whole records in pending
+	enum class SCAN { FIELD_START, UNQUOTED, QUOTED, CLOSED };		// CLOSED: just past a closing quote, or the first of a doubled one
+	auto state = SCAN::FIELD_START;
+	for (auto done = false; !done;) {
+		auto read = pending.size();
+		pending.resize(read + chunkSize);
+		in.read(pending.data() + read, chunkSize);
+		pending.resize(read + static_cast<size_t>(in.gcount()));
+		done = !in;
+		for (; scanned < pending.size(); ++scanned) {
+			auto c = pending[scanned];
+			if (state == SCAN::QUOTED) { if (c == '"') { state = SCAN::CLOSED; } }
+			else if (c == '\n') { state = SCAN::FIELD_START; boundary = scanned + 1; ++records; }
+			else if (c == ',') { state = SCAN::FIELD_START; }
+			else if (c == '"' && state != SCAN::UNQUOTED) { state = SCAN::QUOTED; }
+			else { state = SCAN::UNQUOTED; }
+		}
+		if (boundary == 0 && !done) { continue; }		// A record longer than a chunk. Keep reading.
+
+		auto& chunk = wave.emplace_back();
+		chunk.text = std::move(pending);
+		if (done) { records += boundary != chunk.text.size(); }		// The last record need not end in a line break
+		else {
+			pending.assign(chunk.text, boundary);
+			chunk.text.resize(boundary);
+		}
+		scanned = pending.size();
+		chunk.firstRow = nextRow;
+		nextRow += records;
+		boundary = 0;
+		records = 0;
+
+		if (wave.size() == waveSize || done) {
+			sheet.data.pool->ParallelFor(wave.size(), [&wave, &sheet, origin](const size_t i) { Prepare(wave[i], origin.column, &sheet); });
+			for (auto& prepared : wave) { imported += Insert(prepared, sheet); }
+			wave.clear();
+		}
+	}
+	batch.Commit();
+	return imported;
+}
+
+// Split a chunk into fields & prepare a cell for each. Runs on the pool, so nothing outside the chunk is touched
+// except through the thread-safe formula cache.
+void CSV_FILE::Prepare(CHUNK& chunk, const unsigned int firstColumn, CELL::CELL_DATA* sheet) {
+	auto& text = chunk.text;
+	auto row = chunk.firstRow;
+	auto column = uint64_t{ firstColumn };
+	auto field = string{ };
+	auto i = size_t{ 0 };
+	while (i < text.size()) {
+		field.clear();
+		if (text[i] == '"') {
+			for (++i; i < text.size();) {
+				auto close = text.find('"', i);
+				if (close == string::npos) { field.append(text, i); i = text.size(); break; }
+				field.append(text, i, close - i);
+				i = close + 1;
+				if (i < text.size() && text[i] == '"') { field += '"'; ++i; }		// Doubled quote
+				else { break; }
+			}
+		}
+		auto end = i;
+		while (end < text.size() && text[end] != ',' && text[end] != '\n') { ++end; }
+		auto trim = end > i && text[end - 1] == '\r' && (end == text.size() || text[end] == '\n');
+		field.append(text, i, end - i - trim);
+
+		if (!field.empty() && row <= MaxRow_ && column <= MaxColumn_) {
+			auto pos = CELL::CELL_POSITION{ static_cast<unsigned int>(column), static_cast<unsigned int>(row) };
+			if (auto literal = sheet->MakeLiteral(field)) { chunk.cells.push_back({ pos, literal }); }
+			else {
+				auto cell = CELL::MakeCell(field, *sheet);
+				cell->position = pos;
+				cell->rawContent = sheet->Contents(field);
+				cell->parentContainer = sheet;
+				auto ready = true;
+				try { ready = cell->Prepare(); }
+				catch (...) { cell->error = true; }		// As NewCell
+				chunk.cells.push_back({ pos, CELL::SLOT{ }, std::move(cell), ready });
+			}
+		}
+
+		i = end;
+		if (i < text.size()) {
+			if (text[i] == '\n') { ++row; column = firstColumn; }
+			else { ++column; }
+			++i;
+		}
+	}
+	text = string{ };
+}
+
+// Place a chunk's cells into the grid in order, on the writer thread, finishing any that need the grid to initialize.
+size_t CSV_FILE::Insert(CHUNK& chunk, CELL::CELL_DATA& sheet) {
+	for (auto& [pos, literal, cell, ready] : chunk.cells) {
+		if (literal) { sheet.AssignSlot(pos, literal); }
+		else {
+			sheet.AssignCell(cell);
+			if (!ready) {
+				try { cell->InitializeCell(); }
+				catch (...) { cell->error = true; }
+			}
+		}
+		sheet.NotifyAll(pos);
+		sheet.UpdateTable(pos);
+	}
+	auto count = chunk.cells.size();
+	chunk.cells = { };
+	return count;
+}
+
+// Entries are visited column by column. A counting sort on the row puts them in row order, keeping each row in column order.
+void CSV_FILE::Export(const SHEET_SNAPSHOT& snapshot, ostream& out) {
+	auto rowStart = vector<size_t>(MaxRow_ + 2, 0);
+	auto lastRow = 0u;
+	snapshot.ForEach([&rowStart, &lastRow](const SHEET_SNAPSHOT::ENTRY& entry) {
+		++rowStart[entry.position.row + 1];
+		lastRow = max(lastRow, entry.position.row);
+	});
+	partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+	auto entries = vector<const SHEET_SNAPSHOT::ENTRY*>(snapshot.Size());
+	auto next = rowStart;
+	snapshot.ForEach([&entries, &next](const SHEET_SNAPSHOT::ENTRY& entry) { entries[next[entry.position.row]++] = &entry; });
+
+	auto line = string{ };
+	for (auto row = 1u; row <= lastRow; ++row) {
+		line.clear();
+		auto column = 1u;
+		for (auto i = rowStart[row]; i < rowStart[row + 1]; ++i) {
+			line.append(entries[i]->position.column - column, ',');
+			column = entries[i]->position.column;
+			AppendField(line, entries[i]->GetOutput());
+		}
+		line += '\n';
+		out.write(line.data(), line.size());
+	}
+	if (!out) { throw runtime_error("Could not write CSV output."); }
+}
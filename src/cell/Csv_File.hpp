@@ -0,0 +1,40 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining CSV import & export for a sheet.
+// Fields are separated by commas and records by line breaks (\n or \r\n). A field in double quotes may hold commas,
+// line breaks & doubled quotes (""). An unterminated quote runs to the end of the input rather than failing the import.
+//
+// Import streams the input in chunks, each cut at a record boundary outside any quotes. Chunks are read a few at a time
+// (one or two per worker of the sheet's thread pool), split into fields and turned into cells on the pool: plain values
+// are made into grid slots there, other text & numbers are initialized there and formulas are compiled through the sheet's formula cache. The writer thread then places each
+// chunk's cells into the grid in order and subscribes references & formulas, all inside one BATCH, so the sheet is
+// recalculated, published & shown once, at the end. Fields are entered exactly as if typed into the cell.
+// Export writes each cell's computed output from a snapshot, row by row. Only a pointer per cell is gathered,
+// so display text is built & written one row at a time.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSV_FILE_CLASS_HPP
+#define CSV_FILE_CLASS_HPP
+
+#include "Cell.hpp"
+#include <cstddef>
+#include <iosfwd>
+
+class CSV_FILE {
+public:
+	static constexpr std::size_t DefaultChunkSize{ 1 << 20 };
+
+	// Enter every non-empty field, with the first field of the first record at origin. Empty fields leave the sheet as it is,
+	// and fields beyond the extent of the grid are dropped. Returns the number of cells entered. Cannot be undone.
+	static std::size_t Import(CELL::CELL_DATA&, std::istream&, const CELL::CELL_POSITION origin = CELL::CELL_POSITION{ 1, 1 }, const std::size_t chunkSize = DefaultChunkSize);
+
+	// Write rows 1 through the last one in use, each from column 1 out to its last cell in use, so importing the output
+	// at R1C1 puts every value back in place. Fields are quoted where needed. Throws std::runtime_error if the stream fails.
+	// A snapshot never changes, so this may run on any thread while the sheet carries on.
+	static void Export(const SHEET_SNAPSHOT&, std::ostream&);
+private:
+	struct CHUNK;
+	static void Prepare(CHUNK&, const unsigned int firstColumn, CELL::CELL_DATA*);
+	static std::size_t Insert(CHUNK&, CELL::CELL_DATA&);
+};
+
+#endif // !CSV_FILE_CLASS_HPP
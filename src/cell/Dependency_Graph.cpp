@@ -0,0 +1,305 @@
+#include "Dependency_Graph.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace std;
+
+// Topological index of a cell, assigning the next free index to cells not yet in the graph.
+long long DEPENDENCY_GRAPH::Order(const CELL::CELL_POSITION pos) {
+	auto [it, inserted] = order.emplace(pos, nextOrder);
+	if (inserted) { ++nextOrder; }
+	return it->second;
+}
+
+// Drop the topological index of a cell that no longer takes part in any edge.
+void DEPENDENCY_GRAPH::Forget(const CELL::CELL_POSITION pos) {
+	if (observers.count(pos) || subjects.count(pos) || circular.count(pos)) { return; }
+	order.erase(pos);
+}
+
+// Cells reachable from start through ordered edges, restricted to indices at or below the upper bound.
+vector<CELL::CELL_POSITION> DEPENDENCY_GRAPH::Forward(const CELL::CELL_POSITION start, const long long upperBound) const {
+	auto visited = vector<CELL::CELL_POSITION>{ start };
+	auto seen = unordered_set<CELL::CELL_POSITION, CELL::CELL_HASH>{ start };
+	for (auto i = size_t{ 0 }; i < visited.size(); ++i) {
+		auto it = observers.find(visited[i]);
+		if (it == observers.end()) { continue; }
+		for (auto next : it->second) { if (order.at(next) <= upperBound && seen.insert(next).second) { visited.push_back(next); } }
+	}
+	return visited;
+}
+
+// Cells that reach start through ordered edges, restricted to indices at or above the lower bound.
+vector<CELL::CELL_POSITION> DEPENDENCY_GRAPH::Backward(const CELL::CELL_POSITION start, const long long lowerBound) const {
+	auto visited = vector<CELL::CELL_POSITION>{ start };
+	auto seen = unordered_set<CELL::CELL_POSITION, CELL::CELL_HASH>{ start };
+	for (auto i = size_t{ 0 }; i < visited.size(); ++i) {
+		auto it = subjects.find(visited[i]);
+		if (it == subjects.end()) { continue; }
+		for (auto next : it->second) { if (order.at(next) >= lowerBound && seen.insert(next).second) { visited.push_back(next); } }
+	}
+	return visited;
+}
+
+// Cells on some path from the observer back around to the subject of a loop-closing edge.
+// Because the order is topological, every such cell is ordered between the two ends, which bounds both searches.
+vector<CELL::CELL_POSITION> DEPENDENCY_GRAPH::LoopMembers(const EDGE& edge) const {
+	auto& [subject, observer] = edge;
+	if (subject == observer) { return { subject }; }
+	auto forward = Forward(observer, order.at(subject));
+	auto backward = Backward(subject, order.at(observer));
+	auto reachesSubject = unordered_set<CELL::CELL_POSITION, CELL::CELL_HASH>(backward.begin(), backward.end());
+	auto members = vector<CELL::CELL_POSITION>{ };
+	for (auto& pos : forward) { if (reachesSubject.count(pos)) { members.push_back(pos); } }
+	return members;
+}
+
+void DEPENDENCY_GRAPH::MarkLoop(const EDGE& edge, vector<CELL::CELL_POSITION>&& members) {
+	for (auto& pos : members) { circular[pos].push_back(edge); }
+	loopEdges[edge] = std::move(members);
+}
+
+void DEPENDENCY_GRAPH::UnmarkLoop(LOOPS::iterator loop) {
+	for (auto& pos : loop->second) {
+		auto it = circular.find(pos);
+		auto& loops = it->second;
+		*find(loops.begin(), loops.end(), loop->first) = loops.back();
+		loops.pop_back();
+		if (loops.empty()) { circular.erase(it); }
+	}
+	loopEdges.erase(loop);
+}
+
+// Closing edges of the loops passing through either cell, each listed once.
+vector<DEPENDENCY_GRAPH::EDGE> DEPENDENCY_GRAPH::LoopsThrough(const CELL::CELL_POSITION first, const CELL::CELL_POSITION second) const {
+	auto loops = vector<EDGE>{ };
+	for (auto pos : { first, second }) {
+		auto it = circular.find(pos);
+		if (it == circular.end()) { continue; }
+		for (auto& edge : it->second) { if (find(loops.begin(), loops.end(), edge) == loops.end()) { loops.push_back(edge); } }
+	}
+	return loops;
+}
+
+// Insert an edge known to be absent from the graph.
+void DEPENDENCY_GRAPH::Insert(const EDGE& edge) {
+	auto& [subject, observer] = edge;
+	if (subject == observer) { MarkLoop(edge, { subject }); return; }		// Reference to self
+
+	auto lowerBound = Order(observer);
+	auto upperBound = Order(subject);
+	if (upperBound > lowerBound) {
+		// Edge runs backwards through the current order. Search only the cells ordered between its ends.
+		auto forward = Forward(observer, upperBound);
+		if (find(forward.begin(), forward.end(), subject) != forward.end()) { MarkLoop(edge, LoopMembers(edge)); return; }
+		auto backward = Backward(subject, lowerBound);
+
+		// Reuse the same pool of indices, placing everything that leads to the subject ahead of everything after the observer.
+		auto byOrder = [this](const CELL::CELL_POSITION lhs, const CELL::CELL_POSITION rhs) { return order.at(lhs) < order.at(rhs); };
+		sort(forward.begin(), forward.end(), byOrder);
+		sort(backward.begin(), backward.end(), byOrder);
+		auto indices = vector<long long>{ };
+		indices.reserve(forward.size() + backward.size());
+		for (auto& pos : backward) { indices.push_back(order.at(pos)); }
+		for (auto& pos : forward) { indices.push_back(order.at(pos)); }
+		sort(indices.begin(), indices.end());
+		auto next = indices.begin();
+		for (auto& pos : backward) { order[pos] = *next++; }
+		for (auto& pos : forward) { order[pos] = *next++; }
+	}
+	observers[subject].insert(observer);
+	subjects[observer].insert(subject);
+
+	// A new path may lengthen an existing loop when it runs between two cells of that loop. Only loops through either end are looked at.
+	for (auto& loopEdge : LoopsThrough(subject, observer)) {
+		auto& [loopSubject, loopObserver] = loopEdge;
+		if (loopSubject == loopObserver) { continue; }
+		if (order.at(loopObserver) > order.at(subject) || order.at(observer) > order.at(loopSubject)) { continue; }
+		auto grown = LoopMembers(loopEdge);
+		UnmarkLoop(loopEdges.find(loopEdge));
+		MarkLoop(loopEdge, std::move(grown));
+	}
+}
+
+bool DEPENDENCY_GRAPH::Contains(const EDGE& edge) const {
+	auto it = observers.find(edge.first);
+	return (it != observers.end() && it->second.contains(edge.second)) || loopEdges.count(edge);
+}
+
+void DEPENDENCY_GRAPH::AddEdge(const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer) {
+	Observe(observer);
+	auto edge = EDGE{ subject, observer };
+	auto it = derived.find(edge);
+	if (it != derived.end()) { it->second.second = true; return; }
+	if (Contains(edge)) { return; }
+	Insert(edge);
+}
+
+// An edge that is also derived from a range stays in place until the range goes.
+void DEPENDENCY_GRAPH::RemoveEdge(const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer) {
+	auto edge = EDGE{ subject, observer };
+	auto it = derived.find(edge);
+	if (it != derived.end()) { it->second.second = false; return; }
+	Unlink(edge);
+}
+
+// Remove observer link (Subject, Observer) from the graph, whatever put it there.
+// Loops that ran through the removed edge may have been broken, so their closing edges are inserted afresh.
+void DEPENDENCY_GRAPH::Unlink(const EDGE& edge) {
+	auto& [subject, observer] = edge;
+	auto loop = loopEdges.find(edge);
+	if (loop != loopEdges.end()) {
+		UnmarkLoop(loop);
+		Forget(subject);
+		Forget(observer);
+		return;
+	}
+
+	auto itSubject = observers.find(subject);
+	if (itSubject == observers.end() || !itSubject->second.erase(observer)) { return; }
+	if (itSubject->second.empty()) { observers.erase(itSubject); }
+	auto itObserver = subjects.find(observer);
+	itObserver->second.erase(subject);
+	if (itObserver->second.empty()) { subjects.erase(itObserver); }
+
+	// Only a loop through both ends can have run through the edge.
+	auto affected = vector<EDGE>{ };
+	auto itSubjectLoops = circular.find(subject);
+	auto itObserverLoops = circular.find(observer);
+	if (itSubjectLoops != circular.end() && itObserverLoops != circular.end()) {
+		auto& observerLoops = itObserverLoops->second;
+		for (auto& loopEdge : itSubjectLoops->second) {
+			if (find(observerLoops.begin(), observerLoops.end(), loopEdge) != observerLoops.end()) { affected.push_back(loopEdge); }
+		}
+	}
+	for (auto& loopEdge : affected) { UnmarkLoop(loopEdges.find(loopEdge)); }
+	for (auto& loopEdge : affected) { Insert(loopEdge); }
+	Forget(subject);
+	Forget(observer);
+}
+
+// A cell that starts observing may now be recalculated, so it is ordered ahead of every range covering it.
+void DEPENDENCY_GRAPH::Observe(const CELL::CELL_POSITION pos) {
+	if (!observing.insert(pos).second) { return; }
+	auto covering = vector<CELL::CELL_POSITION>{ };
+	rangeIndex.Query(pos, [&covering](const RANGE_INDEX::ENTRY& entry) { covering.push_back(entry.observer); });
+	for (auto& observer : covering) { AddDerived(EDGE{ pos, observer }); }
+}
+
+void DEPENDENCY_GRAPH::AddDerived(const EDGE& edge) {
+	auto [it, inserted] = derived.try_emplace(edge, 1u, Contains(edge));
+	if (!inserted) { ++it->second.first; return; }
+	if (!it->second.second) { Insert(edge); }
+}
+
+void DEPENDENCY_GRAPH::DropDerived(const EDGE& edge) {
+	auto it = derived.find(edge);
+	if (it == derived.end() || --it->second.first != 0) { return; }
+	auto direct = it->second.second;
+	derived.erase(it);
+	if (!direct) { Unlink(edge); }
+}
+
+// Only cells that already observe something inside the rectangle gain an ordered edge; plain values are left to the index.
+void DEPENDENCY_GRAPH::AddRangeEdge(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer) {
+	Observe(observer);
+	if (!rangeIndex.Insert(first, last, observer)) { return; }
+	ranges[observer].emplace_back(first, last);
+
+	auto inside = vector<CELL::CELL_POSITION>{ };
+	auto it = observing.lower_bound(first);
+	while (it != observing.end() && it->column <= last.column) {
+		if (it->row < first.row) { it = observing.lower_bound(CELL::CELL_POSITION{ it->column, first.row }); continue; }
+		if (it->row > last.row) { it = observing.lower_bound(CELL::CELL_POSITION{ it->column + 1, first.row }); continue; }
+		inside.push_back(*it++);
+	}
+	for (auto& subject : inside) { AddDerived(EDGE{ subject, observer }); }
+}
+
+void DEPENDENCY_GRAPH::RemoveObserver(const CELL::CELL_POSITION observer) {
+	auto edges = vector<EDGE>{ };
+	auto it = subjects.find(observer);
+	if (it != subjects.end()) { for (auto subject : it->second) { edges.emplace_back(subject, observer); } }
+	auto itLoops = circular.find(observer);				// A loop-closing edge's observer is always on its loop
+	if (itLoops != circular.end()) { for (auto& loopEdge : itLoops->second) { if (loopEdge.second == observer) { edges.push_back(loopEdge); } } }
+	for (auto& edge : edges) { derived.erase(edge); Unlink(edge); }
+
+	auto itRanges = ranges.find(observer);
+	if (itRanges != ranges.end()) {
+		for (auto& [first, last] : itRanges->second) { rangeIndex.Erase(first, last, observer); }
+		ranges.erase(itRanges);
+	}
+
+	// No longer observing anything, so the cell drops out of the order of the ranges covering it.
+	if (!observing.erase(observer)) { return; }
+	auto covering = vector<CELL::CELL_POSITION>{ };
+	rangeIndex.Query(observer, [&covering](const RANGE_INDEX::ENTRY& entry) { covering.push_back(entry.observer); });
+	for (auto& rangeObserver : covering) { DropDerived(EDGE{ observer, rangeObserver }); }
+}
+
+size_t DEPENDENCY_GRAPH::EdgeCount() const {
+	auto count = loopEdges.size();
+	for (auto& [subject, targets] : observers) { count += targets.size(); }
+	return count;
+}
+
+vector<CELL::CELL_POSITION> DEPENDENCY_GRAPH::RecalculationOrder(const CELL::CELL_POSITION subject) const { return RecalculationOrder(vector<CELL::CELL_POSITION>{ subject }, { }); }
+
+// Collect the dirty region through every edge (including loop-closing edges and ranges), then sort it by topological index.
+// Loop-closing edges are not part of the order, so cells in a loop come out in an arbitrary but harmless order.
+vector<CELL::CELL_POSITION> DEPENDENCY_GRAPH::RecalculationOrder(const vector<CELL::CELL_POSITION>& changed, const vector<CELL::CELL_POSITION>& seeds) const {
+	auto dirty = vector<CELL::CELL_POSITION>{ };
+	auto seen = unordered_set<CELL::CELL_POSITION, CELL::CELL_HASH>{ };
+	auto visit = [&dirty, &seen](const CELL::CELL_POSITION pos) { if (seen.insert(pos).second) { dirty.push_back(pos); } };
+	for (auto pos : seeds) { visit(pos); }
+	auto pending = changed;
+	pending.insert(pending.end(), dirty.begin(), dirty.end());		// Cells downstream of a seed are dirty too
+	while (!pending.empty()) {
+		auto pos = pending.back();
+		pending.pop_back();
+		auto before = dirty.size();
+		auto it = observers.find(pos);
+		if (it != observers.end()) { for (auto observer : it->second) { visit(observer); } }
+		for (auto loop = loopEdges.lower_bound(EDGE{ pos, CELL::CELL_POSITION{ } }); loop != loopEdges.end() && loop->first.first == pos; ++loop) { visit(loop->first.second); }
+		rangeIndex.Query(pos, [&visit](const RANGE_INDEX::ENTRY& entry) { visit(entry.observer); });
+		pending.insert(pending.end(), dirty.begin() + before, dirty.end());
+	}
+
+	auto orderOf = [this](const CELL::CELL_POSITION pos) { auto it = order.find(pos); return it == order.end() ? -1 : it->second; };
+	sort(dirty.begin(), dirty.end(), [&orderOf](const CELL::CELL_POSITION lhs, const CELL::CELL_POSITION rhs) { return orderOf(lhs) < orderOf(rhs); });
+	return dirty;
+}
+
+vector<vector<CELL::CELL_POSITION>> DEPENDENCY_GRAPH::RecalculationLevels(const CELL::CELL_POSITION subject) const { return RecalculationLevels(vector<CELL::CELL_POSITION>{ subject }, { }); }
+
+// A cell's level is one past the deepest dirty cell it reads through an ordered edge.
+// Loop-closing edges run against the order, so they cannot be levelled. Instead, every cell on a loop (which includes
+// the observer of each loop-closing edge) is moved out of its level into a level of its own, straight after it,
+// so no cell reached through a loop ever shares a level with another cell.
+vector<vector<CELL::CELL_POSITION>> DEPENDENCY_GRAPH::RecalculationLevels(const vector<CELL::CELL_POSITION>& changed, const vector<CELL::CELL_POSITION>& seeds) const {
+	auto dirty = RecalculationOrder(changed, seeds);
+	auto levelOf = unordered_map<CELL::CELL_POSITION, size_t, CELL::CELL_HASH>{ };
+	for (auto& pos : dirty) { levelOf.emplace(pos, 0); }
+
+	auto levels = vector<vector<CELL::CELL_POSITION>>{ };
+	auto looped = vector<vector<CELL::CELL_POSITION>>{ };		// Cells on a loop, by level
+	for (auto& pos : dirty) {
+		auto& level = levelOf[pos];
+		auto it = subjects.find(pos);
+		if (it != subjects.end()) {
+			for (auto input : it->second) {
+				auto inputLevel = levelOf.find(input);
+				if (inputLevel != levelOf.end()) { level = max(level, inputLevel->second + 1); }
+			}
+		}
+		if (level >= levels.size()) { levels.resize(level + 1); looped.resize(level + 1); }
+		(IsCircular(pos) ? looped : levels)[level].push_back(pos);
+	}
+
+	auto serialized = vector<vector<CELL::CELL_POSITION>>{ };
+	for (auto level = size_t{ 0 }; level < levels.size(); ++level) {
+		if (!levels[level].empty()) { serialized.push_back(std::move(levels[level])); }
+		for (auto& pos : looped[level]) { serialized.push_back({ pos }); }
+	}
+	return serialized;
+}
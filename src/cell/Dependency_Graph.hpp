@@ -0,0 +1,99 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the dependency graph between cells.
+// An edge runs from a subject (the cell being referenced) to an observer (the cell holding the reference).
+// When a subject changes, every cell reachable from it is dirty and needs to be recalculated.
+// Rather than notifying observers recursively (which recalculates a cell once per path and recurses on the stack),
+// the graph hands back the dirty cells in topological order so that each one is evaluated exactly once,
+// after all of the dirty cells it depends upon.
+//
+// A topological order is maintained incrementally as edges are added (Pearce-Kelly).
+// Adding an edge that already agrees with the order is O(1). Otherwise only the cells ordered between the two ends
+// of the new edge are searched and reordered. If that search finds a path back to the subject, the edge would close
+// a reference loop. Such edges are set aside rather than added to the ordered graph, and every cell along the loop
+// is marked circular. Each cell lists the loops passing through it, so adding or removing an edge only re-examines
+// the loops through either of its ends, however many other loops the sheet holds.
+// A cell that only joins a loop by way of a second loop-closing edge, or by a new path between two cells outside of it,
+// may not be marked, but it is still ordered after the loop and picks up the loop's error through its inputs.
+// Each cell is identified by position and owns the edges that point into it: replacing a cell clears its old edges.
+//
+// A range edge makes an observer depend upon every cell in a rectangle. It is stored once in a RANGE_INDEX,
+// so its cost does not grow with the size of the rectangle. Plain values never need recalculating, so they take
+// no part in the order and are only found through the index when they change. Cells that observe something themselves
+// (formulas & references) do need to be ordered ahead of any range covering them, so an ordered edge is derived
+// for each such cell inside a range, whichever of the two is added first.
+//
+// Every map & set of the graph draws its nodes from a pool owned by the graph, so loading a sheet of formulas takes
+// memory a chunk at a time rather than one block per edge, and dropping the graph hands the chunks back at once.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEPENDENCY_GRAPH_CLASS_HPP
+#define DEPENDENCY_GRAPH_CLASS_HPP
+
+#include "Cell.hpp"
+#include "Position_Set.hpp"
+#include "Range_Index.hpp"
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Not synchronized. CELL_DATA guards access with its subscription lock.
+class DEPENDENCY_GRAPH {
+	using EDGE = std::pair<CELL::CELL_POSITION, CELL::CELL_POSITION>;		// (Subject, Observer)
+	using ADJACENCY = std::pmr::unordered_map<CELL::CELL_POSITION, POSITION_SET<CELL::CELL_POSITION>, CELL::CELL_HASH>;
+	using LOOPS = std::pmr::map<EDGE, std::vector<CELL::CELL_POSITION>>;
+
+	std::pmr::unsynchronized_pool_resource nodes;							// Declared first, so it outlives every container below
+	ADJACENCY observers{ &nodes };											// <Subject, (set of) Observers> Ordered edges only.
+	ADJACENCY subjects{ &nodes };											// <Observer, (set of) Subjects> Reverse of the above.
+	LOOPS loopEdges{ &nodes };												// Edges that close a loop, with the cells along that loop.
+	std::pmr::unordered_map<CELL::CELL_POSITION, std::vector<EDGE>, CELL::CELL_HASH> circular{ &nodes };	// Closing edges of the loops passing through each cell.
+	std::pmr::unordered_map<CELL::CELL_POSITION, long long, CELL::CELL_HASH> order{ &nodes };			// Topological index of each cell with edges.
+	long long nextOrder{ 0 };
+	RANGE_INDEX rangeIndex;														// <Rectangle, Observer> for each range edge.
+	std::pmr::unordered_map<CELL::CELL_POSITION, std::vector<std::pair<CELL::CELL_POSITION, CELL::CELL_POSITION>>, CELL::CELL_HASH> ranges{ &nodes };	// <Observer, (list of) Rectangles>
+	std::pmr::set<CELL::CELL_POSITION> observing{ &nodes };						// Cells with at least one edge or range pointing into them.
+	std::pmr::map<EDGE, std::pair<unsigned int, bool>> derived{ &nodes };		// Edges derived from ranges: <Edge, (Number of ranges, Also added directly)>
+
+	long long Order(const CELL::CELL_POSITION);
+	void Forget(const CELL::CELL_POSITION);
+	std::vector<CELL::CELL_POSITION> Forward(const CELL::CELL_POSITION, const long long upperBound) const;
+	std::vector<CELL::CELL_POSITION> Backward(const CELL::CELL_POSITION, const long long lowerBound) const;
+	std::vector<CELL::CELL_POSITION> LoopMembers(const EDGE&) const;
+	void MarkLoop(const EDGE&, std::vector<CELL::CELL_POSITION>&&);
+	void UnmarkLoop(LOOPS::iterator);
+	std::vector<EDGE> LoopsThrough(const CELL::CELL_POSITION, const CELL::CELL_POSITION) const;
+	void Insert(const EDGE&);
+	void Unlink(const EDGE&);
+	bool Contains(const EDGE&) const;
+	void Observe(const CELL::CELL_POSITION);
+	void AddDerived(const EDGE&);
+	void DropDerived(const EDGE&);
+public:
+	void AddEdge(const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer);
+	void RemoveEdge(const CELL::CELL_POSITION subject, const CELL::CELL_POSITION observer);
+	void AddRangeEdge(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer);	// Observe the rectangle from first to last (inclusive).
+	void RemoveObserver(const CELL::CELL_POSITION observer);				// Drop every edge and range pointing into the observer.
+	std::size_t RangeCount() const { return rangeIndex.Size(); }
+	std::size_t EdgeCount() const;											// Ordered & loop-closing edges, including those derived from ranges.
+
+	bool IsCircular(const CELL::CELL_POSITION pos) const { return circular.find(pos) != circular.end(); }
+
+	// All cells downstream of the subject ordered so that each cell follows its dependencies.
+	// The subject is only included if it sits inside a loop, in which case it needs its circular state refreshed.
+	std::vector<CELL::CELL_POSITION> RecalculationOrder(const CELL::CELL_POSITION subject) const;
+
+	// The same cells grouped into levels. Every cell is placed in a later level than each dirty cell it reads,
+	// so the cells within one level are independent of each other and may be recalculated in parallel.
+	// Each cell on a loop has a level to itself, since loop-closing edges take no part in the levelling.
+	std::vector<std::vector<CELL::CELL_POSITION>> RecalculationLevels(const CELL::CELL_POSITION subject) const;
+
+	// As above for many changed subjects at once, as when a batch of edits is committed. Each dirty cell appears once however many of them reach it.
+	// Seeds are cells that need recalculating themselves (new formulas, say), and are ordered along with everything downstream of the subjects.
+	std::vector<CELL::CELL_POSITION> RecalculationOrder(const std::vector<CELL::CELL_POSITION>& changed, const std::vector<CELL::CELL_POSITION>& seeds) const;
+	std::vector<std::vector<CELL::CELL_POSITION>> RecalculationLevels(const std::vector<CELL::CELL_POSITION>& changed, const std::vector<CELL::CELL_POSITION>& seeds) const;
+};
+
+#endif // !DEPENDENCY_GRAPH_CLASS_HPP
@@ -0,0 +1,179 @@
+#include "Edit_History.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace std;
+
+namespace {
+	constexpr auto FrameOverhead = size_t{ 2 * sizeof(uint32_t) };		// The payload size, before & after it, so steps can be walked both ways
+	constexpr auto MinimumCapacity = size_t{ 4096 };
+
+	void AppendVarint(string& out, uint64_t value) {
+		for (; value >= 0x80; value >>= 7) { out += static_cast<char>(value | 0x80); }
+		out += static_cast<char>(value);
+	}
+
+	uint64_t ReadVarint(const string& in, size_t& i) {
+		auto value = uint64_t{ 0 };
+		for (auto shift = 0; i < in.size(); shift += 7) {
+			auto byte = static_cast<uint8_t>(in[i++]);
+			value |= uint64_t{ byte & 0x7Fu } << shift;
+			if (byte < 0x80) { break; }
+		}
+		return value;
+	}
+
+	// The content after an edit is stored as what lies between the prefix & suffix it shares with the content before.
+	void AppendDelta(string& out, const EDIT_HISTORY::DELTA& delta) {
+		auto& [position, before, after] = delta;
+		AppendVarint(out, (uint64_t{ position.column } << 16) | position.row);
+		AppendVarint(out, before.size());
+		out += before;
+		auto shorter = min(before.size(), after.size());
+		auto prefix = static_cast<size_t>(mismatch(before.begin(), before.begin() + shorter, after.begin()).first - before.begin());
+		auto suffix = static_cast<size_t>(mismatch(before.rbegin(), before.rbegin() + (shorter - prefix), after.rbegin()).first - before.rbegin());
+		AppendVarint(out, prefix);
+		AppendVarint(out, suffix);
+		AppendVarint(out, after.size() - prefix - suffix);
+		out.append(after, prefix, after.size() - prefix - suffix);
+	}
+}
+
+EDIT_HISTORY::EDIT_HISTORY(CELL::CELL_DATA* cellData, const size_t budget) : cellData{ cellData }, budget{ budget } { }
+
+CELL::CELL_PROXY EDIT_HISTORY::NewCell(const CELL::CELL_POSITION pos, const string& contents) {
+	auto old = cellData->GetCellView(pos);
+	auto before = old ? old->GetRawContent() : string{ };
+	auto cell = CELL::NewCell(cellData, pos, contents);
+	auto now = cellData->GetCellView(pos);
+	auto after = now ? now->GetRawContent() : string{ };
+	if (after != before) { Record(vector<DELTA>{ DELTA{ pos, std::move(before), std::move(after) } }); }
+	return cell;
+}
+
+void EDIT_HISTORY::Record(const vector<CELL::EDIT>& edits) {
+	auto deltas = vector<DELTA>{ };
+	deltas.reserve(edits.size());
+	for (auto& [before, after] : edits) {
+		auto pos = before ? before->GetPosition() : after->GetPosition();
+		deltas.push_back(DELTA{ pos, before ? before->GetRawContent() : string{ }, after ? after->GetRawContent() : string{ } });
+	}
+	Record(deltas);
+}
+
+// A step larger than the whole budget cannot be kept, and neither can anything before it, since it could not be undone past.
+void EDIT_HISTORY::Record(const vector<DELTA>& deltas) {
+	auto payload = string{ };
+	for (auto& delta : deltas) { if (delta.before != delta.after) { AppendDelta(payload, delta); } }
+	if (payload.empty()) { return; }
+	auto frame = payload.size() + FrameOverhead;
+	if (frame > budget) { Clear(); return; }
+
+	end = cursor;
+	redoCount = 0;
+	while (end - begin + frame > capacity && capacity < budget) { Grow(static_cast<size_t>(end - begin) + frame); }
+	while (end - begin + frame > capacity) {
+		auto size = uint32_t{ };
+		Read(begin, reinterpret_cast<char*>(&size), sizeof(size));
+		begin += size + FrameOverhead;
+		--undoCount;
+	}
+	auto size = static_cast<uint32_t>(payload.size());
+	Write(end, reinterpret_cast<const char*>(&size), sizeof(size));
+	Write(end + sizeof(size), payload.data(), payload.size());
+	Write(end + sizeof(size) + payload.size(), reinterpret_cast<const char*>(&size), sizeof(size));
+	end += frame;
+	cursor = end;
+	++undoCount;
+}
+
+bool EDIT_HISTORY::Undo() {
+	if (cursor == begin) { return false; }
+	auto size = uint32_t{ };
+	Read(cursor - sizeof(size), reinterpret_cast<char*>(&size), sizeof(size));
+	cursor -= size + FrameOverhead;
+	Apply(Decode(StepAt(cursor)), true);
+	--undoCount;
+	++redoCount;
+	return true;
+}
+
+bool EDIT_HISTORY::Redo() {
+	if (cursor == end) { return false; }
+	auto payload = StepAt(cursor);
+	cursor += payload.size() + FrameOverhead;
+	Apply(Decode(payload), false);
+	++undoCount;
+	--redoCount;
+	return true;
+}
+
+void EDIT_HISTORY::Clear() {
+	begin = cursor = end = 0;
+	undoCount = redoCount = 0;
+	ring.reset();
+	capacity = 0;
+}
+
+// Doubles, up to the budget. Offsets keep their meaning, so the bytes held are laid out again for the new capacity.
+void EDIT_HISTORY::Grow(const size_t needed) {
+	auto held = string(static_cast<size_t>(end - begin), '\0');
+	Read(begin, held.data(), held.size());
+	capacity = min(budget, max({ needed, 2 * capacity, MinimumCapacity }));
+	ring = make_unique<char[]>(capacity);
+	Write(begin, held.data(), held.size());
+}
+
+void EDIT_HISTORY::Write(const uint64_t at, const char* data, const size_t size) {
+	if (size == 0) { return; }		// Nothing may be allocated yet
+	auto offset = static_cast<size_t>(at % capacity);
+	auto first = min(size, capacity - offset);
+	memcpy(ring.get() + offset, data, first);
+	memcpy(ring.get(), data + first, size - first);
+}
+
+void EDIT_HISTORY::Read(const uint64_t at, char* data, const size_t size) const {
+	if (size == 0) { return; }
+	auto offset = static_cast<size_t>(at % capacity);
+	auto first = min(size, capacity - offset);
+	memcpy(data, ring.get() + offset, first);
+	memcpy(data + first, ring.get(), size - first);
+}
+
+string EDIT_HISTORY::StepAt(const uint64_t at) const {
+	auto size = uint32_t{ };
+	Read(at, reinterpret_cast<char*>(&size), sizeof(size));
+	auto payload = string(size, '\0');
+	Read(at + sizeof(size), payload.data(), payload.size());
+	return payload;
+}
+
+vector<EDIT_HISTORY::DELTA> EDIT_HISTORY::Decode(const string& payload) const {
+	auto deltas = vector<DELTA>{ };
+	for (auto i = size_t{ 0 }; i < payload.size();) {
+		auto& delta = deltas.emplace_back();
+		auto key = ReadVarint(payload, i);
+		delta.position = CELL::CELL_POSITION{ static_cast<unsigned int>(key >> 16), static_cast<unsigned int>(key & 0xFFFF) };
+		auto length = static_cast<size_t>(ReadVarint(payload, i));
+		delta.before.assign(payload, i, length);
+		i += length;
+		auto prefix = static_cast<size_t>(ReadVarint(payload, i));
+		auto suffix = static_cast<size_t>(ReadVarint(payload, i));
+		length = static_cast<size_t>(ReadVarint(payload, i));
+		delta.after.reserve(prefix + length + suffix);
+		delta.after.assign(delta.before, 0, prefix);
+		delta.after.append(payload, i, length);
+		delta.after.append(delta.before, delta.before.size() - suffix, suffix);
+		i += length;
+	}
+	return deltas;
+}
+
+// Edits are reverted in reverse order, so a position edited twice in one step ends up as it was before the step.
+void EDIT_HISTORY::Apply(const vector<DELTA>& deltas, const bool undo) {
+	auto batch = CELL::BATCH{ cellData };
+	if (undo) { for (auto delta = deltas.rbegin(); delta != deltas.rend(); ++delta) { CELL::NewCell(cellData, delta->position, delta->before); } }
+	else { for (auto& delta : deltas) { CELL::NewCell(cellData, delta.position, delta.after); } }
+	batch.Commit();
+}
@@ -0,0 +1,63 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the undo/redo history of a sheet.
+// A step (one command: an edit, a paste, ...) is kept as the raw content before & after each of its edits, not as cells,
+// so the history pins no cell, formula or subscription. Undoing or redoing a step enters that content again in one BATCH,
+// rebuilding the cells it needs & recalculating once.
+// Steps are encoded into a ring buffer of bytes with a fixed budget: positions & lengths as variable-length integers, and the
+// content after an edit as what changed from the content before it (see DELTA), so nudging a long formula costs a few bytes.
+// Once the budget is reached, the oldest steps are dropped to make room, so memory stays flat however long the session.
+// Redo is dropped by any new step.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EDIT_HISTORY_CLASS_HPP
+#define EDIT_HISTORY_CLASS_HPP
+
+#include "Cell.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class EDIT_HISTORY {
+public:
+	static constexpr std::size_t DefaultBudget{ 4 << 20 };
+
+	// One edit of a step. Empty content means no cell.
+	struct DELTA {
+		CELL::CELL_POSITION position;
+		std::string before, after;
+	};
+
+	explicit EDIT_HISTORY(CELL::CELL_DATA*, const std::size_t budget = DefaultBudget);
+	EDIT_HISTORY(const EDIT_HISTORY&) = delete;
+	EDIT_HISTORY& operator=(const EDIT_HISTORY&) = delete;
+
+	CELL::CELL_PROXY NewCell(const CELL::CELL_POSITION, const std::string&);		// As CELL::NewCell, recorded as one step if anything changed.
+	void Record(const std::vector<CELL::EDIT>&);										// Record the edits of a committed BATCH as one step.
+	void Record(const std::vector<DELTA>&);
+	bool Undo();						// Returns false if there is nothing to undo.
+	bool Redo();
+	void Clear();
+
+	std::size_t UndoCount() const { return undoCount; }
+	std::size_t RedoCount() const { return redoCount; }
+	std::size_t Size() const { return static_cast<std::size_t>(end - begin); }		// Bytes held, never more than the budget.
+	std::size_t Budget() const { return budget; }
+private:
+	CELL::CELL_DATA* cellData;
+	std::size_t budget;
+	std::unique_ptr<char[]> ring;				// Grows up to the budget, then wraps
+	std::size_t capacity{ 0 };
+	std::uint64_t begin{ 0 }, cursor{ 0 }, end{ 0 };		// Offsets into the stream of steps: undo steps lie before the cursor, redo steps after it
+	std::size_t undoCount{ 0 }, redoCount{ 0 };
+
+	void Grow(const std::size_t needed);
+	void Write(const std::uint64_t at, const char*, const std::size_t);
+	void Read(const std::uint64_t at, char*, const std::size_t) const;
+	std::string StepAt(const std::uint64_t at) const;			// Payload of the step framed at the offset
+	std::vector<DELTA> Decode(const std::string& payload) const;
+	void Apply(const std::vector<DELTA>&, const bool undo);
+};
+
+#endif // !EDIT_HISTORY_CLASS_HPP
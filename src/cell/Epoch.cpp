@@ -0,0 +1,116 @@
+#include "Epoch.hpp"
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	atomic<uint64_t> globalEpoch{ 1 };
+	atomic<EPOCH::RECORD*> records{ nullptr };		// Records are reused by later threads but never freed
+
+	// Everything retired during one epoch. Epochs only grow, so groups are kept oldest first.
+	struct RETIRED {
+		uint64_t epoch{ 0 };
+		vector<shared_ptr<const void>> objects{ };
+	};
+
+	mutex lkRetired;
+	deque<RETIRED> retired;
+	size_t pending{ 0 };
+	uint64_t reclaimedAt{ 0 };						// Epoch of the last pass. Nothing more can be freed until it advances.
+
+	EPOCH::RECORD* AcquireRecord() {
+		for (auto record = records.load(memory_order_acquire); record; record = record->next) {
+			auto expected = false;
+			if (record->inUse.compare_exchange_strong(expected, true)) { return record; }
+		}
+		auto record = new EPOCH::RECORD{ };
+		record->inUse.store(true, memory_order_relaxed);
+		record->next = records.load(memory_order_relaxed);
+		while (!records.compare_exchange_weak(record->next, record, memory_order_release, memory_order_relaxed)) { }
+		return record;
+	}
+
+	// Each thread claims a record on its first read and hands it back when it exits.
+	struct THREAD_STATE {
+		EPOCH::RECORD* record{ AcquireRecord() };
+		unsigned int depth{ 0 };
+		~THREAD_STATE() { record->pinned.store(0, memory_order_release); record->inUse.store(false, memory_order_release); }
+	};
+
+	THREAD_STATE& ThisThread() {
+		thread_local auto state = THREAD_STATE{ };
+		return state;
+	}
+
+	// Move from epoch e to e + 1 once every pinned reader has seen e.
+	bool TryAdvance() {
+		auto current = globalEpoch.load(memory_order_acquire);
+		atomic_thread_fence(memory_order_seq_cst);
+		for (auto record = records.load(memory_order_acquire); record; record = record->next) {
+			auto pinned = record->pinned.load(memory_order_acquire);
+			if (pinned != 0 && pinned != current) { return false; }
+		}
+		globalEpoch.compare_exchange_strong(current, current + 1);		// Fails only if another thread advanced it first
+		return true;
+	}
+
+	// Caller holds lkRetired. Returns the groups that are now safe to destroy.
+	// A pass only runs once the epoch has moved on, and stops at the first group a reader may still see,
+	// so a reader pinned for a long time costs each retire a scan of the thread records, not of everything retired meanwhile.
+	vector<RETIRED> Reclaim() {
+		for (auto i = 0; i < 2 && TryAdvance(); ++i) { }
+		auto safe = globalEpoch.load(memory_order_acquire);
+		auto freed = vector<RETIRED>{ };
+		if (safe == reclaimedAt) { return freed; }
+		reclaimedAt = safe;
+		while (!retired.empty() && retired.front().epoch + 2 <= safe) {
+			pending -= retired.front().objects.size();
+			freed.push_back(std::move(retired.front()));
+			retired.pop_front();
+		}
+		return freed;
+	}
+}
+
+EPOCH::GUARD::GUARD() {
+	auto& state = ThisThread();
+	if (state.depth++ != 0) { return; }
+	state.record->pinned.store(globalEpoch.load(memory_order_acquire), memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);		// Announce the pin before reading any shared pointer
+}
+
+EPOCH::GUARD::~GUARD() {
+	auto& state = ThisThread();
+	if (--state.depth != 0) { return; }
+	state.record->pinned.store(0, memory_order_release);
+}
+
+// Objects are destroyed outside of the lock, since destroying one may retire others.
+void EPOCH::Retire(shared_ptr<const void> object) {
+	if (!object) { return; }
+	auto freed = vector<RETIRED>{ };
+	{
+		auto lk = lock_guard<mutex>{ lkRetired };
+		auto epoch = globalEpoch.load(memory_order_acquire);
+		if (retired.empty() || retired.back().epoch != epoch) { retired.push_back(RETIRED{ epoch }); }
+		retired.back().objects.push_back(std::move(object));
+		++pending;
+		freed = Reclaim();
+	}
+}
+
+void EPOCH::Collect() {
+	auto freed = vector<RETIRED>{ };
+	{
+		auto lk = lock_guard<mutex>{ lkRetired };
+		freed = Reclaim();
+	}
+}
+
+size_t EPOCH::PendingCount() {
+	auto lk = lock_guard<mutex>{ lkRetired };
+	return pending;
+}
@@ -0,0 +1,47 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining epoch-based reclamation for lock-free readers.
+// Readers pin the current epoch for the duration of a read and may follow any pointer they find while pinned.
+// Writers unlink an object first and then retire it. A retired object is only destroyed once the global epoch has
+// advanced twice past the point it was retired, by which time no reader that could have seen it is still pinned.
+//
+// Pinning writes only to a record owned by the calling thread, so readers never block one another or a writer,
+// and never write to a cache line that another thread writes to. Pins nest, so only the outermost one pays for a fence.
+// Writers are expected to be rare next to readers: retiring takes a mutex and reclaims whatever it can on the spot,
+// so with no readers pinned, an object is destroyed before Retire returns.
+// Retired objects are kept in groups by epoch, oldest first, and only looked at again once the epoch advances,
+// so a reader pinned for a long time does not make each retire rescan everything retired meanwhile.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EPOCH_CLASS_HPP
+#define EPOCH_CLASS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class EPOCH {
+public:
+	// Per-thread announcement of the epoch a reader is pinned to (0 while not reading).
+	struct alignas(64) RECORD {
+		std::atomic<std::uint64_t> pinned{ 0 };
+		std::atomic<bool> inUse{ false };
+		RECORD* next{ nullptr };
+	};
+
+	// Pin the calling thread while in scope.
+	class GUARD {
+	public:
+		GUARD();
+		~GUARD();
+		GUARD(const GUARD&) = delete;
+		GUARD& operator=(const GUARD&) = delete;
+	};
+
+	// Destroy the object once no pinned reader can still be using it.
+	static void Retire(std::shared_ptr<const void>);
+	static void Collect();								// Advance the epoch and destroy what it allows.
+	static std::size_t PendingCount();					// Objects retired but not yet destroyed.
+};
+
+#endif // !EPOCH_CLASS_HPP
@@ -0,0 +1,438 @@
+/*//////////
+// This file seperates out the Function aspect of cells from the cell aspect of behavior
+// Formula text is compiled into a FORMULA_PROGRAM, which FUNCTION_CELL re-runs on every recalculation.
+*///////////
+
+#include "Formula.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FORMULA_SSE2
+#endif
+
+using namespace std;
+
+namespace {
+	// Map function names onto the functions the program can call.
+	// Unknown names pass their first argument through unchanged.
+	FORMULA_PROGRAM::FUNCTION_ID MatchNameToFunction(const string_view inputText) {
+		using enum FORMULA_PROGRAM::FUNCTION_ID;
+		if (inputText == "SUM"sv) { return SUM; }
+		else if (inputText == "AVERAGE"sv) { return AVERAGE; }
+		else if (inputText == "PRODUCT"sv) { return PRODUCT; }
+		else if (inputText == "INVERSE"sv) { return INVERSE; }
+		else if (inputText == "RECIPROCAL"sv) { return RECIPROCAL; }
+		else if (inputText == "PI"sv) { return PI; }
+		else if (inputText == "MIN"sv) { return MIN; }
+		else if (inputText == "MAX"sv) { return MAX; }
+		else if (inputText == "COUNT"sv) { return COUNT; }
+		else { return FIRST; }
+	}
+
+	// Functions which reduce any number of values to one, and may therefore take ranges.
+	bool IsAggregate(const FORMULA_PROGRAM::FUNCTION_ID function) {
+		using enum FORMULA_PROGRAM::FUNCTION_ID;
+		return function == SUM || function == AVERAGE || function == PRODUCT || function == MIN || function == MAX || function == COUNT;
+	}
+
+	// Check the number of arguments when compiling, so that running the program never has to.
+	void CheckArgumentCount(const FORMULA_PROGRAM::FUNCTION_ID function, const size_t count) {
+		using enum FORMULA_PROGRAM::FUNCTION_ID;
+		switch (function) {
+		case INVERSE: [[fallthrough]];
+		case RECIPROCAL: { if (count != 1) { throw invalid_argument("Error parsing input text.\nExactly one argument must be given."); } } break;
+		case PI: { if (count != 0) { throw invalid_argument("Error parsing input text.\nFunction takes no arguments."); } } break;
+		default: { if (count == 0) { throw invalid_argument("Error parsing input text.\nNo arguments provided."); } } break;
+		}
+		if (count >= FORMULA_PROGRAM::Variadic) { throw invalid_argument("Error parsing input text.\nToo many arguments."); }
+	}
+}
+
+namespace {
+	enum class TOKEN_TYPE { END, NUMBER, REFERENCE, RANGE, NAME, OPEN, CLOSE, COMMA, PLUS, MINUS, STAR, SLASH };
+
+	struct TOKEN {
+		TOKEN_TYPE type{ TOKEN_TYPE::END };
+		string_view text;							// Slice of the formula text; never copied.
+		double number{ 0 };							// Value of a NUMBER
+		CELL::CELL_POSITION position{ };			// Target of a REFERENCE, or first corner of a RANGE
+		CELL::CELL_POSITION corner{ };				// Opposite corner of a RANGE
+	};
+
+	// Splits formula text into tokens in place, skipping any whitespace between them.
+	class TOKENIZER {
+		string_view text;
+		size_t offset{ 0 };
+		TOKEN current;
+
+		void Fail() const { throw invalid_argument("Error parsing input text."); }
+
+		// Reads one "R___" or "C___" part of a reference: either order, not case-sensitive.
+		void ReadReferencePart(CELL::CELL_POSITION& pos) {
+			if (offset == text.size()) { Fail(); }
+			auto letter = toupper(static_cast<unsigned char>(text[offset++]));
+			auto index = 0u;
+			auto [end, status] = from_chars(text.data() + offset, text.data() + text.size(), index);
+			if (status != errc{ }) { Fail(); }
+			offset = end - text.data();
+			if (letter == 'R' && pos.row == 0) { pos.row = index; }
+			else if (letter == 'C' && pos.column == 0) { pos.column = index; }
+			else { Fail(); }
+		}
+
+		void Advance() {
+			while (offset < text.size() && isspace(static_cast<unsigned char>(text[offset]))) { ++offset; }
+			current = TOKEN{ };
+			if (offset == text.size()) { return; }
+
+			auto start = offset;
+			auto c = text[offset];
+			if (isdigit(static_cast<unsigned char>(c)) || c == '.') {
+				auto [end, status] = from_chars(text.data() + offset, text.data() + text.size(), current.number);
+				if (status != errc{ }) { Fail(); }
+				offset = end - text.data();
+				current.type = TOKEN_TYPE::NUMBER;
+			}
+			else if (c == '&') {
+				++offset;
+				ReadReferencePart(current.position);
+				ReadReferencePart(current.position);
+				current.type = TOKEN_TYPE::REFERENCE;
+				if (offset < text.size() && text[offset] == ':') {		// Range: &R__C__:R__C__ (second '&' optional)
+					++offset;
+					if (offset < text.size() && text[offset] == '&') { ++offset; }
+					ReadReferencePart(current.corner);
+					ReadReferencePart(current.corner);
+					current.type = TOKEN_TYPE::RANGE;
+				}
+			}
+			else if (isalpha(static_cast<unsigned char>(c))) {
+				while (offset < text.size() && isalpha(static_cast<unsigned char>(text[offset]))) { ++offset; }
+				current.type = TOKEN_TYPE::NAME;
+			}
+			else {
+				switch (c) {
+				case '(': { current.type = TOKEN_TYPE::OPEN; } break;
+				case ')': { current.type = TOKEN_TYPE::CLOSE; } break;
+				case ',': { current.type = TOKEN_TYPE::COMMA; } break;
+				case '+': { current.type = TOKEN_TYPE::PLUS; } break;
+				case '-': { current.type = TOKEN_TYPE::MINUS; } break;
+				case '*': { current.type = TOKEN_TYPE::STAR; } break;
+				case '/': { current.type = TOKEN_TYPE::SLASH; } break;
+				default: { Fail(); }
+				}
+				++offset;
+			}
+			current.text = text.substr(start, offset - start);
+		}
+	public:
+		explicit TOKENIZER(const string_view formula) : text{ formula } { Advance(); }
+		const TOKEN& Peek() const { return current; }
+		TOKEN Next() { auto token = current; Advance(); return token; }
+		void Expect(const TOKEN_TYPE type, const char* message) { if (current.type != type) { throw invalid_argument(message); } Advance(); }
+	};
+
+	// Binding strength of a binary operator; zero for anything else.
+	int Precedence(const TOKEN_TYPE type) {
+		switch (type) {
+		case TOKEN_TYPE::PLUS: [[fallthrough]];
+		case TOKEN_TYPE::MINUS: { return 1; }
+		case TOKEN_TYPE::STAR: [[fallthrough]];
+		case TOKEN_TYPE::SLASH: { return 2; }
+		default: { return 0; }
+		}
+	}
+
+	FORMULA_PROGRAM::OPCODE OperatorCode(const TOKEN_TYPE type) {
+		using enum FORMULA_PROGRAM::OPCODE;
+		switch (type) {
+		case TOKEN_TYPE::PLUS: { return ADD; }
+		case TOKEN_TYPE::MINUS: { return SUBTRACT; }
+		case TOKEN_TYPE::STAR: { return MULTIPLY; }
+		default: { return DIVIDE; }
+		}
+	}
+
+	void CheckReference(const CELL::CELL_POSITION pos) {
+		if (pos.row == 0 || pos.column == 0 || pos.row > MaxRow_ || pos.column > MaxColumn_) { throw invalid_argument("Error parsing input text.\nReference is out of range."); }
+	}
+
+	constexpr auto MaxNesting_{ 256 };		// Deeper formulas are rejected rather than risk exhausting the stack.
+}
+
+// Precedence-climbing parser, emitting postfix code as it goes.
+class FORMULA_PARSER {
+	TOKENIZER tokens;
+	FORMULA_PROGRAM& program;
+	CELL::CELL_POSITION anchor;
+	int nesting{ 0 };
+
+	void Expression(const int minPrecedence);
+	void Unary();
+	void Primary();
+	void Call(const string_view name);
+	void Range(const TOKEN&);
+	void Constant(const double);
+public:
+	FORMULA_PARSER(const string_view text, const CELL::CELL_POSITION cell, FORMULA_PROGRAM& output) : tokens{ text }, program{ output }, anchor{ cell } { }
+	void Parse() {
+		Expression(1);
+		tokens.Expect(TOKEN_TYPE::END, "Error parsing input text.\nUnexpected text after formula.");
+	}
+};
+
+// Parse operands joined by operators binding at least as tightly as minPrecedence.
+// Parsing the right-hand side one level tighter makes operators of equal precedence associate to the left.
+void FORMULA_PARSER::Expression(const int minPrecedence) {
+	if (++nesting > MaxNesting_) { throw invalid_argument("Error parsing input text.\nFormula is nested too deeply."); }
+	Unary();
+	while (true) {
+		auto type = tokens.Peek().type;
+		auto precedence = Precedence(type);
+		if (precedence == 0 || precedence < minPrecedence) { break; }
+		tokens.Next();
+		Expression(precedence + 1);
+		program.Emit(FORMULA_PROGRAM::INSTRUCTION{ OperatorCode(type) }, 2);
+	}
+	--nesting;
+}
+
+// Signs are counted in a loop rather than by recursion, so however many lead a term they cannot exhaust the stack.
+void FORMULA_PARSER::Unary() {
+	auto negations = size_t{ 0 };
+	while (true) {
+		auto type = tokens.Peek().type;
+		if (type == TOKEN_TYPE::PLUS) { tokens.Next(); continue; }
+		if (type != TOKEN_TYPE::MINUS) { Primary(); break; }
+		tokens.Next();
+		if (tokens.Peek().type == TOKEN_TYPE::NUMBER) { Constant(-tokens.Next().number); break; }		// Negative literal
+		++negations;
+	}
+	for (; negations != 0; --negations) { program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::NEGATE }, 1); }
+}
+
+void FORMULA_PARSER::Primary() {
+	auto token = tokens.Next();
+	switch (token.type) {
+	case TOKEN_TYPE::NUMBER: { Constant(token.number); } break;
+	case TOKEN_TYPE::REFERENCE: {
+		auto pos = token.position;
+		CheckReference(pos);
+		auto offset = FORMULA_PROGRAM::OFFSET{ static_cast<int>(pos.column) - static_cast<int>(anchor.column), static_cast<int>(pos.row) - static_cast<int>(anchor.row) };
+		auto& offsets = program.offsets;
+		auto index = static_cast<uint32_t>(find(offsets.begin(), offsets.end(), offset) - offsets.begin());
+		if (index == offsets.size()) { offsets.push_back(offset); }
+		program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::LOAD, FORMULA_PROGRAM::FUNCTION_ID::FIRST, 0, index }, 0);
+	} break;
+	case TOKEN_TYPE::NAME: { Call(token.text); } break;
+	case TOKEN_TYPE::RANGE: { throw invalid_argument("Error parsing input text.\nRanges may only be passed to SUM, AVERAGE, PRODUCT, MIN, MAX or COUNT."); }
+	case TOKEN_TYPE::OPEN: {
+		Expression(1);
+		tokens.Expect(TOKEN_TYPE::CLOSE, "Error parsing input text. \nParentheses mismatch.");
+	} break;
+	default: { throw invalid_argument("Error parsing input text."); }
+	}
+}
+
+// Arguments are emitted before the call that consumes them, which produces postfix order directly.
+// A range is only valid as a whole argument. Calls with a range are variadic, since the number of values is only known once gathered.
+void FORMULA_PARSER::Call(const string_view name) {
+	tokens.Expect(TOKEN_TYPE::OPEN, "Error parsing input text. \nParentheses mismatch.");
+	auto function = MatchNameToFunction(name);
+	auto mark = program.code.size();
+	auto frameDepth = program.depth;
+	auto count = size_t{ 0 };
+	auto hasRange = false;
+	if (tokens.Peek().type != TOKEN_TYPE::CLOSE) {
+		while (true) {
+			if (tokens.Peek().type == TOKEN_TYPE::RANGE && IsAggregate(function)) {
+				Range(tokens.Next());
+				hasRange = true;
+				if (tokens.Peek().type != TOKEN_TYPE::COMMA && tokens.Peek().type != TOKEN_TYPE::CLOSE) { throw invalid_argument("Error parsing input text."); }
+			}
+			else { Expression(1); }
+			++count;
+			if (tokens.Peek().type != TOKEN_TYPE::COMMA) { break; }
+			tokens.Next();
+		}
+	}
+	tokens.Expect(TOKEN_TYPE::CLOSE, "Error parsing input text. \nParentheses mismatch.");
+
+	CheckArgumentCount(function, count);
+	if (!hasRange) { program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::CALL, function, static_cast<uint16_t>(count) }, count); return; }
+	program.code.insert(program.code.begin() + mark, FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::MARK });
+	program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::CALL, function, FORMULA_PROGRAM::Variadic }, program.depth - frameDepth);
+}
+
+// A range may push up to one value per cell, which bounds the stack it needs.
+void FORMULA_PARSER::Range(const TOKEN& token) {
+	auto first = token.position;
+	auto last = token.corner;
+	CheckReference(first);
+	CheckReference(last);
+	auto toOffset = [this](const unsigned int column, const unsigned int row) {
+		return FORMULA_PROGRAM::OFFSET{ static_cast<int>(column) - static_cast<int>(anchor.column), static_cast<int>(row) - static_cast<int>(anchor.row) };
+	};
+	auto range = FORMULA_PROGRAM::RANGE{ toOffset(min(first.column, last.column), min(first.row, last.row)), toOffset(max(first.column, last.column), max(first.row, last.row)) };
+	if (range.Area() > FORMULA_PROGRAM::MaxRangeArea) { throw invalid_argument("Error parsing input text.\nRange is too large."); }
+
+	auto& ranges = program.ranges;
+	auto index = static_cast<uint32_t>(find_if(ranges.begin(), ranges.end(), [&range](const FORMULA_PROGRAM::RANGE& other) { return other.first == range.first && other.last == range.last; }) - ranges.begin());
+	if (index == ranges.size()) { ranges.push_back(range); }
+	program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::LOAD_RANGE, FORMULA_PROGRAM::FUNCTION_ID::FIRST, 0, index }, 0, range.Area());
+}
+
+void FORMULA_PARSER::Constant(const double value) {
+	program.constants.push_back(value);
+	program.Emit(FORMULA_PROGRAM::INSTRUCTION{ FORMULA_PROGRAM::OPCODE::CONSTANT, FORMULA_PROGRAM::FUNCTION_ID::FIRST, 0, static_cast<uint32_t>(program.constants.size() - 1) }, 0);
+}
+
+FORMULA_PROGRAM FORMULA_PROGRAM::Compile(const string_view text, const CELL::CELL_POSITION anchor) {
+	auto program = FORMULA_PROGRAM{ };
+	FORMULA_PARSER{ text, anchor, program }.Parse();
+	return program;
+}
+
+// Tokens separated by single spaces, with each reference rewritten as an offset from the anchor: &R[row]C[column].
+string FORMULA_PROGRAM::Canonical(const string_view text, const CELL::CELL_POSITION anchor) {
+	auto canonical = string{ };
+	canonical.reserve(text.size() + 16);
+	for (auto tokens = TOKENIZER{ text }; tokens.Peek().type != TOKEN_TYPE::END; ) {
+		auto token = tokens.Next();
+		if (token.type != TOKEN_TYPE::REFERENCE && token.type != TOKEN_TYPE::RANGE) { canonical += token.text; }
+		else {
+			CheckReference(token.position);
+			char digits[16];
+			canonical += "&R[";
+			canonical.append(digits, to_chars(digits, digits + sizeof(digits), static_cast<int>(token.position.row) - static_cast<int>(anchor.row)).ptr);
+			canonical += "]C[";
+			canonical.append(digits, to_chars(digits, digits + sizeof(digits), static_cast<int>(token.position.column) - static_cast<int>(anchor.column)).ptr);
+			canonical += ']';
+			if (token.type == TOKEN_TYPE::RANGE) {
+				CheckReference(token.corner);
+				canonical += ":R[";
+				canonical.append(digits, to_chars(digits, digits + sizeof(digits), static_cast<int>(token.corner.row) - static_cast<int>(anchor.row)).ptr);
+				canonical += "]C[";
+				canonical.append(digits, to_chars(digits, digits + sizeof(digits), static_cast<int>(token.corner.column) - static_cast<int>(anchor.column)).ptr);
+				canonical += ']';
+			}
+		}
+		canonical += ' ';
+	}
+	return canonical;
+}
+
+vector<CELL::CELL_POSITION> FORMULA_PROGRAM::References(const CELL::CELL_POSITION anchor) const {
+	auto references = vector<CELL::CELL_POSITION>{ };
+	references.reserve(offsets.size());
+	for (auto offset : offsets) { references.push_back(Resolve(anchor, offset)); }
+	return references;
+}
+
+vector<pair<CELL::CELL_POSITION, CELL::CELL_POSITION>> FORMULA_PROGRAM::Ranges(const CELL::CELL_POSITION anchor) const {
+	auto corners = vector<pair<CELL::CELL_POSITION, CELL::CELL_POSITION>>{ };
+	corners.reserve(ranges.size());
+	for (auto& range : ranges) { corners.emplace_back(Resolve(anchor, range.first), Resolve(anchor, range.last)); }
+	return corners;
+}
+
+size_t FORMULA_PROGRAM::MemoryUsage() const {
+	return sizeof(FORMULA_PROGRAM) + code.capacity() * sizeof(INSTRUCTION) + constants.capacity() * sizeof(double)
+		+ offsets.capacity() * sizeof(OFFSET) + ranges.capacity() * sizeof(RANGE);
+}
+
+shared_ptr<const FORMULA_PROGRAM> FORMULA_CACHE::Get(const string_view text, const CELL::CELL_POSITION anchor) {
+	auto key = FORMULA_PROGRAM::Canonical(text, anchor);
+	{
+		auto lk = lock_guard<mutex>{ lkCache };
+		auto it = programs.find(key);
+		if (it != programs.end()) { if (auto program = it->second.lock()) { return program; } }
+	}
+
+	// Compile outside the lock. Another thread may compile the same shape meanwhile; the first one stored wins.
+	auto compiled = make_shared<const FORMULA_PROGRAM>(FORMULA_PROGRAM::Compile(text, anchor));
+	auto lk = lock_guard<mutex>{ lkCache };
+	auto& entry = programs[std::move(key)];
+	if (auto program = entry.lock()) { return program; }
+	entry = compiled;
+	if (programs.size() >= purgeAt) {
+		erase_if(programs, [](const auto& cached) { return cached.second.expired(); });
+		purgeAt = max(size_t{ 64 }, programs.size() * 2);
+	}
+	return compiled;
+}
+
+size_t FORMULA_CACHE::Size() const {
+	auto lk = lock_guard<mutex>{ lkCache };
+	return count_if(programs.begin(), programs.end(), [](const auto& cached) { return !cached.second.expired(); });
+}
+
+// Append an instruction which pops and pushes the given numbers of values (at most, for a range).
+void FORMULA_PROGRAM::Emit(const INSTRUCTION instruction, const size_t popped, const size_t pushed) {
+	code.push_back(instruction);
+	depth = depth - popped + pushed;
+	maxDepth = max(maxDepth, depth);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////////
+// Procedures for supported functions
+// Each procedure reads its arguments from a contiguous slice of the evaluation stack
+// Argument counts were checked when the program was compiled, but ranges may gather no values at all
+// Aggregates use SSE2 kernels where available (always on x64), with two accumulators to hide instruction latency
+*/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+	template <typename COMBINE, typename COMBINE_PAIR>
+	double Reduce(const double* values, const size_t count, const double identity, COMBINE&& combine, [[maybe_unused]] COMBINE_PAIR&& combinePair) {
+		auto i = size_t{ 0 };
+		auto result = identity;
+#ifdef FORMULA_SSE2
+		auto a = _mm_set1_pd(identity);
+		auto b = _mm_set1_pd(identity);
+		for (; i + 4 <= count; i += 4) {
+			a = combinePair(a, _mm_loadu_pd(values + i));
+			b = combinePair(b, _mm_loadu_pd(values + i + 2));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, combinePair(a, b));
+		result = combine(lanes[0], lanes[1]);
+#endif
+		for (; i < count; ++i) { result = combine(result, values[i]); }
+		return result;
+	}
+
+#ifdef FORMULA_SSE2
+	#define FORMULA_PAIR(INTRINSIC) [](__m128d x, __m128d y) { return INTRINSIC(x, y); }
+#else
+	#define FORMULA_PAIR(INTRINSIC) 0
+#endif
+
+	double SumKernel(const double* values, const size_t count) { return Reduce(values, count, 0.0, [](double x, double y) { return x + y; }, FORMULA_PAIR(_mm_add_pd)); }
+	double ProductKernel(const double* values, const size_t count) { return Reduce(values, count, 1.0, [](double x, double y) { return x * y; }, FORMULA_PAIR(_mm_mul_pd)); }
+	double MinKernel(const double* values, const size_t count) { return Reduce(values, count, values[0], [](double x, double y) { return y < x ? y : x; }, FORMULA_PAIR(_mm_min_pd)); }
+	double MaxKernel(const double* values, const size_t count) { return Reduce(values, count, values[0], [](double x, double y) { return y > x ? y : x; }, FORMULA_PAIR(_mm_max_pd)); }
+
+	#undef FORMULA_PAIR
+}
+
+FORMULA_PROGRAM::RESULT FORMULA_PROGRAM::Call(const FUNCTION_ID function, const double* arguments, const size_t count) {
+	switch (function) {
+	case FUNCTION_ID::SUM: { return RESULT{ SumKernel(arguments, count) }; }
+	case FUNCTION_ID::AVERAGE: {
+		if (count == 0) { return RESULT{ 0, "Division by zero" }; }
+		return RESULT{ SumKernel(arguments, count) / count };
+	}
+	case FUNCTION_ID::PRODUCT: { return RESULT{ count == 0 ? 0.0 : ProductKernel(arguments, count) }; }
+	case FUNCTION_ID::MIN: { return RESULT{ count == 0 ? 0.0 : MinKernel(arguments, count) }; }
+	case FUNCTION_ID::MAX: { return RESULT{ count == 0 ? 0.0 : MaxKernel(arguments, count) }; }
+	case FUNCTION_ID::COUNT: { return RESULT{ static_cast<double>(count) }; }
+	case FUNCTION_ID::INVERSE: { return RESULT{ arguments[0] * (-1) }; }
+	case FUNCTION_ID::RECIPROCAL: { return RESULT{ 1 / arguments[0] }; }
+	case FUNCTION_ID::PI: { return RESULT{ 3.14159 }; }	// <== May consider other ways to call/represent this number.
+	default: { return RESULT{ arguments[0] }; }
+	}
+}
@@ -0,0 +1,178 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining compiled formulas.
+// A formula is compiled once, when its cell is created, into a flat postfix (RPN) instruction stream for a small stack machine.
+// Constants and referenced values are pushed onto a stack, and each function call pops its arguments and pushes its result.
+// Recalculating the cell just re-runs the program: there are no per-node objects to allocate, and no pointers to chase.
+// Errors (dangling reference, non-numeric input) stop the program with a static message.
+// Malformed formulas, including calls with the wrong number of arguments, are rejected when compiled.
+//
+// Formula text is tokenized in place over a string_view and parsed by precedence climbing:
+//   expression := unary { ('+' | '-' | '*' | '/') unary }		with * and / binding tighter than + and -
+//   unary      := { '-' | '+' } primary
+//   primary    := number | reference | name '(' [ expression { ',' expression } ] ')' | '(' expression ')'
+// The only allocations are the program's own instruction, constant and reference arrays.
+//
+// References are stored as offsets from the cell holding the formula (its anchor), so a program does not depend upon
+// where it sits. A column of formulas filled down, such as =SUM(&R1C1, &R1C2), =SUM(&R2C1, &R2C2), ... all compile
+// to the same program. FORMULA_CACHE interns programs by their canonical text, letting such cells share one program.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FORMULA_CLASS_HPP
+#define FORMULA_CLASS_HPP
+
+#include "Cell.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class FORMULA_PROGRAM {
+public:
+	enum class OPCODE : std::uint8_t { CONSTANT, LOAD, LOAD_RANGE, MARK, CALL, ADD, SUBTRACT, MULTIPLY, DIVIDE, NEGATE };
+	enum class FUNCTION_ID : std::uint8_t { FIRST, SUM, AVERAGE, PRODUCT, INVERSE, RECIPROCAL, PI, MIN, MAX, COUNT };
+
+	static constexpr auto Variadic{ std::uint16_t{ UINT16_MAX } };		// Argument count of a CALL which takes everything above its MARK.
+	static constexpr auto MaxRangeArea{ std::size_t{ 1 } << 20 };		// Most cells a single range may cover.
+
+	// The operand is an index into the constant pool (CONSTANT), the offset table (LOAD) or the range table (LOAD_RANGE).
+	// CALL uses function & argument count.
+	struct INSTRUCTION {
+		OPCODE opcode{ OPCODE::CONSTANT };
+		FUNCTION_ID function{ FUNCTION_ID::FIRST };
+		std::uint16_t argumentCount{ 0 };
+		std::uint32_t operand{ 0 };
+	};
+
+	// Outcome of running a program, or of loading one referenced value.
+	struct RESULT {
+		double value{ 0 };
+		const char* error{ nullptr };
+	};
+
+	// Outcome of gathering the numbers in a range.
+	struct RANGE_RESULT {
+		std::size_t count{ 0 };
+		const char* error{ nullptr };
+	};
+
+	// Position of a reference relative to the anchor.
+	struct OFFSET {
+		int column{ 0 };
+		int row{ 0 };
+		friend bool operator== (const OFFSET&, const OFFSET&) = default;
+	};
+
+	// Corners of a range relative to the anchor: top-left & bottom-right.
+	struct RANGE {
+		OFFSET first, last;
+		std::size_t Area() const { return std::size_t(last.column - first.column + 1) * std::size_t(last.row - first.row + 1); }
+	};
+
+	// Compile formula text, without its leading '=', for a cell at the anchor. Throws invalid_argument if the text cannot be parsed.
+	static FORMULA_PROGRAM Compile(const std::string_view text, const CELL::CELL_POSITION anchor);
+
+	// Text which is identical for formulas that compile to the same program, wherever they are anchored.
+	// Throws invalid_argument if the text cannot be split into tokens.
+	static std::string Canonical(const std::string_view text, const CELL::CELL_POSITION anchor);
+
+	// Run the program for a cell at the anchor, calling load(CELL_POSITION) -> RESULT for each referenced value
+	// and loadRange(first CELL_POSITION, last CELL_POSITION, double* out) -> RANGE_RESULT to gather the numbers in each range.
+	template <typename LOAD, typename LOAD_RANGE> RESULT Run(const CELL::CELL_POSITION anchor, LOAD&& load, LOAD_RANGE&& loadRange) const;
+
+	// Run the program, gathering ranges one position at a time through load. Positions that fail to load are skipped.
+	template <typename LOAD> RESULT Run(const CELL::CELL_POSITION anchor, LOAD&& load) const;
+
+	std::vector<CELL::CELL_POSITION> References(const CELL::CELL_POSITION anchor) const;		// Each referenced position, once.
+	std::vector<std::pair<CELL::CELL_POSITION, CELL::CELL_POSITION>> Ranges(const CELL::CELL_POSITION anchor) const;	// Corners of each range, once.
+	const std::vector<INSTRUCTION>& Code() const { return code; }
+	std::size_t MemoryUsage() const;											// Bytes held by this program, including its arrays.
+private:
+	std::vector<INSTRUCTION> code;
+	std::vector<double> constants;
+	std::vector<OFFSET> offsets;								// Each reference, once.
+	std::vector<RANGE> ranges;									// Each range, once.
+	std::size_t depth{ 0 }, maxDepth{ 0 };						// Stack depth while compiling, and the most the program needs.
+
+	friend class FORMULA_PARSER;
+	void Emit(const INSTRUCTION, const std::size_t popped, const std::size_t pushed = 1);
+	static RESULT Call(const FUNCTION_ID, const double* arguments, const std::size_t count);
+	static CELL::CELL_POSITION Resolve(const CELL::CELL_POSITION anchor, const OFFSET offset) {
+		return CELL::CELL_POSITION{ static_cast<unsigned int>(static_cast<int>(anchor.column) + offset.column), static_cast<unsigned int>(static_cast<int>(anchor.row) + offset.row) };
+	}
+};
+
+// Compiled programs interned by canonical text. Cells hold shared pointers to the programs, and an entry lives only
+// as long as some cell still uses it. Owned by CELL_DATA; safe to use from several threads.
+class FORMULA_CACHE {
+	mutable std::mutex lkCache;
+	std::unordered_map<std::string, std::weak_ptr<const FORMULA_PROGRAM>> programs;
+	std::size_t purgeAt{ 64 };									// Drop expired entries once the map grows to this size.
+public:
+	// Shared program for the formula text anchored at the given position, compiling it if needed.
+	std::shared_ptr<const FORMULA_PROGRAM> Get(const std::string_view text, const CELL::CELL_POSITION anchor);
+	std::size_t Size() const;									// Number of programs currently in use.
+};
+
+template <typename LOAD, typename LOAD_RANGE>
+FORMULA_PROGRAM::RESULT FORMULA_PROGRAM::Run(const CELL::CELL_POSITION anchor, LOAD&& load, LOAD_RANGE&& loadRange) const {
+	thread_local auto stack = std::vector<double>{ };		// Reused between runs, so they only grow while warming up.
+	thread_local auto frames = std::vector<std::size_t>{ };	// Stack sizes recorded by MARK
+	if (code.empty()) { return RESULT{ 0, "Empty formula" }; }
+	if (stack.size() < maxDepth) { stack.resize(maxDepth); }
+	frames.clear();
+
+	auto top = stack.data();
+	auto size = std::size_t{ 0 };
+	for (auto& instruction : code) {
+		switch (instruction.opcode) {
+		case OPCODE::CONSTANT: { top[size++] = constants[instruction.operand]; } break;
+		case OPCODE::LOAD: {
+			auto loaded = load(Resolve(anchor, offsets[instruction.operand]));
+			if (loaded.error) { return loaded; }
+			top[size++] = loaded.value;
+		} break;
+		case OPCODE::LOAD_RANGE: {
+			auto& range = ranges[instruction.operand];
+			auto gathered = loadRange(Resolve(anchor, range.first), Resolve(anchor, range.last), top + size);
+			if (gathered.error) { return RESULT{ 0, gathered.error }; }
+			size += gathered.count;
+		} break;
+		case OPCODE::MARK: { frames.push_back(size); } break;
+		case OPCODE::CALL: {
+			auto count = std::size_t{ instruction.argumentCount };
+			if (instruction.argumentCount == Variadic) { count = size - frames.back(); frames.pop_back(); }
+			size -= count;
+			auto called = Call(instruction.function, top + size, count);
+			if (called.error) { return called; }
+			top[size++] = called.value;
+		} break;
+		case OPCODE::ADD: { --size; top[size - 1] += top[size]; } break;
+		case OPCODE::SUBTRACT: { --size; top[size - 1] -= top[size]; } break;
+		case OPCODE::MULTIPLY: { --size; top[size - 1] *= top[size]; } break;
+		case OPCODE::DIVIDE: { --size; top[size - 1] /= top[size]; } break;
+		case OPCODE::NEGATE: { top[size - 1] = -top[size - 1]; } break;
+		}
+	}
+	return RESULT{ top[size - 1] };
+}
+
+template <typename LOAD>
+FORMULA_PROGRAM::RESULT FORMULA_PROGRAM::Run(const CELL::CELL_POSITION anchor, LOAD&& load) const {
+	return Run(anchor, load, [&load](const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, double* out) {
+		auto count = std::size_t{ 0 };
+		for (auto column = first.column; column <= last.column; ++column) {
+			for (auto row = first.row; row <= last.row; ++row) {
+				auto loaded = load(CELL::CELL_POSITION{ column, row });
+				if (!loaded.error) { out[count++] = loaded.value; }
+			}
+		}
+		return RANGE_RESULT{ count };
+	});
+}
+
+#endif // !FORMULA_CLASS_HPP
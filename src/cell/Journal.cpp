@@ -0,0 +1,224 @@
+#include "Journal.hpp"
+#include "Workbook_File.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	constexpr auto FrameHeaderSize = size_t{ 8 };		// Payload length & CRC-32
+	constexpr auto RecordHeaderSize = size_t{ 8 };		// Packed position & content length
+
+	constexpr auto CrcTable = [] {
+		auto table = array<uint32_t, 256>{ };
+		for (auto i = 0u; i < 256; ++i) {
+			auto crc = i;
+			for (auto bit = 0; bit < 8; ++bit) { crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1; }
+			table[i] = crc;
+		}
+		return table;
+	}();
+
+	uint32_t Crc32(const char* data, const size_t size) {
+		auto crc = ~uint32_t{ 0 };
+		for (auto i = size_t{ 0 }; i < size; ++i) { crc = CrcTable[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8); }
+		return ~crc;
+	}
+
+	void AppendWord(string& out, const uint32_t word) { out.append(reinterpret_cast<const char*>(&word), sizeof(word)); }
+	uint32_t ReadWord(const char* in) { auto word = uint32_t{ }; memcpy(&word, in, sizeof(word)); return word; }
+
+	string Header() {
+		auto header = string(JOURNAL::Magic, sizeof(JOURNAL::Magic));
+		AppendWord(header, JOURNAL::Version);
+		AppendWord(header, 0);
+		return header;
+	}
+}
+
+JOURNAL::JOURNAL(CELL::CELL_DATA& sheet, const string& workbookPath, const chrono::milliseconds groupWindow, const size_t compactAt)
+	: sheet{ &sheet }, workbookPath{ workbookPath }, journalPath{ PathFor(workbookPath) }, groupWindow{ groupWindow }, compactAt{ compactAt } {
+	if (sheet.data.journal) { throw logic_error("The sheet is already journalled."); }
+	if (filesystem::exists(workbookPath)) { WORKBOOK_FILE::Open(sheet, workbookPath); }
+	else if (sheet.CellCount() != 0 || sheet.HasImage()) { throw logic_error("A journal can only recover an empty sheet."); }
+	auto valid = filesystem::exists(journalPath) ? Replay(sheet, journalPath) : 0;
+
+	file = SYNCED_FILE{ journalPath };
+	auto header = Header();
+	auto ready = valid != 0 ? file.Resize(valid) : file.Resize(0) && file.Write(header.data(), header.size());		// Cut any torn frame
+	if (!ready || !file.Sync()) { throw runtime_error("Could not write " + journalPath); }
+	size = max(valid, HeaderSize);
+	nextCompaction = compactAt;
+	sheet.data.journal = this;
+	flusher = thread{ &JOURNAL::Flusher, this };
+}
+
+JOURNAL::~JOURNAL() {
+	sheet->data.journal = nullptr;
+	Commit();
+	{
+		auto lock = lock_guard<mutex>{ lk };
+		stopping = true;
+	}
+	wake.notify_all();
+	flusher.join();			// Writes whatever is still queued first
+	if (compactor.joinable()) { compactor.join(); }
+}
+
+void JOURNAL::Append(const CELL::CELL_POSITION pos, const string_view contents) {
+	AppendWord(pending, WORKBOOK_FILE::Pack(pos));
+	AppendWord(pending, static_cast<uint32_t>(contents.size()));
+	pending.append(contents);
+}
+
+void JOURNAL::Commit() {
+	if (pending.empty()) { return; }
+	auto frame = string{ };
+	frame.reserve(FrameHeaderSize + pending.size());
+	AppendWord(frame, static_cast<uint32_t>(pending.size()));
+	AppendWord(frame, Crc32(pending.data(), pending.size()));
+	frame += pending;
+	pending.clear();
+
+	auto lock = unique_lock<mutex>{ lk };
+	queued += frame;
+	auto ticket = ++committed;
+	wake.notify_one();
+	if (groupWindow.count() == 0) { synced.wait(lock, [this, ticket] { return durable >= ticket || failed; }); }
+}
+
+// Each pass writes every frame queued so far & syncs once. In the meantime, further frames queue up for the next pass.
+void JOURNAL::Flusher() {
+	auto lock = unique_lock<mutex>{ lk };
+	while (true) {
+		wake.wait(lock, [this] { return stopping || !queued.empty(); });
+		if (queued.empty()) { return; }
+		auto frames = exchange(queued, { });
+		auto upTo = committed;
+		lock.unlock();
+		{
+			auto fileLock = lock_guard<mutex>{ lkFile };		// Compaction may be swapping the file
+			auto written = file.Write(frames.data(), frames.size()) && file.Sync();
+			lock.lock();
+			failed = failed || !written;
+			size += frames.size();
+		}
+		durable = upTo;
+		++syncs;
+		synced.notify_all();
+
+		if (!failed && !compacting && size >= nextCompaction) {
+			compacting = true;
+			auto compactUpTo = size;
+			lock.unlock();
+			if (compactor.joinable()) { compactor.join(); }		// Finished, but not yet joined
+			compactor = thread{ &JOURNAL::Compact, this, compactUpTo };
+			lock.lock();
+		}
+		if (groupWindow.count() != 0) { wake.wait_for(lock, groupWindow, [this] { return stopping; }); }
+	}
+}
+
+// Writing the new workbook is the slow part, and touches neither the journal nor the sheet, so frames keep being written meanwhile.
+// Only the frames written since are then carried over into a fresh journal. Should those alone outgrow it, it is compacted
+// again straight away, since no later write may come along to start another compaction.
+void JOURNAL::Compact(size_t upTo) {
+	for (auto again = true; again;) {
+		auto done = false;
+		auto error = string{ };
+		try {
+			auto hidden = CELL::CELL_DATA{ };
+			hidden.data.shown = false;
+			if (filesystem::exists(workbookPath)) { WORKBOOK_FILE::Open(hidden, workbookPath); }
+			Replay(hidden, journalPath, upTo);
+			WORKBOOK_FILE::Save(hidden, workbookPath);
+
+			auto fileLock = lock_guard<mutex>{ lkFile };
+			auto in = ifstream{ journalPath, ios::binary };
+			in.seekg(static_cast<streamoff>(upTo));
+			auto contents = Header() + string{ istreambuf_iterator<char>{ in }, istreambuf_iterator<char>{ } };
+			SYNCED_FILE::Replace(journalPath, ".compacting", [&contents](SYNCED_FILE& out) { return out.Write(contents.data(), contents.size()); });
+			auto reopened = SYNCED_FILE{ journalPath };
+			if (!reopened.Resize(contents.size())) { throw runtime_error("Could not reopen " + journalPath); }
+			file = std::move(reopened);
+			auto lock = lock_guard<mutex>{ lk };
+			size = contents.size();
+			done = true;
+		}
+		// The journal still covers the workbook, so nothing is lost. Try again once it has grown as much again.
+		catch (const exception& e) { error = e.what(); }
+		catch (...) { error = "Could not compact " + journalPath; }
+
+		auto lock = lock_guard<mutex>{ lk };
+		nextCompaction = done ? compactAt : size + compactAt;
+		compactions += done;
+		if (!done) { ++compactionFailures; compactionError = std::move(error); }
+		again = done && !failed && !stopping && size >= nextCompaction && size > HeaderSize;
+		upTo = size;
+		compacting = again;
+		if (!again) { compacted.notify_all(); }
+	}
+}
+
+// Records are coalesced by position, keeping the last, and entered in position order.
+size_t JOURNAL::Replay(CELL::CELL_DATA& sheet, const string& journalPath, const size_t upTo) {
+	auto in = ifstream{ journalPath, ios::binary };
+	if (!in) { throw runtime_error("Could not open " + journalPath); }
+	auto bytes = string{ istreambuf_iterator<char>{ in }, istreambuf_iterator<char>{ } };
+	if (bytes.size() > upTo) { bytes.resize(upTo); }
+	if (bytes.size() < HeaderSize) { return 0; }		// Cut short while being created
+	if (memcmp(bytes.data(), Magic, sizeof(Magic)) != 0) { throw runtime_error(journalPath + " is not a journal."); }
+	if (ReadWord(bytes.data() + sizeof(Magic)) > Version) { throw runtime_error(journalPath + " is from a newer version."); }
+
+	auto records = vector<pair<uint32_t, string_view>>{ };
+	auto valid = HeaderSize;
+	while (bytes.size() - valid >= FrameHeaderSize) {
+		auto length = size_t{ ReadWord(bytes.data() + valid) };
+		auto payload = bytes.data() + valid + FrameHeaderSize;
+		if (length > bytes.size() - valid - FrameHeaderSize || Crc32(payload, length) != ReadWord(bytes.data() + valid + 4)) { break; }
+		auto frameRecords = vector<pair<uint32_t, string_view>>{ };
+		auto i = size_t{ 0 };
+		while (length - i >= RecordHeaderSize && ReadWord(payload + i + 4) <= length - i - RecordHeaderSize) {
+			frameRecords.emplace_back(ReadWord(payload + i), string_view{ payload + i + RecordHeaderSize, ReadWord(payload + i + 4) });
+			i += RecordHeaderSize + frameRecords.back().second.size();
+		}
+		if (i != length) { break; }
+		records.insert(records.end(), frameRecords.begin(), frameRecords.end());
+		valid += FrameHeaderSize + length;
+	}
+
+	stable_sort(records.begin(), records.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	auto batch = CELL::BATCH{ &sheet };
+	for (auto i = size_t{ 0 }; i < records.size(); ++i) {
+		if (i + 1 < records.size() && records[i + 1].first == records[i].first) { continue; }		// Overwritten later
+		CELL::NewCell(&sheet, WORKBOOK_FILE::Unpack(records[i].first), string{ records[i].second });
+	}
+	batch.Commit();
+	return valid;
+}
+
+void JOURNAL::Flush() {
+	auto lock = unique_lock<mutex>{ lk };
+	auto upTo = committed;
+	synced.wait(lock, [this, upTo] { return durable >= upTo || failed; });
+	if (failed) { throw runtime_error("Could not write " + journalPath); }
+}
+
+void JOURNAL::WaitForCompaction() {
+	auto lock = unique_lock<mutex>{ lk };
+	compacted.wait(lock, [this] { return !compacting; });
+}
+
+bool JOURNAL::Failed() const { auto lock = lock_guard<mutex>{ lk }; return failed; }
+size_t JOURNAL::Size() const { auto lock = lock_guard<mutex>{ lk }; return size; }
+size_t JOURNAL::SyncCount() const { auto lock = lock_guard<mutex>{ lk }; return syncs; }
+size_t JOURNAL::CompactionCount() const { auto lock = lock_guard<mutex>{ lk }; return compactions; }
+size_t JOURNAL::CompactionFailures() const { auto lock = lock_guard<mutex>{ lk }; return compactionFailures; }
+string JOURNAL::CompactionError() const { auto lock = lock_guard<mutex>{ lk }; return compactionError; }
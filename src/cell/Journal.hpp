@@ -0,0 +1,92 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the edit journal kept beside a workbook file, so that no edit is lost to a crash
+// without saving the whole sheet after every change.
+// Every cell placed or erased is appended to the journal as (position, raw content). An empty content erases.
+// The records of one change (an edit, an undo, a batch) are written together as one frame, checked by length & CRC-32,
+// so a frame torn by a crash is dropped whole on recovery and the journal is cut back to the last whole frame.
+// Frames are written & synced to disk by a background thread. Frames committed while a sync is under way share the next one
+// (group commit), so a burst of changes costs one sync rather than one each.
+// Recovering opens the workbook (see Workbook_File.hpp) and enters the last content recorded at each position in one BATCH,
+// so every affected cell is recalculated once, whatever the length of the journal.
+// Replaying a record that the workbook already holds changes nothing, so the journal only ever needs to cover the workbook.
+// Once the journal passes a size threshold, it is compacted in the background: a second, hidden sheet opens the workbook,
+// replays the journal up to that point & saves over the workbook, and only then is that part dropped from the journal.
+// A crash at any point of compaction leaves a workbook & journal that recover to the same sheet.
+// A compaction that fails (the disk is full, say) is counted & its error kept, and the journal simply grows until the next attempt.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef JOURNAL_CLASS_HPP
+#define JOURNAL_CLASS_HPP
+
+#include "Cell.hpp"
+#include "Synced_File.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+class JOURNAL {
+public:
+	static constexpr std::uint32_t Version{ 1 };
+	static constexpr char Magic[8]{ 'S', 'H', 'E', 'E', 'T', 'L', 'O', 'G' };
+	static constexpr std::size_t HeaderSize{ 16 };						// Magic, version & a reserved word
+	static constexpr std::size_t DefaultCompactAt{ 16 << 20 };
+
+	static std::string PathFor(const std::string& workbookPath) { return workbookPath + ".journal"; }
+
+	// Recover an empty sheet from the workbook at the path (if any) and its journal (if any), then record every later change.
+	// With no group window, each change waits until it is on disk. Otherwise changes return at once & are synced together,
+	// at most one window apart, so a crash may lose the changes of the last window.
+	// Should a write or sync fail, the change still returns, but Failed() says so and the sheet refuses every later edit.
+	// Throws std::logic_error if the sheet is not empty or already journalled, and std::runtime_error as WORKBOOK_FILE::Open does
+	// or if the journal cannot be read or written. The sheet must outlive the journal.
+	// Do not save the sheet over the same workbook while it is journalled. Compaction keeps the workbook up to date.
+	JOURNAL(CELL::CELL_DATA&, const std::string& workbookPath, const std::chrono::milliseconds groupWindow = std::chrono::milliseconds{ 0 },
+		const std::size_t compactAt = DefaultCompactAt);
+	~JOURNAL();		// Syncs every committed change & waits for any compaction. Call from the sheet's writer thread.
+	JOURNAL(const JOURNAL&) = delete;
+	JOURNAL& operator=(const JOURNAL&) = delete;
+
+	void Flush();					// Wait until every committed change is on disk. Throws std::runtime_error if the journal could not be written.
+	bool Failed() const;			// A write or sync failed. Changes since may not be on disk, so the sheet refuses further edits (see CELL::NewCell).
+	void WaitForCompaction();		// Wait for a compaction under way, if any.
+	std::size_t Size() const;						// Bytes in the journal file.
+	std::size_t SyncCount() const;					// Syncs so far. Each covers every frame committed before it.
+	std::size_t CompactionCount() const;			// Compactions completed so far.
+	std::size_t CompactionFailures() const;			// Compactions that failed so far. Each leaves the journal as it was, to be compacted later.
+	std::string CompactionError() const;			// Why the last failed compaction failed, if any did.
+private:
+	CELL::CELL_DATA* sheet;
+	std::string workbookPath, journalPath;
+	std::chrono::milliseconds groupWindow;
+	std::size_t compactAt;
+	std::string pending;							// Records of the change under way. Writer thread only.
+
+	mutable std::mutex lk;							// Guards everything below but the file, which lkFile guards
+	std::mutex lkFile;
+	std::condition_variable wake, synced, compacted;
+	std::string queued;								// Committed frames not yet written
+	std::uint64_t committed{ 0 }, durable{ 0 };		// Frames committed & frames on disk
+	std::size_t size{ 0 }, nextCompaction{ 0 }, syncs{ 0 }, compactions{ 0 }, compactionFailures{ 0 };
+	std::string compactionError;
+	bool stopping{ false }, failed{ false }, compacting{ false };
+	SYNCED_FILE file;
+	std::thread flusher, compactor;
+
+	void Append(const CELL::CELL_POSITION, const std::string_view contents);	// Record a cell placed or erased.
+	void Commit();																// End the change under way.
+	void Flusher();
+	void Compact(std::size_t upTo);
+
+	// Enter the last content recorded at each position in the first upTo bytes of the journal. Returns the length of its whole frames.
+	static std::size_t Replay(CELL::CELL_DATA&, const std::string& journalPath, const std::size_t upTo = std::numeric_limits<std::size_t>::max());
+
+	friend class CELL::CELL_DATA;
+};
+
+#endif // !JOURNAL_CLASS_HPP
@@ -0,0 +1,52 @@
+#include "Mapped_File.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+MAPPED_FILE::MAPPED_FILE(const string& path) {
+	// Shared for deletion too, so that a new copy of the file may be renamed over it while it is mapped (see Synced_File.hpp).
+	auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) { throw runtime_error("Could not open " + path); }
+	auto length = LARGE_INTEGER{ };
+	if (!GetFileSizeEx(file, &length)) { CloseHandle(file); throw runtime_error("Could not read the size of " + path); }
+	size = static_cast<size_t>(length.QuadPart);
+	if (size == 0) { CloseHandle(file); return; }		// Empty files cannot be mapped
+	handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);									// The mapping keeps the file open
+	if (!handle) { throw runtime_error("Could not map " + path); }
+	data = static_cast<const byte*>(MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0));
+	if (!data) { CloseHandle(handle); throw runtime_error("Could not map " + path); }
+}
+
+MAPPED_FILE::~MAPPED_FILE() {
+	if (data) { UnmapViewOfFile(data); }
+	if (handle) { CloseHandle(handle); }
+}
+#else
+MAPPED_FILE::MAPPED_FILE(const string& path) {
+	auto file = open(path.c_str(), O_RDONLY);
+	if (file < 0) { throw runtime_error("Could not open " + path); }
+	struct stat status { };
+	if (fstat(file, &status) != 0) { close(file); throw runtime_error("Could not read the size of " + path); }
+	size = static_cast<size_t>(status.st_size);
+	if (size == 0) { close(file); return; }				// Empty files cannot be mapped
+	auto mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);										// The mapping keeps the file open
+	if (mapped == MAP_FAILED) { throw runtime_error("Could not map " + path); }
+	data = static_cast<const byte*>(mapped);
+}
+
+MAPPED_FILE::~MAPPED_FILE() { if (data) { munmap(const_cast<byte*>(data), size); } }
+#endif
@@ -0,0 +1,29 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining a read-only, memory-mapped view of a whole file.
+// Pages are only read from disk as they are touched, so opening a large file costs nothing up front
+// and the operating system may share or drop the pages as it sees fit.
+// The file stays mapped until the MAPPED_FILE is destroyed. Meanwhile it may be replaced (or deleted) on disk, as when a sheet
+// is saved over the workbook it was opened from: the mapping goes on showing the contents it was made from.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_CLASS_HPP
+#define MAPPED_FILE_CLASS_HPP
+
+#include <cstddef>
+#include <string>
+
+class MAPPED_FILE {
+	const std::byte* data{ nullptr };
+	std::size_t size{ 0 };
+	void* handle{ nullptr };			// Mapping object on Windows. Unused elsewhere.
+public:
+	explicit MAPPED_FILE(const std::string& path);		// Throws std::runtime_error if the file cannot be opened or mapped.
+	~MAPPED_FILE();
+	MAPPED_FILE(const MAPPED_FILE&) = delete;
+	MAPPED_FILE& operator=(const MAPPED_FILE&) = delete;
+
+	const std::byte* Data() const { return data; }
+	std::size_t Size() const { return size; }
+};
+
+#endif // !MAPPED_FILE_CLASS_HPP
@@ -0,0 +1,33 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining an allocator which hands out memory from a shared memory resource (see <memory_resource>).
+// Each sheet owns a pool resource, with a size class for each kind of cell, so that filling a sheet takes a chunk
+// of memory at a time rather than one block per cell, and emptying it hands whole chunks back at once.
+// Unlike std::pmr::polymorphic_allocator, the allocator shares ownership of its resource: objects made through
+// std::allocate_shared keep a copy of it, so a cell (or snapshot entry) outliving its sheet still has somewhere to go back to.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef POOL_ALLOCATOR_CLASS_HPP
+#define POOL_ALLOCATOR_CLASS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+template <typename T>
+class POOL_ALLOCATOR {
+	std::shared_ptr<std::pmr::memory_resource> resource;
+public:
+	using value_type = T;
+
+	explicit POOL_ALLOCATOR(std::shared_ptr<std::pmr::memory_resource> resource) noexcept : resource{ std::move(resource) } { }
+	template <typename U> POOL_ALLOCATOR(const POOL_ALLOCATOR<U>& other) noexcept : resource{ other.Resource() } { }
+
+	T* allocate(const std::size_t n) { return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T* p, const std::size_t n) noexcept { resource->deallocate(p, n * sizeof(T), alignof(T)); }
+	const std::shared_ptr<std::pmr::memory_resource>& Resource() const noexcept { return resource; }
+
+	template <typename U> friend bool operator== (const POOL_ALLOCATOR& lhs, const POOL_ALLOCATOR<U>& rhs) noexcept { return lhs.resource == rhs.Resource(); }
+};
+
+#endif // !POOL_ALLOCATOR_CLASS_HPP
@@ -0,0 +1,196 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the compact set of cell positions used for dependency edges.
+// Positions are packed into 32 bits (column in the high half, row in the low half), as in CELL_HASH.
+// Most cells have only a handful of observers & subjects, while a few are read by very many cells. So the set changes form with size:
+//		Up to 2 positions are held inline in the set itself, with no allocation.
+//		Up to 16 positions are held in a small heap array and searched linearly.
+//		Beyond that, positions are held in an open-addressed hash table (linear probing, backward-shift deletion).
+// Iteration order is unspecified. Iteration walks the storage directly, so nothing is copied.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef POSITION_SET_CLASS_HPP
+#define POSITION_SET_CLASS_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+// POSITION is any type with "column" and "row" members below 2^16.
+template <typename POSITION>
+class POSITION_SET {
+	static constexpr std::uint32_t InlineCapacity{ 2 };
+	static constexpr std::uint32_t LinearCapacity{ 16 };
+	static constexpr std::uint32_t Empty{ UINT32_MAX };			// Marks a free hash slot. The position it packs is tracked by the slot past the end.
+
+	std::uint32_t used{ 0 };						// Number of positions held
+	std::uint32_t capacity{ InlineCapacity };
+	union {
+		std::uint32_t local[InlineCapacity];
+		std::uint32_t* heap;
+	};
+
+	static std::uint32_t Pack(const POSITION& pos) { return (static_cast<std::uint32_t>(pos.column) << 16) | static_cast<std::uint32_t>(pos.row); }
+	static POSITION Unpack(const std::uint32_t key) { auto pos = POSITION{ }; pos.column = key >> 16; pos.row = key & 0xFFFF; return pos; }
+
+	bool Hashed() const { return capacity > LinearCapacity; }
+	std::uint32_t* Slots() { return capacity == InlineCapacity ? local : heap; }
+	const std::uint32_t* Slots() const { return capacity == InlineCapacity ? local : heap; }
+	std::uint32_t Home(const std::uint32_t key) const { return (key * 0x9E3779B1u) >> (32 - std::countr_zero(capacity)); }
+
+	// Slot holding the key, or the free slot where it would go.
+	std::uint32_t Probe(const std::uint32_t key) const {
+		auto slots = heap;
+		auto i = Home(key);
+		while (slots[i] != Empty && slots[i] != key) { i = (i + 1) & (capacity - 1); }
+		return i;
+	}
+
+	void Release() { if (capacity != InlineCapacity) { delete[] heap; } }
+
+	// Move every key into fresh storage of the given capacity.
+	void Rebuild(const std::uint32_t newCapacity) {
+		auto oldSlots = Slots();
+		auto oldCapacity = capacity;
+		auto oldHashed = Hashed();
+		auto oldCount = used;
+		auto keys = std::uint32_t{ 0 };
+		auto buffer = new std::uint32_t[newCapacity + 1];
+		capacity = newCapacity;
+		used = 0;
+		auto place = [this, buffer, &keys](const std::uint32_t key) {
+			if (Hashed()) { HashInsert(buffer, key); }
+			else { buffer[keys++] = key; }
+			++used;
+		};
+		if (Hashed()) { std::fill(buffer, buffer + newCapacity + 1, Empty); buffer[newCapacity] = 0; }
+		if (oldHashed) {
+			for (auto i = std::uint32_t{ 0 }; i < oldCapacity; ++i) { if (oldSlots[i] != Empty) { place(oldSlots[i]); } }
+			if (oldSlots[oldCapacity]) { place(Empty); }
+		}
+		else { for (auto i = std::uint32_t{ 0 }; i < oldCount; ++i) { place(oldSlots[i]); } }
+		if (oldCapacity != InlineCapacity) { delete[] oldSlots; }
+		heap = buffer;
+	}
+
+	void HashInsert(std::uint32_t* slots, const std::uint32_t key) {
+		if (key == Empty) { slots[capacity] = 1; return; }
+		auto i = Home(key);
+		while (slots[i] != Empty) { i = (i + 1) & (capacity - 1); }
+		slots[i] = key;
+	}
+
+	// Close the gap left at a hash slot by shifting back any later keys in the same probe run.
+	void HashErase(std::uint32_t hole) {
+		auto slots = heap;
+		for (auto i = (hole + 1) & (capacity - 1); slots[i] != Empty; i = (i + 1) & (capacity - 1)) {
+			auto home = Home(slots[i]);
+			if (((i - home) & (capacity - 1)) < ((i - hole) & (capacity - 1))) { continue; }		// Key already sits between its home and the hole
+			slots[hole] = slots[i];
+			hole = i;
+		}
+		slots[hole] = Empty;
+	}
+
+public:
+	class iterator {
+		const std::uint32_t* slots;
+		std::uint32_t index, end;
+		bool hashed;
+		void Skip() { while (hashed && index < end - 1 && slots[index] == Empty) { ++index; } if (hashed && index == end - 1 && !slots[index]) { ++index; } }
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = POSITION;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = POSITION;
+
+		iterator(const std::uint32_t* slots, const std::uint32_t index, const std::uint32_t end, const bool hashed) : slots(slots), index(index), end(end), hashed(hashed) { Skip(); }
+		POSITION operator*() const { return Unpack(hashed && index == end - 1 ? Empty : slots[index]); }
+		iterator& operator++() { ++index; Skip(); return *this; }
+		iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+		bool operator==(const iterator& other) const { return index == other.index; }
+	};
+
+	POSITION_SET() { }
+	POSITION_SET(const POSITION_SET& other) : used(other.used), capacity(other.capacity) {
+		if (capacity == InlineCapacity) { std::memcpy(local, other.local, sizeof(local)); return; }
+		heap = new std::uint32_t[capacity + 1];
+		std::memcpy(heap, other.heap, (capacity + 1) * sizeof(std::uint32_t));
+	}
+	POSITION_SET(POSITION_SET&& other) noexcept : used(other.used), capacity(other.capacity) {
+		if (capacity == InlineCapacity) { std::memcpy(local, other.local, sizeof(local)); }
+		else { heap = other.heap; }
+		other.used = 0;
+		other.capacity = InlineCapacity;
+	}
+	POSITION_SET& operator=(POSITION_SET other) noexcept {
+		Release();
+		used = other.used;
+		capacity = other.capacity;
+		if (capacity == InlineCapacity) { std::memcpy(local, other.local, sizeof(local)); }
+		else { heap = other.heap; }
+		other.used = 0;
+		other.capacity = InlineCapacity;
+		return *this;
+	}
+	~POSITION_SET() { Release(); }
+
+	std::size_t size() const { return used; }
+	bool empty() const { return used == 0; }
+
+	bool contains(const POSITION& pos) const {
+		auto key = Pack(pos);
+		if (!Hashed()) { auto slots = Slots(); return std::find(slots, slots + used, key) != slots + used; }
+		if (key == Empty) { return heap[capacity] != 0; }
+		return heap[Probe(key)] == key;
+	}
+
+	// True if the position was not already present.
+	bool insert(const POSITION& pos) {
+		if (contains(pos)) { return false; }
+		auto key = Pack(pos);
+		if (!Hashed()) {
+			if (used == capacity) { Rebuild(capacity == LinearCapacity ? LinearCapacity * 4 : capacity * 2); }
+			if (!Hashed()) { Slots()[used++] = key; return true; }
+		}
+		else if ((used + 1) * 4 > capacity * 3) { Rebuild(capacity * 2); }
+		HashInsert(heap, key);
+		++used;
+		return true;
+	}
+
+	// Number of positions removed (0 or 1). The set returns to inline storage once emptied.
+	std::size_t erase(const POSITION& pos) {
+		auto key = Pack(pos);
+		if (!Hashed()) {
+			auto slots = Slots();
+			auto it = std::find(slots, slots + used, key);
+			if (it == slots + used) { return 0; }
+			*it = slots[--used];
+		}
+		else if (key == Empty) {
+			if (!heap[capacity]) { return 0; }
+			heap[capacity] = 0;
+			--used;
+		}
+		else {
+			auto i = Probe(key);
+			if (heap[i] != key) { return 0; }
+			HashErase(i);
+			--used;
+		}
+		if (used == 0 && capacity != InlineCapacity) { Release(); capacity = InlineCapacity; }
+		return 1;
+	}
+
+	iterator begin() const { return iterator{ Slots(), 0, Hashed() ? capacity + 1 : used, Hashed() }; }
+	iterator end() const { return iterator{ Slots(), Hashed() ? capacity + 1 : used, Hashed() ? capacity + 1 : used, Hashed() }; }
+
+	// Bytes held outside of the set object itself.
+	std::size_t HeapUsage() const { return capacity == InlineCapacity ? 0 : (capacity + 1) * sizeof(std::uint32_t); }
+};
+
+#endif // !POSITION_SET_CLASS_HPP
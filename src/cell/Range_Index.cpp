@@ -0,0 +1,82 @@
+#include "Range_Index.hpp"
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+// Ordered by first row, so each subtree to the right of a node starts on the same row or further down.
+bool RANGE_INDEX::Less(const ENTRY& lhs, const ENTRY& rhs) {
+	auto key = [](const ENTRY& e) { return tie(e.first.row, e.first.column, e.last.row, e.last.column, e.observer.column, e.observer.row); };
+	return key(lhs) < key(rhs);
+}
+
+void RANGE_INDEX::Refresh(NODE& node) {
+	node.maxLastRow = node.entry.last.row;
+	node.minFirstColumn = node.entry.first.column;
+	node.maxLastColumn = node.entry.last.column;
+	for (auto child : { node.left.get(), node.right.get() }) {
+		if (!child) { continue; }
+		node.maxLastRow = max(node.maxLastRow, child->maxLastRow);
+		node.minFirstColumn = min(node.minFirstColumn, child->minFirstColumn);
+		node.maxLastColumn = max(node.maxLastColumn, child->maxLastColumn);
+	}
+}
+
+void RANGE_INDEX::RotateLeft(unique_ptr<NODE>& node) {
+	auto pivot = std::move(node->right);
+	node->right = std::move(pivot->left);
+	Refresh(*node);
+	pivot->left = std::move(node);
+	Refresh(*pivot);
+	node = std::move(pivot);
+}
+
+void RANGE_INDEX::RotateRight(unique_ptr<NODE>& node) {
+	auto pivot = std::move(node->left);
+	node->left = std::move(pivot->right);
+	Refresh(*node);
+	pivot->right = std::move(node);
+	Refresh(*pivot);
+	node = std::move(pivot);
+}
+
+bool RANGE_INDEX::Insert(unique_ptr<NODE>& node, const ENTRY& entry, const uint32_t priority) {
+	if (!node) {
+		node = make_unique<NODE>(NODE{ entry, priority });
+		Refresh(*node);
+		return true;
+	}
+	auto goLeft = Less(entry, node->entry);
+	if (!goLeft && !Less(node->entry, entry)) { return false; }		// Already present
+	auto& child = goLeft ? node->left : node->right;
+	if (!Insert(child, entry, priority)) { return false; }
+	if (child->priority > node->priority) { goLeft ? RotateRight(node) : RotateLeft(node); }
+	else { Refresh(*node); }
+	return true;
+}
+
+// Rotate the matching node down until it has at most one child, then splice it out.
+bool RANGE_INDEX::Erase(unique_ptr<NODE>& node, const ENTRY& entry) {
+	if (!node) { return false; }
+	auto erased = false;
+	if (Less(entry, node->entry)) { erased = Erase(node->left, entry); }
+	else if (Less(node->entry, entry)) { erased = Erase(node->right, entry); }
+	else if (!node->left) { node = std::move(node->right); return true; }
+	else if (!node->right) { node = std::move(node->left); return true; }
+	else if (node->left->priority > node->right->priority) { RotateRight(node); erased = Erase(node->right, entry); }
+	else { RotateLeft(node); erased = Erase(node->left, entry); }
+	if (erased) { Refresh(*node); }
+	return erased;
+}
+
+bool RANGE_INDEX::Insert(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer) {
+	if (!Insert(root, ENTRY{ first, last, observer }, static_cast<uint32_t>(random()))) { return false; }
+	++size;
+	return true;
+}
+
+bool RANGE_INDEX::Erase(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer) {
+	if (!Erase(root, ENTRY{ first, last, observer })) { return false; }
+	--size;
+	return true;
+}
@@ -0,0 +1,77 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the spatial index of range subscriptions.
+// A formula over a block of cells registers the whole rectangle once, rather than subscribing to every cell inside it.
+// The index answers "which observers have a range covering this position" without visiting unrelated ranges.
+//
+// Entries are kept in a treap (a randomized balanced binary search tree) ordered by the first row of each rectangle,
+// which makes this an interval tree over rows. Each node also records the bounding box of its subtree:
+// the greatest last row along with the least first column and greatest last column.
+// A query descends only into subtrees whose bounding box contains the position, so the cost is logarithmic
+// in the number of ranges plus the number of ranges reported.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RANGE_INDEX_CLASS_HPP
+#define RANGE_INDEX_CLASS_HPP
+
+#include "Cell.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+// Not synchronized. Owned by DEPENDENCY_GRAPH.
+class RANGE_INDEX {
+public:
+	struct ENTRY {
+		CELL::CELL_POSITION first;			// Top left corner
+		CELL::CELL_POSITION last;			// Bottom right corner (inclusive)
+		CELL::CELL_POSITION observer;
+		bool Contains(const CELL::CELL_POSITION pos) const { return pos.column >= first.column && pos.column <= last.column && pos.row >= first.row && pos.row <= last.row; }
+	};
+
+private:
+	struct NODE {
+		ENTRY entry;
+		std::uint32_t priority{ 0 };
+		unsigned int maxLastRow{ 0 }, minFirstColumn{ 0 }, maxLastColumn{ 0 };		// Bounding box of the subtree, less its least first row (leftmost node).
+		std::unique_ptr<NODE> left{ }, right{ };
+	};
+
+	std::unique_ptr<NODE> root;
+	std::size_t size{ 0 };
+	std::minstd_rand random{ 0x5EED };
+
+	static bool Less(const ENTRY&, const ENTRY&);
+	static void Refresh(NODE&);
+	static void RotateLeft(std::unique_ptr<NODE>&);
+	static void RotateRight(std::unique_ptr<NODE>&);
+	bool Insert(std::unique_ptr<NODE>&, const ENTRY&, const std::uint32_t priority);
+	bool Erase(std::unique_ptr<NODE>&, const ENTRY&);
+
+	template <typename VISITOR> static void Query(const NODE*, const CELL::CELL_POSITION, VISITOR&);
+public:
+	RANGE_INDEX() = default;
+	RANGE_INDEX(const RANGE_INDEX&) = delete;
+	RANGE_INDEX& operator=(const RANGE_INDEX&) = delete;
+
+	// Register the rectangle from first to last (inclusive) for the observer. False if that exact entry is already present.
+	bool Insert(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer);
+	bool Erase(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, const CELL::CELL_POSITION observer);
+	std::size_t Size() const { return size; }
+
+	// Call visitor(const ENTRY&) for every registered rectangle containing the position.
+	template <typename VISITOR> void Query(const CELL::CELL_POSITION pos, VISITOR&& visitor) const { Query(root.get(), pos, visitor); }
+};
+
+template <typename VISITOR>
+void RANGE_INDEX::Query(const NODE* node, const CELL::CELL_POSITION pos, VISITOR& visitor) {
+	while (node) {
+		if (node->maxLastRow < pos.row || node->minFirstColumn > pos.column || node->maxLastColumn < pos.column) { return; }
+		Query(node->left.get(), pos, visitor);
+		if (node->entry.first.row > pos.row) { return; }		// Everything to the right starts further down
+		if (node->entry.Contains(pos)) { visitor(node->entry); }
+		node = node->right.get();
+	}
+}
+
+#endif // !RANGE_INDEX_CLASS_HPP
@@ -0,0 +1,144 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining a tiled grid of single-word slots that readers may search without taking a lock.
+// Spreadsheets tend to be dense in blocks and sparse overall, so the grid is broken into fixed-size square tiles.
+// A tile is only allocated once something is written into it and is released again once it is emptied.
+// Addressing is O(1): two array lookups in a lazily allocated directory followed by a fixed offset into the tile.
+// Slots within a tile are stored column-major to match CELL_POSITION ordering, so column scans are contiguous.
+// A slot owns nothing: it is one atomic word, written by writers and loaded by readers,
+// so a slot costs 8 bytes whatever it holds. Whatever a word refers to is kept alive (and retired) by the caller.
+// Writers must be serialized by the caller. Readers must hold an EPOCH::GUARD while they use what they find:
+// released tiles are retired through EPOCH rather than destroyed in place.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SLOT_GRID_CLASS_HPP
+#define SLOT_GRID_CLASS_HPP
+
+#include "Epoch.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// T is the slot type: trivially copyable, one word, testable as bool and empty when value-initialized.
+// POSITION is any type with "column" and "row" members.
+template <typename T, typename POSITION>
+class SLOT_GRID {
+public:
+	static constexpr auto TileBits{ 6u };
+	static constexpr auto TileSize{ 1u << TileBits };					// 64 x 64 cells per tile
+	static constexpr auto TileArea{ TileSize * TileSize };
+	static constexpr auto Extent{ 1u << 16 };							// Positions 0 through UINT16_MAX in either direction
+	static constexpr auto DirectorySize{ Extent / TileSize };
+	static_assert(std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free);
+
+private:
+	struct TILE {
+		std::array<std::atomic<T>, TileArea> slots{ };
+		unsigned int count{ 0 };		// Number of occupied slots; tile is released when this reaches zero.
+	};
+	using TILE_COLUMN = std::array<std::atomic<TILE*>, DirectorySize>;
+
+	std::array<std::atomic<TILE_COLUMN*>, DirectorySize> directory{ };
+	std::size_t size{ 0 };
+
+	static bool InBounds(const POSITION& pos) { return pos.column < Extent && pos.row < Extent; }
+	static unsigned int SlotIndex(const POSITION& pos) { return ((pos.column & (TileSize - 1)) << TileBits) | (pos.row & (TileSize - 1)); }
+
+	TILE* FindTile(const POSITION& pos) const {
+		if (!InBounds(pos)) { return nullptr; }
+		auto tileColumn = directory[pos.column >> TileBits].load(std::memory_order_acquire);
+		return tileColumn ? (*tileColumn)[pos.row >> TileBits].load(std::memory_order_acquire) : nullptr;
+	}
+
+	// Writers only. New tiles are fully built before they are published.
+	TILE& MakeTile(const POSITION& pos) {
+		if (!InBounds(pos)) { throw std::out_of_range("Cell position is outside of the grid."); }
+		auto& columnSlot = directory[pos.column >> TileBits];
+		auto tileColumn = columnSlot.load(std::memory_order_relaxed);
+		if (!tileColumn) { tileColumn = new TILE_COLUMN{ }; columnSlot.store(tileColumn, std::memory_order_release); }
+		auto& tileSlot = (*tileColumn)[pos.row >> TileBits];
+		auto tile = tileSlot.load(std::memory_order_relaxed);
+		if (!tile) { tile = new TILE{ }; tileSlot.store(tile, std::memory_order_release); }
+		return *tile;
+	}
+
+	// Unpublish an emptied tile. Readers may still be walking it, so it is retired rather than deleted.
+	void Release(const POSITION& pos, TILE& tile) {
+		--size;
+		if (--tile.count != 0) { return; }
+		auto& tileSlot = (*directory[pos.column >> TileBits].load(std::memory_order_relaxed))[pos.row >> TileBits];
+		tileSlot.store(nullptr, std::memory_order_release);
+		EPOCH::Retire(std::shared_ptr<const TILE>(&tile));
+	}
+
+public:
+	SLOT_GRID() = default;
+	SLOT_GRID(const SLOT_GRID&) = delete;
+	SLOT_GRID& operator=(const SLOT_GRID&) = delete;
+	~SLOT_GRID() {
+		for (auto& columnSlot : directory) {
+			auto tileColumn = columnSlot.load(std::memory_order_relaxed);
+			if (!tileColumn) { continue; }
+			for (auto& tileSlot : *tileColumn) { delete tileSlot.load(std::memory_order_relaxed); }
+			delete tileColumn;
+		}
+	}
+
+	// Readers (under an EPOCH::GUARD). Empty if nothing is stored.
+	T Find(const POSITION& pos) const {
+		auto tile = FindTile(pos);
+		return tile ? tile->slots[SlotIndex(pos)].load(std::memory_order_acquire) : T{ };
+	}
+
+	// Writers. The word replaced is handed back, for the caller to release once no reader can be using it.
+	T Assign(const POSITION& pos, const T value) {
+		if (!value) { return Erase(pos); }
+		auto& tile = MakeTile(pos);
+		auto old = tile.slots[SlotIndex(pos)].exchange(value, std::memory_order_acq_rel);
+		if (!old) { ++tile.count; ++size; }
+		return old;
+	}
+
+	T Erase(const POSITION& pos) {
+		auto tile = FindTile(pos);
+		if (!tile) { return T{ }; }
+		auto old = tile->slots[SlotIndex(pos)].exchange(T{ }, std::memory_order_acq_rel);
+		if (old) { Release(pos, *tile); }
+		return old;
+	}
+
+	std::size_t Size() const { return size; }
+
+	// Readers (under an EPOCH::GUARD). Visit every occupied slot inside the rectangle from first to last (inclusive),
+	// column by column, skipping tiles that were never written.
+	template <typename VISITOR>
+	void ForEachIn(const POSITION& first, const POSITION& last, VISITOR&& visitor) const {
+		if (first.column >= Extent || first.row >= Extent) { return; }
+		auto lastColumn = last.column < Extent ? last.column : Extent - 1;
+		auto lastRow = last.row < Extent ? last.row : Extent - 1;
+		for (auto column = first.column; column <= lastColumn; ++column) {
+			auto tileColumn = directory[column >> TileBits].load(std::memory_order_acquire);
+			if (!tileColumn) { column |= TileSize - 1; continue; }		// Skip to the last column of this tile
+			for (auto row = first.row; row <= lastRow; ) {
+				auto tile = (*tileColumn)[row >> TileBits].load(std::memory_order_acquire);
+				auto tileEnd = (row | (TileSize - 1)) < lastRow ? (row | (TileSize - 1)) : lastRow;
+				if (tile) {
+					auto base = (column & (TileSize - 1)) << TileBits;
+					for (auto r = row; r <= tileEnd; ++r) {
+						auto slot = tile->slots[base | (r & (TileSize - 1))].load(std::memory_order_acquire);
+						if (!slot) { continue; }
+						auto pos = POSITION{ };
+						pos.column = column;
+						pos.row = r;
+						visitor(pos, slot);
+					}
+				}
+				row = tileEnd + 1;
+			}
+		}
+	}
+};
+
+#endif // !SLOT_GRID_CLASS_HPP
@@ -0,0 +1,97 @@
+#include "Snapshot.hpp"
+#include <string_view>
+#include <utility>
+
+using namespace std;
+
+SHEET_SNAPSHOT::ENTRY::ENTRY(const CELL::CELL_POSITION pos, const double number) : position{ pos }, shown{ SHOWN::NUMBER }, number{ number } { }
+
+// Text shown is compared with the contents as TEXT_CELL shows them, without a leading '.
+SHEET_SNAPSHOT::ENTRY::ENTRY(const CELL::CELL_POSITION pos, STRING_POOL::TEXT contents, CELL::CELL_VALUE value, STRING_POOL* pool) : position{ pos }, contents{ std::move(contents) } {
+	if (auto shownNumber = get_if<double>(&value)) { shown = SHOWN::NUMBER; number = *shownNumber; }
+	else if (auto errorCode = get_if<CELL::CELL_ERROR>(&value)) { shown = SHOWN::ERROR; error = *errorCode; }
+	else if (auto shownText = get_if<string>(&value)) {
+		auto written = this->contents ? string_view{ *this->contents } : string_view{ };
+		if (written.starts_with('\'')) { written.remove_prefix(1); }
+		if (*shownText == written && this->contents) { shown = SHOWN::CONTENTS; }
+		else { shown = SHOWN::TEXT; text = pool ? pool->Share(*shownText) : make_shared<const string>(std::move(*shownText)); }
+	}
+}
+
+CELL::CELL_VALUE SHEET_SNAPSHOT::ENTRY::Value() const {
+	switch (shown) {
+	case SHOWN::NUMBER: { return number; }
+	case SHOWN::CONTENTS: { return contents->substr(contents->starts_with('\'') ? 1 : 0); }
+	case SHOWN::TEXT: { return *text; }
+	case SHOWN::ERROR: { return error; }
+	default: { return CELL::CELL_VALUE{ }; }
+	}
+}
+
+string SHEET_SNAPSHOT::ENTRY::RawContent() const { return contents ? *contents : CELL::NumberContent(number); }
+
+// Text is compared by handle first, since entries for the same contents usually share it.
+bool operator== (const SHEET_SNAPSHOT::ENTRY& lhs, const SHEET_SNAPSHOT::ENTRY& rhs) {
+	auto same = [](const STRING_POOL::TEXT& a, const STRING_POOL::TEXT& b) { return a == b || (a && b && *a == *b); };
+	return lhs.position == rhs.position && lhs.shown == rhs.shown && lhs.error == rhs.error && lhs.number == rhs.number
+		&& same(lhs.contents, rhs.contents) && same(lhs.text, rhs.text);
+}
+
+shared_ptr<SHEET_SNAPSHOT::NODE> SHEET_SNAPSHOT::Editable(const shared_ptr<NODE>& node, const uint64_t edit) {
+	if (node && node->edit == edit) { return node; }
+	auto copy = node ? make_shared<NODE>(*node) : make_shared<NODE>();
+	copy->edit = edit;
+	return copy;
+}
+
+// Returns the replacement for the node (null once empty), or the node itself if nothing changed.
+shared_ptr<SHEET_SNAPSHOT::NODE> SHEET_SNAPSHOT::Assign(const shared_ptr<NODE>& node, const unsigned int shift, const uint32_t key, const shared_ptr<const ENTRY>& entry) {
+	if (!node && !entry) { return node; }
+	auto bit = uint32_t{ 1 } << ((key >> shift) & ((1u << Bits) - 1));
+	auto present = node && (node->bitmap & bit);
+	auto index = node ? popcount(node->bitmap & (bit - 1)) : 0;
+
+	if (shift == 0) {
+		if (!entry && !present) { return node; }
+		auto copy = Editable(node, version);
+		if (entry && present) { copy->entries[index] = entry; return copy; }
+		if (entry) { copy->entries.insert(copy->entries.begin() + index, entry); copy->bitmap |= bit; ++size; }
+		else { copy->entries.erase(copy->entries.begin() + index); copy->bitmap &= ~bit; --size; }
+		return copy->bitmap ? copy : nullptr;
+	}
+
+	auto child = present ? node->children[index] : nullptr;
+	auto replacement = Assign(child, shift - Bits, key, entry);
+	if (replacement == child) { return node; }
+	auto copy = Editable(node, version);
+	if (present && replacement) { copy->children[index] = std::move(replacement); }
+	else if (replacement) { copy->children.insert(copy->children.begin() + index, std::move(replacement)); copy->bitmap |= bit; }
+	else { copy->children.erase(copy->children.begin() + index); copy->bitmap &= ~bit; }
+	return copy->bitmap ? copy : nullptr;
+}
+
+const SHEET_SNAPSHOT::ENTRY* SHEET_SNAPSHOT::Find(const CELL::CELL_POSITION pos) const {
+	if (pos.column > 0xFFFF || pos.row > 0xFFFF) { return nullptr; }
+	auto key = Pack(pos);
+	auto node = root.get();
+	for (auto shift = RootShift; node; shift -= Bits) {
+		auto bit = uint32_t{ 1 } << ((key >> shift) & ((1u << Bits) - 1));
+		if (!(node->bitmap & bit)) { return nullptr; }
+		auto index = popcount(node->bitmap & (bit - 1));
+		if (shift == 0) { return node->entries[index].get(); }
+		node = node->children[index].get();
+	}
+	return nullptr;
+}
+
+shared_ptr<const SHEET_SNAPSHOT> SHEET_SNAPSHOT::Apply(const vector<CHANGE>& changes) const {
+	auto next = make_shared<SHEET_SNAPSHOT>();
+	next->version = version + 1;
+	next->size = size;
+	next->root = root;
+	for (auto& [pos, entry] : changes) {
+		if (pos.column > 0xFFFF || pos.row > 0xFFFF) { continue; }
+		next->root = next->Assign(next->root, RootShift, Pack(pos), entry);
+	}
+	return next;
+}
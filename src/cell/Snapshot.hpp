@@ -0,0 +1,108 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining immutable, numbered snapshots of a sheet.
+// CELL_DATA publishes a new snapshot each time a change has finished propagating, so a snapshot never shows a half-applied cascade.
+// A reader (renderer, exporter, report) pins a version simply by holding on to it, and may read it from any thread
+// without locks while the writer carries on. A version is reclaimed once the last reader lets go of it.
+//
+// Snapshots are persistent: each is a bitmapped trie keyed on the packed position (column in the high half, row in the low half).
+// The key is consumed 5 bits at a time from the top (2 bits at the root), so the trie is 7 levels deep and
+// iterates column by column, matching CELL_POSITION ordering. Nodes only hold the children that exist (bitmap + popcount).
+// Publishing a change copies the path from the root to each changed entry and shares every other node with the previous version.
+// Nodes created while building one version are changed in place for the rest of that build, so a batch of changes does not copy a path twice.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SNAPSHOT_CLASS_HPP
+#define SNAPSHOT_CLASS_HPP
+
+#include "Cell.hpp"
+#include "String_Pool.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class SHEET_SNAPSHOT : public std::enable_shared_from_this<SHEET_SNAPSHOT> {
+public:
+	// State of one cell as of this version. Its contents are shared with the cell through the sheet's pool (see String_Pool.hpp),
+	// and a plain number keeps none at all. Text that merely shows the contents is not kept a second time.
+	// The value, contents & display text are each built when asked for.
+	class ENTRY {
+	public:
+		CELL::CELL_POSITION position;
+
+		ENTRY(const CELL::CELL_POSITION, const double number);								// A plain number, entered as written back
+		ENTRY(const CELL::CELL_POSITION, STRING_POOL::TEXT contents, CELL::CELL_VALUE value, STRING_POOL* pool = nullptr);		// Other text shown is pooled too, given a pool
+
+		CELL::CELL_VALUE Value() const;
+		std::string RawContent() const;
+		std::string GetOutput() const { return CELL::DisplayString(Value()); }
+
+		friend bool operator== (const ENTRY&, const ENTRY&);
+	private:
+		enum class SHOWN : std::uint8_t { EMPTY, NUMBER, CONTENTS, TEXT, ERROR };
+		SHOWN shown{ SHOWN::EMPTY };
+		CELL::CELL_ERROR error{ };
+		double number{ 0 };
+		STRING_POOL::TEXT contents;		// Empty for a plain number
+		STRING_POOL::TEXT text;			// Text shown, if not the contents
+	};
+	using CHANGE = std::pair<CELL::CELL_POSITION, std::shared_ptr<const ENTRY>>;		// A null entry erases the position.
+
+private:
+	struct NODE {
+		std::uint64_t edit{ 0 };											// Version that created this node. Only that build may change it.
+		std::uint32_t bitmap{ 0 };
+		std::vector<std::shared_ptr<NODE>> children;						// Branch levels
+		std::vector<std::shared_ptr<const ENTRY>> entries;					// Leaf level
+	};
+	static constexpr auto RootShift{ 30u };
+	static constexpr auto Bits{ 5u };
+
+	std::uint64_t version{ 0 };
+	std::size_t size{ 0 };
+	std::shared_ptr<NODE> root;
+
+	static std::uint32_t Pack(const CELL::CELL_POSITION pos) { return (pos.column << 16) | pos.row; }
+	static std::shared_ptr<NODE> Editable(const std::shared_ptr<NODE>&, const std::uint64_t edit);
+	std::shared_ptr<NODE> Assign(const std::shared_ptr<NODE>&, const unsigned int shift, const std::uint32_t key, const std::shared_ptr<const ENTRY>&);
+
+	template <typename VISITOR> static void Visit(const NODE&, const unsigned int shift, const std::uint32_t prefix, const std::uint32_t low, const std::uint32_t high, VISITOR&);
+public:
+	std::uint64_t Version() const { return version; }
+	std::size_t Size() const { return size; }
+
+	const ENTRY* Find(const CELL::CELL_POSITION) const;
+
+	// A new version with the changes applied. This version is left untouched.
+	std::shared_ptr<const SHEET_SNAPSHOT> Apply(const std::vector<CHANGE>&) const;
+
+	// Visit every entry, column by column.
+	template <typename VISITOR> void ForEach(VISITOR&& visitor) const { if (root) { Visit(*root, RootShift, 0, 0, UINT32_MAX, visitor); } }
+
+	// Visit every entry inside the rectangle from first to last (inclusive), column by column.
+	template <typename VISITOR> void ForEachIn(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, VISITOR&& visitor) const {
+		if (!root || first.column > last.column || first.row > last.row) { return; }
+		auto inside = [first, last, &visitor](const ENTRY& entry) { if (entry.position.row >= first.row && entry.position.row <= last.row) { visitor(entry); } };
+		Visit(*root, RootShift, 0, Pack(first), Pack(last), inside);
+	}
+};
+
+// Keys below a node share its prefix, so a subtree is skipped when its whole key range falls outside [low, high].
+template <typename VISITOR>
+void SHEET_SNAPSHOT::Visit(const NODE& node, const unsigned int shift, const std::uint32_t prefix, const std::uint32_t low, const std::uint32_t high, VISITOR& visitor) {
+	auto position = 0u;
+	for (auto bits = node.bitmap; bits; bits &= bits - 1) {
+		auto chunk = static_cast<std::uint32_t>(std::countr_zero(bits));
+		auto first = prefix | (chunk << shift);
+		auto last = first | (shift == 0 ? 0u : ((std::uint32_t{ 1 } << shift) - 1));
+		auto index = position++;
+		if (last < low || first > high) { continue; }
+		if (shift == 0) { visitor(*node.entries[index]); }
+		else { Visit(*node.children[index], shift - Bits, first, low, high, visitor); }
+	}
+}
+
+#endif // !SNAPSHOT_CLASS_HPP
@@ -0,0 +1,73 @@
+#include "String_Pool.hpp"
+#include "Epoch.hpp"
+#include <utility>
+
+using namespace std;
+
+// A handle to text that is no longer held is only let go of here. If the same text was interned again in the meantime,
+// its entry now refers to the new copy and is left alone.
+void STRING_POOL::RELEASER::operator() (const string* text) const {
+	if (auto pool = state.lock()) {
+		auto lk = lock_guard<mutex>{ pool->lkTexts };
+		auto it = pool->texts.find(*text);
+		if (it != pool->texts.end() && it->second.text.expired()) {
+			pool->bytes -= text->size();
+			pool->texts.erase(it);
+		}
+	}
+	delete text;
+}
+
+// An entry whose text expired, but which its releaser has not erased yet, is replaced, keyed on the new copy.
+STRING_POOL::TEXT STRING_POOL::Find(const string_view text) {
+	auto it = state->texts.find(text);
+	if (it != state->texts.end()) {
+		if (auto held = it->second.text.lock()) { return held; }
+		state->bytes -= it->first.size();
+		state->texts.erase(it);
+	}
+	auto added = TEXT{ new string{ text }, RELEASER{ state } };
+	state->texts.emplace(string_view{ *added }, ENTRY{ added });
+	state->bytes += added->size();
+	return added;
+}
+
+STRING_POOL::TEXT STRING_POOL::Share(const string_view text) {
+	auto lk = lock_guard<mutex>{ state->lkTexts };
+	return Find(text);
+}
+
+const string* STRING_POOL::Intern(const string_view text) {
+	auto lk = lock_guard<mutex>{ state->lkTexts };
+	auto held = Find(text);
+	auto& entry = state->texts.find(text)->second;
+	if (entry.slots++ == 0) { entry.pinned = std::move(held); }
+	return entry.pinned.get();
+}
+
+// The text is retired rather than let go of, since a reader may have found it just before its last slot released it.
+// Unless a handle still holds it, it leaves the pool straight away.
+void STRING_POOL::Release(const string* text) {
+	auto retired = TEXT{ };
+	{
+		auto lk = lock_guard<mutex>{ state->lkTexts };
+		auto it = state->texts.find(*text);
+		if (it == state->texts.end() || --it->second.slots != 0) { return; }
+		retired = std::move(it->second.pinned);
+		if (retired.use_count() == 1) {		// No handle can be copied from one that does not exist
+			state->bytes -= retired->size();
+			state->texts.erase(it);
+		}
+	}
+	EPOCH::Retire(std::move(retired));
+}
+
+size_t STRING_POOL::Size() const {
+	auto lk = lock_guard<mutex>{ state->lkTexts };
+	return state->texts.size();
+}
+
+size_t STRING_POOL::Bytes() const {
+	auto lk = lock_guard<mutex>{ state->lkTexts };
+	return state->bytes;
+}
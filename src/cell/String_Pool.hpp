@@ -0,0 +1,57 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining a sheet's pool of interned text.
+// Equal pieces of text are stored once, however many cells, slots & snapshot entries hold them.
+// Text is handed out two ways. A TEXT handle shares ownership, so it may outlive the pool (a snapshot or undone cell may
+// outlive its sheet); the last handle to go takes the text out of the pool. Slots in the grid instead take a plain pointer,
+// so that one fits in a word, and each counts as one reference until released.
+// Readers may follow a pointer they found while holding an EPOCH::GUARD: releasing the last slot retires the text through EPOCH.
+// Every call is thread-safe.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STRING_POOL_CLASS_HPP
+#define STRING_POOL_CLASS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class STRING_POOL {
+public:
+	using TEXT = std::shared_ptr<const std::string>;		// A handle need not come from a pool. Compare the text, not the handle.
+
+private:
+	struct ENTRY {
+		std::weak_ptr<const std::string> text{ };
+		TEXT pinned{ };								// Held while any slot refers to the text
+		std::size_t slots{ 0 };
+	};
+	struct STATE {
+		std::mutex lkTexts;
+		std::unordered_map<std::string_view, ENTRY> texts;		// Keyed on the text each one refers to
+		std::size_t bytes{ 0 };
+	};
+	// Takes the text out of the pool (unless it was interned anew meanwhile), then frees it.
+	struct RELEASER {
+		std::weak_ptr<STATE> state;
+		void operator() (const std::string*) const;
+	};
+
+	std::shared_ptr<STATE> state{ std::make_shared<STATE>() };		// Shared with the handles, which may outlive the pool
+
+	TEXT Find(const std::string_view);			// Caller must hold lkTexts.
+public:
+	STRING_POOL() = default;
+	STRING_POOL(const STRING_POOL&) = delete;
+	STRING_POOL& operator=(const STRING_POOL&) = delete;
+
+	TEXT Share(const std::string_view);						// A handle on the text, which is added if new.
+	const std::string* Intern(const std::string_view);		// One more slot reference to the text, which is added if new.
+	void Release(const std::string*);						// One fewer.
+	std::size_t Size() const;								// Distinct texts held.
+	std::size_t Bytes() const;								// Characters held, each distinct text counted once.
+};
+
+#endif // !STRING_POOL_CLASS_HPP
@@ -0,0 +1,138 @@
+#include "Synced_File.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <cstring>
+#include <fcntl.h>
+#include <io.h>
+#include <vector>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+namespace {
+	// Renamed with POSIX semantics, which replace the target even while it is open elsewhere (mapped, say), as long as
+	// every handle to it shares deletion. Readers of the old file keep its old contents until they close it.
+	// Older systems without them fall back to a plain rename, which fails if the target is open.
+	void RenameOver(const string& from, const string& to, error_code& error) {
+		auto file = CreateFileA(from.c_str(), DELETE | SYNCHRONIZE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file != INVALID_HANDLE_VALUE) {
+			auto target = filesystem::absolute(to, error).wstring();
+			auto size = sizeof(FILE_RENAME_INFO) + target.size() * sizeof(wchar_t);
+			auto buffer = vector<unsigned long long>((size + sizeof(unsigned long long) - 1) / sizeof(unsigned long long));		// Suitably aligned
+			auto info = reinterpret_cast<FILE_RENAME_INFO*>(buffer.data());
+			info->Flags = FILE_RENAME_FLAG_REPLACE_IF_EXISTS | FILE_RENAME_FLAG_POSIX_SEMANTICS;
+			info->RootDirectory = nullptr;
+			info->FileNameLength = static_cast<DWORD>(target.size() * sizeof(wchar_t));
+			memcpy(info->FileName, target.c_str(), info->FileNameLength);
+			auto renamed = !error && SetFileInformationByHandle(file, FileRenameInfoEx, info, static_cast<DWORD>(size));
+			CloseHandle(file);
+			if (renamed) { error.clear(); return; }
+		}
+		error.clear();
+		filesystem::rename(from, to, error);
+	}
+}
+
+// Opened through the system rather than _sopen_s, since only then may the file be shared for deletion:
+// compaction renames a new journal over the one held open here.
+SYNCED_FILE::SYNCED_FILE(const string& path) {
+	auto handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle != INVALID_HANDLE_VALUE) {
+		file = _open_osfhandle(reinterpret_cast<intptr_t>(handle), _O_RDWR | _O_BINARY);
+		if (file < 0) { CloseHandle(handle); }
+	}
+	if (file < 0) { throw runtime_error("Could not open " + path); }
+}
+
+SYNCED_FILE::~SYNCED_FILE() { if (file >= 0) { _close(file); } }
+
+bool SYNCED_FILE::Resize(const size_t size) { return _chsize_s(file, static_cast<__int64>(size)) == 0 && _lseeki64(file, 0, SEEK_END) >= 0; }
+
+bool SYNCED_FILE::Write(const void* data, size_t size) {
+	auto next = static_cast<const char*>(data);
+	while (size != 0) {
+		auto written = _write(file, next, static_cast<unsigned int>(min<size_t>(size, 1 << 30)));
+		if (written <= 0) { return false; }
+		next += written;
+		size -= written;
+	}
+	return true;
+}
+
+bool SYNCED_FILE::Sync() { return _commit(file) == 0; }
+
+void SYNCED_FILE::SyncDirectory(const string&) { }		// NTFS journals renames itself
+#else
+SYNCED_FILE::SYNCED_FILE(const string& path) : file{ open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644) } {
+	if (file < 0) { throw runtime_error("Could not open " + path); }
+}
+
+SYNCED_FILE::~SYNCED_FILE() { if (file >= 0) { close(file); } }
+
+bool SYNCED_FILE::Resize(const size_t size) { return ftruncate(file, static_cast<off_t>(size)) == 0 && lseek(file, 0, SEEK_END) >= 0; }
+
+bool SYNCED_FILE::Write(const void* data, size_t size) {
+	auto next = static_cast<const char*>(data);
+	while (size != 0) {
+		auto written = write(file, next, size);
+		if (written < 0 && errno == EINTR) { continue; }
+		if (written <= 0) { return false; }
+		next += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+bool SYNCED_FILE::Sync() { return fsync(file) == 0; }
+
+void SYNCED_FILE::SyncDirectory(const string& path) {
+	auto directory = filesystem::path{ path }.parent_path();
+	auto handle = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_CLOEXEC);
+	if (handle >= 0) { fsync(handle); close(handle); }
+}
+
+namespace {
+	// A file still open (or mapped) elsewhere is simply unlinked, and keeps its old contents for whoever holds it.
+	void RenameOver(const string& from, const string& to, error_code& error) { filesystem::rename(from, to, error); }
+}
+#endif
+
+SYNCED_FILE::SYNCED_FILE(SYNCED_FILE&& other) noexcept : file{ exchange(other.file, -1) } { }
+
+SYNCED_FILE& SYNCED_FILE::operator=(SYNCED_FILE&& other) noexcept {
+	if (this != &other) {
+		auto closing = SYNCED_FILE{ };
+		closing.file = exchange(file, exchange(other.file, -1));		// The file held until now is closed on the way out
+	}
+	return *this;
+}
+
+// The new file is synced before it is renamed into place, and the rename is synced before returning,
+// so once this returns the new contents survive a crash, and until then the old ones do.
+void SYNCED_FILE::Replace(const string& path, const string& suffix, const function<bool(SYNCED_FILE&)>& write) {
+	auto temporary = path + suffix;
+	auto written = false;
+	try {
+		auto out = SYNCED_FILE{ temporary };
+		written = out.Resize(0) && write(out) && out.Sync();
+	}
+	catch (...) { }
+	auto error = error_code{ };
+	if (written) { RenameOver(temporary, path, error); }
+	if (!written || error) { remove(temporary.c_str()); throw runtime_error("Could not write " + path); }
+	SyncDirectory(path);
+}
@@ -0,0 +1,35 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining a file written through the operating system directly, so that what is written
+// can be synced to disk before anything relies on it being there.
+// Replace writes a whole new file beside the old one, syncs it, renames it over the old one & syncs the rename,
+// so a crash at any point leaves either the old contents or the new, never a mix. The journal & workbook files both go through it.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYNCED_FILE_CLASS_HPP
+#define SYNCED_FILE_CLASS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+class SYNCED_FILE {
+	int file{ -1 };
+public:
+	SYNCED_FILE() = default;							// No file open
+	explicit SYNCED_FILE(const std::string& path);		// Opens for reading & writing, creating it if need be. Throws std::runtime_error if it cannot.
+	~SYNCED_FILE();
+	SYNCED_FILE(SYNCED_FILE&&) noexcept;
+	SYNCED_FILE& operator=(SYNCED_FILE&&) noexcept;
+
+	bool Resize(const std::size_t);						// Cut (or extend) the file to the size and write on from its end.
+	bool Write(const void* data, std::size_t size);		// Write at the current position.
+	bool Sync();										// Wait until everything written is on disk.
+
+	// Replace the file at the path with whatever write writes, which returns false if it could not.
+	// The new contents are written to the path plus the suffix first. Throws std::runtime_error if any step fails.
+	// The old file may still be open or mapped (see Mapped_File.hpp): whoever holds it goes on reading the old contents.
+	static void Replace(const std::string& path, const std::string& suffix, const std::function<bool(SYNCED_FILE&)>& write);
+	static void SyncDirectory(const std::string& path);	// Sync the directory holding the path, so that a rename there survives a crash.
+};
+
+#endif // !SYNCED_FILE_CLASS_HPP
@@ -4,6 +4,7 @@
 #include "Cell.hpp"
 #include <memory>
 
+#include <span>
 #include <string>
 
 class TABLE_BASE;
@@ -40,6 +41,8 @@ public:
 
 	virtual CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const = 0;
 	virtual void UpdateCell(const CELL::CELL_POSITION) const = 0;
+	// Called by the cell layer once per edit (or batch), listing every changed position once, in position order.
+	virtual void UpdateCells(std::span<const CELL::CELL_POSITION>) const = 0;
 	virtual void LockTargetCell(const CELL::CELL_POSITION) const = 0;
 	virtual void ReleaseTargetCell() const = 0;
 	virtual CELL::CELL_POSITION TargetCellGet() const = 0;
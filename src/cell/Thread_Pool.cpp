@@ -0,0 +1,97 @@
+#include "Thread_Pool.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+	thread_local auto insidePoolTask{ false };		// Set while the current thread is running a pool task.
+}
+
+THREAD_POOL::THREAD_POOL(const size_t workerCount) {
+	for (auto i = size_t{ 0 }; i < workerCount; ++i) { queues.push_back(make_unique<WORKER_QUEUE>()); }
+	for (auto i = size_t{ 0 }; i < workerCount; ++i) { workers.emplace_back([this, i] { WorkerLoop(i); }); }
+}
+
+THREAD_POOL::~THREAD_POOL() {
+	{
+		auto lk = lock_guard<mutex>{ lkWake };
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers) { worker.join(); }
+}
+
+// Take from the back of the home queue, otherwise steal from the front of another queue.
+bool THREAD_POOL::TryTake(const size_t home, TASK& task) {
+	for (auto i = size_t{ 0 }; i < queues.size(); ++i) {
+		auto index = (home + i) % queues.size();
+		auto& queue = *queues[index];
+		auto lk = lock_guard<mutex>{ queue.lkQueue };
+		if (queue.tasks.empty()) { continue; }
+		if (i == 0) { task = queue.tasks.back(); queue.tasks.pop_back(); }
+		else { task = queue.tasks.front(); queue.tasks.pop_front(); }
+		--queuedTasks;
+		return true;
+	}
+	return false;
+}
+
+void THREAD_POOL::Run(const TASK& task) {
+	auto& batch = *task.batch;
+	insidePoolTask = true;
+	try { for (auto i = task.begin; i < task.end; ++i) { (*batch.body)(i); } }
+	catch (...) {
+		auto lk = lock_guard<mutex>{ batch.lkBatch };
+		if (!batch.error) { batch.error = current_exception(); }
+	}
+	insidePoolTask = false;
+
+	// The last decrement & its notification both happen under the lock. The waiting thread only returns (destroying the batch)
+	// once it holds the lock itself, so it cannot see the batch finished while a worker still has the batch in hand.
+	auto lk = lock_guard<mutex>{ batch.lkBatch };
+	if (--batch.remaining == 0) { batch.done.notify_all(); }
+}
+
+void THREAD_POOL::WorkerLoop(const size_t index) {
+	auto task = TASK{ };
+	while (true) {
+		if (TryTake(index, task)) { Run(task); continue; }
+		auto lk = unique_lock<mutex>{ lkWake };
+		wake.wait(lk, [this] { return stopping || queuedTasks != 0; });
+		if (stopping && queuedTasks == 0) { return; }
+	}
+}
+
+void THREAD_POOL::ParallelFor(const size_t count, const function<void(size_t)>& body, const size_t grain) {
+	if (count == 0) { return; }
+	auto step = max(grain, size_t{ 1 });
+	if (workers.empty() || insidePoolTask || count <= step) {		// Serial fallback
+		for (auto i = size_t{ 0 }; i < count; ++i) { body(i); }
+		return;
+	}
+
+	auto batch = BATCH{ };
+	batch.body = &body;
+	batch.remaining = (count + step - 1) / step;
+
+	// Deal tasks out round-robin so that every worker starts with local work.
+	auto queueIndex = size_t{ 0 };
+	for (auto begin = size_t{ 0 }; begin < count; begin += step) {
+		auto& queue = *queues[queueIndex++ % queues.size()];
+		auto lk = lock_guard<mutex>{ queue.lkQueue };
+		queue.tasks.push_back(TASK{ &batch, begin, min(begin + step, count) });
+		++queuedTasks;
+	}
+	{
+		auto lk = lock_guard<mutex>{ lkWake };		// Pairs with the predicate check in WorkerLoop
+	}
+	wake.notify_all();
+
+	// Help out until nothing is left to take, then wait for the stragglers. Whatever remaining reads here, waiting takes the lock
+	// before the batch goes out of scope.
+	auto task = TASK{ };
+	while (batch.remaining != 0 && TryTake(0, task)) { Run(task); }
+	auto lk = unique_lock<mutex>{ batch.lkBatch };
+	batch.done.wait(lk, [&batch] { return batch.remaining == 0; });
+	if (batch.error) { rethrow_exception(batch.error); }
+}
@@ -0,0 +1,71 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining a fixed-size work-stealing thread pool.
+// Each worker owns a queue of tasks. Workers take from the back of their own queue and, once it is empty,
+// steal from the front of the other queues. This keeps workers busy without a single shared queue to contend on.
+// The pool is owned by CELL_DATA and used to recalculate independent cells in parallel.
+// Threads are created once up front rather than per task, so tiny tasks do not pay for thread creation.
+// A pool of zero workers is a serial fallback: all work runs on the calling thread.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef THREAD_POOL_CLASS_HPP
+#define THREAD_POOL_CLASS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class THREAD_POOL {
+	// A single call to ParallelFor, shared by all of the tasks it was split into.
+	struct BATCH {
+		const std::function<void(std::size_t)>* body{ nullptr };
+		std::atomic<std::size_t> remaining{ 0 };		// Decremented under lkBatch. Read without it only as a hint.
+		std::exception_ptr error;
+		std::mutex lkBatch;
+		std::condition_variable done;
+	};
+
+	// A contiguous range of indices from one batch.
+	struct TASK {
+		BATCH* batch{ nullptr };
+		std::size_t begin{ 0 };
+		std::size_t end{ 0 };
+	};
+
+	struct WORKER_QUEUE {
+		std::mutex lkQueue;
+		std::deque<TASK> tasks;
+	};
+
+	std::vector<std::unique_ptr<WORKER_QUEUE>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<std::size_t> queuedTasks{ 0 };
+	std::atomic<bool> stopping{ false };
+	std::mutex lkWake;
+	std::condition_variable wake;
+
+	void WorkerLoop(const std::size_t index);
+	bool TryTake(const std::size_t home, TASK&);
+	static void Run(const TASK&);
+public:
+	explicit THREAD_POOL(const std::size_t workerCount = 0);
+	~THREAD_POOL();
+	THREAD_POOL(const THREAD_POOL&) = delete;
+	THREAD_POOL& operator=(const THREAD_POOL&) = delete;
+
+	std::size_t WorkerCount() const { return workers.size(); }
+
+	// Call body(i) for every i in [0, count), split into tasks of at most grain indices.
+	// Blocks until every call has finished; the calling thread helps with the work while it waits.
+	// The first exception thrown by any call is rethrown here once the batch has finished.
+	// Calls made from inside a pool task run serially so that nested work cannot deadlock the pool.
+	void ParallelFor(const std::size_t count, const std::function<void(std::size_t)>& body, const std::size_t grain = 1);
+};
+
+#endif // !THREAD_POOL_CLASS_HPP
@@ -0,0 +1,231 @@
+#include "Workbook_File.hpp"
+#include "Synced_File.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static_assert(endian::native == endian::little, "Workbook files are read & written in place, which assumes a little-endian machine.");
+static_assert(is_trivially_copyable_v<WORKBOOK_FILE::HEADER> && sizeof(WORKBOOK_FILE::HEADER) == 104);
+static_assert(is_trivially_copyable_v<WORKBOOK_FILE::RECORD> && sizeof(WORKBOOK_FILE::RECORD) == 40);
+
+namespace {
+	WORKBOOK_FILE::KIND KindOf(const CELL& cell) {
+		using enum WORKBOOK_FILE::KIND;
+		if (dynamic_cast<const FUNCTION_CELL*>(&cell)) { return FUNCTION; }		// Before NUMERICAL_CELL, which it derives from
+		if (dynamic_cast<const NUMERICAL_CELL*>(&cell)) { return NUMBER; }
+		if (dynamic_cast<const REFERENCE_CELL*>(&cell)) { return REFERENCE; }
+		return TEXT;
+	}
+
+	shared_ptr<CELL> MakeCell(const WORKBOOK_FILE::KIND kind, const CELL::CELL_DATA& sheet) {
+		switch (kind) {
+		case WORKBOOK_FILE::KIND::NUMBER: { return sheet.Allocate<NUMERICAL_CELL>(); }
+		case WORKBOOK_FILE::KIND::REFERENCE: { return sheet.Allocate<REFERENCE_CELL>(); }
+		case WORKBOOK_FILE::KIND::FUNCTION: { return sheet.Allocate<FUNCTION_CELL>(); }
+		default: { return sheet.Allocate<TEXT_CELL>(); }
+		}
+	}
+
+	[[noreturn]] void Damaged(const string& path) { throw runtime_error(path + " is not a workbook or is damaged."); }
+
+	void RequireEmpty(const CELL::CELL_DATA& sheet) {
+		if (sheet.CellCount() != 0 || sheet.HasImage()) { throw logic_error("Workbooks can only be loaded into an empty sheet."); }
+	}
+}
+
+// Cells are visited column by column, so records come out sorted by position.
+// The file is written beside the target and moved over it once complete, so a failed save leaves the old file intact.
+void WORKBOOK_FILE::Save(const CELL::CELL_DATA& sheet, const string& path, const bool includeGraph) {
+	auto records = vector<RECORD>{ };
+	auto edges = vector<uint32_t>{ };
+	auto observers = vector<uint64_t>{ };
+	auto ranges = vector<uint32_t>{ };
+	auto text = string{ };
+	auto append = [&text](const string& content) {
+		if (text.size() + content.size() > numeric_limits<uint32_t>::max()) { throw runtime_error("Sheet holds too much text to save."); }
+		auto slice = SLICE{ static_cast<uint32_t>(text.size()), static_cast<uint32_t>(content.size()) };
+		text += content;
+		return slice;
+	};
+	{
+		auto all = pair{ CELL::CELL_POSITION{ 1, 1 }, CELL::CELL_POSITION{ MaxColumn_, MaxRow_ } };
+		sheet.BuildCells(all.first, all.second);
+		auto guard = EPOCH::GUARD{ };
+		sheet.data.cellGrid.ForEachIn(all.first, all.second, [&](const CELL::CELL_POSITION pos, const CELL::SLOT slot) {
+			auto cell = slot.IsCell() ? slot.Cell() : nullptr;		// Plain values are saved as the cells they would be built into
+			auto record = RECORD{ };
+			record.position = Pack(pos);
+			record.kind = cell ? KindOf(*cell) : slot.IsNumber() ? KIND::NUMBER : KIND::TEXT;
+			record.raw = append(slot.RawContent());
+			record.flags = cell && cell->circular ? Circular : 0;
+			auto value = cell ? cell->StoredValue() : slot.Value();		// Circular cells keep the value they held before joining the loop.
+			if (auto number = get_if<double>(&value)) { record.valueType = VALUE_TYPE::NUMBER; record.value.number = *number; }
+			else if (auto content = get_if<string>(&value)) { record.valueType = VALUE_TYPE::TEXT; record.value.text = append(*content); }
+			else if (auto errorCode = get_if<CELL::CELL_ERROR>(&value)) { record.valueType = VALUE_TYPE::ERROR; record.error = static_cast<uint8_t>(*errorCode); }
+			if (includeGraph) { record.edgeFirst = static_cast<uint32_t>(edges.size()); }
+			if (includeGraph && cell) {
+				record.subjectCount = static_cast<uint32_t>(cell->subscriptions.size());
+				record.rangeCount = static_cast<uint32_t>(cell->rangeSubscriptions.size());
+				for (auto subject : cell->subscriptions) {
+					edges.push_back(Pack(subject));
+					observers.push_back(uint64_t{ Pack(subject) } << 32 | Pack(pos));
+				}
+				for (auto [first, last] : cell->rangeSubscriptions) {
+					edges.insert(edges.end(), { Pack(first), Pack(last) });
+					ranges.insert(ranges.end(), { Pack(first), Pack(last), Pack(pos) });
+				}
+			}
+			records.push_back(record);
+		});
+	}
+	sort(observers.begin(), observers.end());
+
+	auto header = HEADER{ };
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.flags = includeGraph ? uint32_t{ HasGraph } : uint32_t{ 0 };
+	header.recordSize = sizeof(RECORD);
+	header.cellCount = records.size();
+	header.recordOffset = sizeof(HEADER);
+	header.edgeOffset = header.recordOffset + records.size() * sizeof(RECORD);
+	header.edgeCount = edges.size();
+	header.observerOffset = header.edgeOffset + edges.size() * sizeof(uint32_t);
+	header.observerOffset += header.observerOffset % sizeof(uint64_t);			// Edges are 4 bytes, so pad once
+	header.observerCount = observers.size();
+	header.rangeOffset = header.observerOffset + observers.size() * sizeof(uint64_t);
+	header.rangeCount = ranges.size() / 3;
+	header.textOffset = header.rangeOffset + ranges.size() * sizeof(uint32_t);
+	header.textSize = text.size();
+
+	// Synced before it replaces the old file, since a journal may drop every edit the new file holds as soon as this returns.
+	SYNCED_FILE::Replace(path, ".saving", [&](SYNCED_FILE& out) {
+		auto padding = uint32_t{ 0 };
+		return out.Write(&header, sizeof(header))
+			&& out.Write(records.data(), records.size() * sizeof(RECORD))
+			&& out.Write(edges.data(), edges.size() * sizeof(uint32_t))
+			&& out.Write(&padding, header.observerOffset - header.edgeOffset - edges.size() * sizeof(uint32_t))
+			&& out.Write(observers.data(), observers.size() * sizeof(uint64_t))
+			&& out.Write(ranges.data(), ranges.size() * sizeof(uint32_t))
+			&& out.Write(text.data(), text.size());
+	});
+}
+
+// Every record is checked before any cell is created, so a damaged file leaves the sheet untouched.
+// Cells are then placed straight into the grid with their saved values (plain values into their slots). Nothing is recalculated.
+void WORKBOOK_FILE::Load(CELL::CELL_DATA& sheet, const string& path) {
+	RequireEmpty(sheet);
+	auto image = WORKBOOK_IMAGE{ path };
+	auto region = CELL::CELL_DATA::DIRTY_REGION{ &sheet };
+	auto positions = vector<CELL::CELL_POSITION>{ };
+	positions.reserve(image.Size());
+	for (auto i = size_t{ 0 }; i < image.Size(); ++i) {
+		positions.push_back(image.Position(i));
+		if (auto literal = image.Literal(i, sheet)) { sheet.AssignSlot(positions.back(), literal); continue; }
+		auto cell = image.Build(i, &sheet);
+		sheet.AssignCell(cell);			// Also restores the subscriptions read from the file
+		if (!image.HasGraph()) {
+			try { cell->Subscribe(); }
+			catch (...) { cell->error = true; }
+		}
+	}
+	sheet.PublishSnapshot(positions);
+	for (auto pos : positions) { sheet.UpdateTable(pos); }
+}
+
+void WORKBOOK_FILE::Open(CELL::CELL_DATA& sheet, const string& path) {
+	RequireEmpty(sheet);
+	auto image = make_unique<WORKBOOK_IMAGE>(path);
+	if (!image->HasGraph()) { image.reset(); Load(sheet, path); return; }
+	sheet.data.image = std::move(image);
+}
+
+WORKBOOK_IMAGE::WORKBOOK_IMAGE(const string& path) : file{ path } {
+	auto size = uint64_t{ file.Size() };
+	if (size < sizeof(header)) { Damaged(path); }
+	memcpy(&header, Bytes(), sizeof(header));
+	if (memcmp(header.magic, WORKBOOK_FILE::Magic, sizeof(WORKBOOK_FILE::Magic)) != 0) { Damaged(path); }
+	if (header.version > WORKBOOK_FILE::Version) { throw runtime_error(path + " was saved by a newer version of this program."); }
+	if (header.version != WORKBOOK_FILE::Version || header.recordSize != sizeof(WORKBOOK_FILE::RECORD)) { Damaged(path); }
+	auto fits = [size](const uint64_t offset, const uint64_t count, const uint64_t width) { return offset <= size && count <= (size - offset) / width; };
+	if (!fits(header.recordOffset, header.cellCount, sizeof(WORKBOOK_FILE::RECORD)) || !fits(header.edgeOffset, header.edgeCount, sizeof(uint32_t))
+		|| !fits(header.observerOffset, header.observerCount, sizeof(uint64_t)) || !fits(header.rangeOffset, header.rangeCount, 3 * sizeof(uint32_t))
+		|| !fits(header.textOffset, header.textSize, 1)) { Damaged(path); }
+	if (header.cellCount > numeric_limits<size_t>::max() / 2) { Damaged(path); }
+
+	auto inText = [this](const WORKBOOK_FILE::SLICE slice) { return slice.offset <= header.textSize && slice.length <= header.textSize - slice.offset; };
+	for (auto i = size_t{ 0 }; i < Size(); ++i) {
+		auto saved = Record(i);
+		auto pos = WORKBOOK_FILE::Unpack(saved.position);
+		if (pos.column == 0 || pos.row == 0 || (i != 0 && saved.position <= Key(i - 1))) { Damaged(path); }		// Sorted & unique, for binary search
+		if (saved.kind > WORKBOOK_FILE::KIND::FUNCTION || saved.valueType > WORKBOOK_FILE::VALUE_TYPE::ERROR || saved.error > static_cast<uint8_t>(CELL::CELL_ERROR::CIRCULAR)) { Damaged(path); }
+		if (!inText(saved.raw) || (saved.valueType == WORKBOOK_FILE::VALUE_TYPE::TEXT && !inText(saved.value.text))) { Damaged(path); }
+		if (HasGraph() && (saved.edgeFirst > header.edgeCount || uint64_t{ saved.subjectCount } + 2 * uint64_t{ saved.rangeCount } > header.edgeCount - saved.edgeFirst)) { Damaged(path); }
+	}
+	for (auto i = uint64_t{ 1 }; i < header.observerCount; ++i) {
+		if (Read<uint64_t>(header.observerOffset + i * sizeof(uint64_t)) < Read<uint64_t>(header.observerOffset + (i - 1) * sizeof(uint64_t))) { Damaged(path); }
+	}
+	for (auto i = uint64_t{ 0 }; i < header.rangeCount; ++i) {
+		auto corner = [this, i](const uint64_t n) { return WORKBOOK_FILE::Unpack(Read<uint32_t>(header.rangeOffset + (3 * i + n) * sizeof(uint32_t))); };
+		ranges.Insert(corner(0), corner(1), corner(2));
+	}
+	states = make_unique<atomic<uint8_t>[]>(Size());
+}
+
+size_t WORKBOOK_IMAGE::LowerBound(const uint32_t key, size_t first) const {
+	auto last = Size();
+	while (first < last) {
+		auto middle = first + (last - first) / 2;
+		if (Key(middle) < key) { first = middle + 1; }
+		else { last = middle; }
+	}
+	return first;
+}
+
+string_view WORKBOOK_IMAGE::Text(const WORKBOOK_FILE::SLICE slice) const { return string_view{ reinterpret_cast<const char*>(Bytes() + header.textOffset + slice.offset), slice.length }; }
+
+size_t WORKBOOK_IMAGE::Find(const CELL::CELL_POSITION pos) const {
+	if (pos.column > MaxColumn_ || pos.row > MaxRow_) { return None; }
+	auto key = WORKBOOK_FILE::Pack(pos);
+	auto i = LowerBound(key, 0);
+	return i < Size() && Key(i) == key ? i : None;
+}
+
+CELL::CELL_VALUE WORKBOOK_IMAGE::SavedValue(const WORKBOOK_FILE::RECORD& saved) const {
+	switch (saved.valueType) {
+	case WORKBOOK_FILE::VALUE_TYPE::NUMBER: { return saved.value.number; }
+	case WORKBOOK_FILE::VALUE_TYPE::TEXT: { return string{ Text(saved.value.text) }; }
+	case WORKBOOK_FILE::VALUE_TYPE::ERROR: { return static_cast<CELL::CELL_ERROR>(saved.error); }
+	default: { return CELL::CELL_VALUE{ }; }
+	}
+}
+
+shared_ptr<CELL> WORKBOOK_IMAGE::Build(const size_t index, CELL::CELL_DATA* sheet) const {
+	auto saved = Record(index);
+	auto cell = MakeCell(saved.kind, *sheet);
+	cell->position = WORKBOOK_FILE::Unpack(saved.position);
+	cell->rawContent = sheet->Contents(Text(saved.raw));
+	cell->parentContainer = sheet;
+	cell->RestoreValue(SavedValue(saved));
+	cell->circular = (saved.flags & WORKBOOK_FILE::Circular) != 0;
+	if (HasGraph()) {
+		auto next = uint64_t{ saved.edgeFirst };
+		for (auto s = 0u; s < saved.subjectCount; ++s) { cell->subscriptions.push_back(WORKBOOK_FILE::Unpack(Edge(next++))); }
+		for (auto r = 0u; r < saved.rangeCount; ++r, next += 2) { cell->rangeSubscriptions.emplace_back(WORKBOOK_FILE::Unpack(Edge(next)), WORKBOOK_FILE::Unpack(Edge(next + 1))); }
+	}
+	return cell;
+}
+
+// Only text & number records can be plain values, and only if they still show what their contents would.
+CELL::SLOT WORKBOOK_IMAGE::Literal(const size_t index, const CELL::CELL_DATA& sheet) const {
+	auto saved = Record(index);
+	if (saved.kind > WORKBOOK_FILE::KIND::NUMBER || (saved.flags & WORKBOOK_FILE::Circular) != 0) { return CELL::SLOT{ }; }
+	return sheet.MakeLiteral(string{ Text(saved.raw) }, SavedValue(saved));
+}
@@ -0,0 +1,170 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////
+// Below is a header file defining the binary file format a sheet is saved to & loaded from.
+// A file holds a header, an index of fixed-size cell records sorted by position, an edge section & a text section:
+//		Each record holds the cell's type, its raw content (as a slice of the text section) and its computed value,
+//		so a loaded sheet shows its values straight away, without re-running any cascade.
+//		Optionally, each record also lists the cells & ranges it observes (a slice of the edge section), which rebuilds
+//		the dependency graph without parsing any formula. Formulas are then only compiled once they next recalculate.
+//		Without that section, formulas are compiled on load to find their references, but are still not evaluated.
+//		Along with it come the same edges sorted by subject, and every range subscription, so that the observers of
+//		any position can be found without visiting the records.
+// Loading maps the file into memory (see Mapped_File.hpp) and reads the records in place.
+// Opening instead keeps the file mapped behind the sheet as a WORKBOOK_IMAGE, and builds each cell only when it is first needed.
+// Numbers are stored little-endian. The version is bumped whenever the layout changes; older readers refuse newer files.
+*////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKBOOK_FILE_CLASS_HPP
+#define WORKBOOK_FILE_CLASS_HPP
+
+#include "Cell.hpp"
+#include "Mapped_File.hpp"
+#include "Range_Index.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class WORKBOOK_FILE {
+public:
+	static constexpr std::uint32_t Version{ 2 };
+	static constexpr char Magic[8]{ 'S', 'H', 'E', 'E', 'T', '\r', '\n', '\x1A' };		// Line-ending translation & text mode truncation both corrupt it
+
+	enum class KIND : std::uint8_t { TEXT, NUMBER, REFERENCE, FUNCTION };
+	enum class VALUE_TYPE : std::uint8_t { EMPTY, NUMBER, TEXT, ERROR };
+	enum FLAGS : std::uint32_t { HasGraph = 1 };
+	enum CELL_FLAGS : std::uint8_t { Circular = 1 };
+
+	struct HEADER {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t flags;
+		std::uint32_t recordSize;
+		std::uint32_t reserved;
+		std::uint64_t cellCount;
+		std::uint64_t recordOffset;
+		std::uint64_t edgeOffset;
+		std::uint64_t edgeCount;				// Packed positions (column in the high half, row in the low half)
+		std::uint64_t textOffset;
+		std::uint64_t textSize;
+		std::uint64_t observerOffset;
+		std::uint64_t observerCount;			// Packed (subject, observer) pairs, sorted
+		std::uint64_t rangeOffset;
+		std::uint64_t rangeCount;				// Packed (first, last, observer) triples
+	};
+
+	struct SLICE { std::uint32_t offset, length; };
+
+	struct RECORD {
+		std::uint32_t position;					// Packed as above
+		KIND kind;
+		VALUE_TYPE valueType;
+		std::uint8_t flags;
+		std::uint8_t error;						// CELL_ERROR, if valueType is ERROR
+		SLICE raw;								// Text section
+		union {
+			double number;
+			SLICE text;							// Text section
+		} value;
+		std::uint32_t edgeFirst;				// Subjects first, then the two corners of each range
+		std::uint32_t subjectCount;
+		std::uint32_t rangeCount;
+		std::uint32_t reserved;
+	};
+
+	static std::uint32_t Pack(const CELL::CELL_POSITION pos) { return (pos.column << 16) | pos.row; }
+	static CELL::CELL_POSITION Unpack(const std::uint32_t key) { return CELL::CELL_POSITION{ key >> 16, key & 0xFFFF }; }
+
+	// Throws std::runtime_error if the file cannot be written. The file is replaced only once it has been written in full & synced to disk.
+	// A sheet opened from a file has all of its cells built first. It may be saved over that same file, which stays mapped unchanged behind it.
+	static void Save(const CELL::CELL_DATA&, const std::string& path, const bool includeGraph = true);
+
+	// Load into an empty sheet. Throws std::runtime_error if the file cannot be read, is damaged or is from a newer version,
+	// and std::logic_error if the sheet already holds cells.
+	static void Load(CELL::CELL_DATA&, const std::string& path);
+
+	// As Load, but no cell is built until it is read or a change reaches it (see CELL_DATA). The file stays mapped until the sheet is destroyed.
+	// Nothing is published or shown until then either. Files saved without their dependency graph are loaded in full, as by Load,
+	// since the cells a change reaches cannot be found without it.
+	static void Open(CELL::CELL_DATA&, const std::string& path);
+};
+
+// A workbook file kept mapped behind a sheet, whose records are built into cells one at a time (see WORKBOOK_FILE::Open).
+// Each record moves from STORED to BUILT (its cell is in the grid, but not subscribed) to RELEASED (the sheet no longer needs
+// the record: the cell is subscribed like any other, or the position was overwritten). Only STORED records are ever built.
+// Lookups are safe from any thread. Changing a record's state is serialized by the caller.
+class WORKBOOK_IMAGE {
+public:
+	enum STATE : std::uint8_t { STORED, BUILT, RELEASED };
+	static constexpr auto None{ ~std::size_t{ 0 } };
+private:
+	MAPPED_FILE file;
+	WORKBOOK_FILE::HEADER header;
+	std::unique_ptr<std::atomic<std::uint8_t>[]> states;		// One per record
+	RANGE_INDEX ranges;												// Every range subscription in the file
+
+	const std::byte* Bytes() const { return file.Data(); }
+	template <typename T> T Read(const std::uint64_t offset) const { auto read = T{ }; std::memcpy(&read, Bytes() + offset, sizeof(T)); return read; }
+	std::uint32_t Key(const std::size_t index) const { return Read<std::uint32_t>(header.recordOffset + index * sizeof(WORKBOOK_FILE::RECORD)); }
+	std::uint32_t Edge(const std::uint64_t index) const { return Read<std::uint32_t>(header.edgeOffset + index * sizeof(std::uint32_t)); }
+	std::size_t LowerBound(const std::uint32_t key, std::size_t first) const;		// First record at or after the key
+	std::string_view Text(const WORKBOOK_FILE::SLICE) const;
+	WORKBOOK_FILE::RECORD Record(const std::size_t index) const { return Read<WORKBOOK_FILE::RECORD>(header.recordOffset + index * sizeof(WORKBOOK_FILE::RECORD)); }
+	CELL::CELL_VALUE SavedValue(const WORKBOOK_FILE::RECORD&) const;
+public:
+	explicit WORKBOOK_IMAGE(const std::string& path);		// Checks every record. Throws as WORKBOOK_FILE::Load does.
+	WORKBOOK_IMAGE(const WORKBOOK_IMAGE&) = delete;
+	WORKBOOK_IMAGE& operator=(const WORKBOOK_IMAGE&) = delete;
+
+	std::size_t Size() const { return static_cast<std::size_t>(header.cellCount); }
+	bool HasGraph() const { return (header.flags & WORKBOOK_FILE::HasGraph) != 0; }
+	std::size_t Find(const CELL::CELL_POSITION) const;		// Index of the record at the position, or None.
+	CELL::CELL_POSITION Position(const std::size_t index) const { return WORKBOOK_FILE::Unpack(Key(index)); }
+	STATE State(const std::size_t index) const { return static_cast<STATE>(states[index].load(std::memory_order_acquire)); }
+	void SetState(const std::size_t index, const STATE state) { states[index].store(state, std::memory_order_release); }
+
+	// A new cell holding the record's contents, value & subscriptions (not yet registered with the sheet). Nothing is evaluated.
+	std::shared_ptr<CELL> Build(const std::size_t index, CELL::CELL_DATA*) const;
+
+	// The record's plain value, as the sheet's grid would hold it, or an empty slot if the record needs a cell built (see CELL_DATA::MakeLiteral).
+	CELL::SLOT Literal(const std::size_t index, const CELL::CELL_DATA&) const;
+
+	// Visit the index of every record inside the rectangle from first to last (inclusive), column by column.
+	template <typename VISITOR> void ForEachIn(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, VISITOR&& visitor) const;
+
+	// Visit every position whose record observes the subject, directly or through a range. A position may be visited more than once.
+	template <typename VISITOR> void ForEachObserver(const CELL::CELL_POSITION subject, VISITOR&& visitor) const;
+};
+
+// Records are sorted column by column, so each column of the rectangle is one run, found by binary search.
+template <typename VISITOR>
+void WORKBOOK_IMAGE::ForEachIn(const CELL::CELL_POSITION first, const CELL::CELL_POSITION last, VISITOR&& visitor) const {
+	if (first.column > last.column || first.row > last.row) { return; }
+	for (auto i = LowerBound(WORKBOOK_FILE::Pack(first), 0); i < Size();) {
+		auto pos = Position(i);
+		if (pos.column > last.column) { return; }
+		if (pos.row < first.row) { i = LowerBound(WORKBOOK_FILE::Pack(CELL::CELL_POSITION{ pos.column, first.row }), i); continue; }
+		if (pos.row > last.row) { i = LowerBound(WORKBOOK_FILE::Pack(CELL::CELL_POSITION{ pos.column + 1, first.row }), i); continue; }
+		visitor(i);
+		++i;
+	}
+}
+
+template <typename VISITOR>
+void WORKBOOK_IMAGE::ForEachObserver(const CELL::CELL_POSITION subject, VISITOR&& visitor) const {
+	auto key = WORKBOOK_FILE::Pack(subject);
+	auto pair = [this](const std::uint64_t i) { return Read<std::uint64_t>(header.observerOffset + i * sizeof(std::uint64_t)); };
+	auto low = std::uint64_t{ 0 };
+	auto high = header.observerCount;
+	while (low < high) {
+		auto middle = low + (high - low) / 2;
+		if (static_cast<std::uint32_t>(pair(middle) >> 32) < key) { low = middle + 1; }
+		else { high = middle; }
+	}
+	for (; low < header.observerCount && static_cast<std::uint32_t>(pair(low) >> 32) == key; ++low) { visitor(WORKBOOK_FILE::Unpack(static_cast<std::uint32_t>(pair(low)))); }
+	ranges.Query(subject, [&visitor](const RANGE_INDEX::ENTRY& entry) { visitor(entry.observer); });
+}
+
+#endif // !WORKBOOK_FILE_CLASS_HPP
@@ -6,12 +6,18 @@
 // Far fewer table features are needed for this and a few are added to help the console specifically.
 *///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <fstream>
 #include <iostream>
 
 #include <memory>
 
+#include <span>
 #include <string>
+#include <thread>
 
+#include "Csv_File.hpp"
+#include "Edit_History.hpp"
+#include "Snapshot.hpp"
 #include "Table.hpp"
 
 using namespace std;
@@ -29,8 +35,10 @@ Menu:
 4. Undo
 5. Redo
 6. List All Cells
-7. Help
-8. Exit
+7. Import CSV
+8. Export CSV
+9. Help
+10. Exit
 )";
 constexpr auto commandHelp = R"(
 HELP INFO:
@@ -48,6 +56,15 @@ Function Mapping:
 =RECIPROCAL(___)
 =INVERSE(___)
 =PI()
+=MIN(___,___,___)
+=MAX(___,___,___)
+=COUNT(___,___,___)
+
+Ranges: &R___C___:R___C___ (aggregate functions only)
+Example: =AVERAGE(&R1C1:R10C1)
+
+Operators: + - * / and (grouping parentheses)
+Example: =SUM(&R1C1, 2) * (3 + &R2C2) / 4
 )";
 
 class CONSOLE_TABLE : public TABLE_BASE {
@@ -59,12 +76,14 @@ public:
 	void Redo() const override;
 	CELL::CELL_PROXY CreateNewCell() const;
 	CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override;
+	void CreateNewCells(const std::vector<std::pair<CELL::CELL_POSITION, std::string>>&) const;		// One batch & one undo step
 	void ClearCell(const CELL::CELL_POSITION) const;
+	void ImportCsv() const;
+	void ExportCsv() const;
 	CELL::CELL_POSITION RequestCellPos() const;
 protected:
-	mutable CELL::CELL_DATA cellData;
-	mutable std::vector<std::pair<CELL::CELL_PROXY, CELL::CELL_PROXY>> undoStack{ };
-	mutable std::vector<std::pair<CELL::CELL_PROXY, CELL::CELL_PROXY>> redoStack{ };
+	mutable CELL::CELL_DATA cellData{ std::thread::hardware_concurrency() };
+	mutable EDIT_HISTORY history{ &cellData };		// Each step holds every edit made by one command
 
 	// Unused functions
 	void Resize() override { }
@@ -85,6 +104,7 @@ protected:
 	void LockTargetCell(const CELL::CELL_POSITION) const override { }
 	void ReleaseTargetCell() const override { }
 	void UpdateCell(const CELL::CELL_POSITION) const override;
+	void UpdateCells(std::span<const CELL::CELL_POSITION>) const override;
 	CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
 };
 
@@ -103,23 +123,25 @@ void CONSOLE_TABLE::InitializeTable() {
 
 	// Insert cells upon creation (Optional)
 	if (addExampleCells) {
-		CreateNewCell({ 1, 1 }, "2"s);
-		CreateNewCell({ 2, 1 }, "4"s);
-		CreateNewCell({ 3, 1 }, "9"s);
-		CreateNewCell({ 4, 1 }, "SUM->"s);
-		CreateNewCell({ 5, 1 }, "=SUM( &R1C1, &R1C2, &R1C3 )"s);
-
-		CreateNewCell({ 1, 2 }, "=RECIPROCAL( &R1C1 )"s);
-		CreateNewCell({ 2, 2 }, "=INVERSE( &R1C2 )"s);
-		CreateNewCell({ 3, 2 }, "=&R1C3"s);
-		CreateNewCell({ 4, 2 }, "SUM->"s);
-		CreateNewCell({ 5, 2 }, "=SUM( &R2C1, &R2C2, &R2C3 )"s);
-
-		CreateNewCell({ 1, 3 }, "&R2C1"s);
-		CreateNewCell({ 2, 3 }, "&R2C2"s);
-		CreateNewCell({ 3, 3 }, "&R2C3"s);
-		CreateNewCell({ 4, 3 }, "AVERAGE->"s);
-		CreateNewCell({ 5, 3 }, "=AVERAGE( &R3C1, &R3C2, &R3C3 )"s);
+		CreateNewCells({
+			{ { 1, 1 }, "2"s },
+			{ { 2, 1 }, "4"s },
+			{ { 3, 1 }, "9"s },
+			{ { 4, 1 }, "SUM->"s },
+			{ { 5, 1 }, "=SUM( &R1C1, &R1C2, &R1C3 )"s },
+
+			{ { 1, 2 }, "=RECIPROCAL( &R1C1 )"s },
+			{ { 2, 2 }, "=INVERSE( &R1C2 )"s },
+			{ { 3, 2 }, "=&R1C3"s },
+			{ { 4, 2 }, "SUM->"s },
+			{ { 5, 2 }, "=SUM( &R2C1, &R2C2, &R2C3 )"s },
+
+			{ { 1, 3 }, "&R2C1"s },
+			{ { 2, 3 }, "&R2C2"s },
+			{ { 3, 3 }, "&R2C3"s },
+			{ { 4, 3 }, "AVERAGE->"s },
+			{ { 5, 3 }, "=AVERAGE( &R3C1, &R3C2, &R3C3 )"s }
+		});
 	}
 
 	cout << '\n' << endl;
@@ -138,8 +160,10 @@ void CONSOLE_TABLE::InitializeTable() {
 		case 4: { Undo(); } break;										// Undo
 		case 5: { Redo(); } break;										// Redo
 		case 6: { PrintCellList(); } break;								// Print cell list
-		case 7: { cout << commandHelp << endl; } break;					// Command list
-		case 8: { return; } break;
+		case 7: { ImportCsv(); } break;									// Import CSV
+		case 8: { ExportCsv(); } break;									// Export CSV
+		case 9: { cout << commandHelp << endl; } break;					// Command list
+		case 10: { return; } break;
 		default: { cout << "invalid selection\n"; } break;
 		}
 		Redraw();														// Redraw table after each command
@@ -154,7 +178,7 @@ void CONSOLE_TABLE::Redraw() const {
 		pos.row = r;
 		for (auto c = 1; c <= numColumns; c++) {
 			pos.column = c;
-			auto cell = cellData.GetCellProxy(pos);
+			auto cell = cellData.GetCellView(pos);
 			cell ? output = cell->GetOutput() : output = "";
 			printf("[%*.*s]", innerCellWidth, innerCellWidth, output.c_str());
 		}
@@ -170,7 +194,7 @@ void CONSOLE_TABLE::PrintCellList() const {
 		cout << "Row " << r << " : " << endl;
 		for (auto c = 1; c <= numColumns; c++) {
 			pos.column = c;
-			auto cell = cellData.GetCellProxy(pos);
+			auto cell = cellData.GetCellView(pos);
 			if (!cell) { continue; }
 			cout << "R" << pos.row << 'C' << pos.column << " -> ";
 			printf("%*.*s", innerCellWidth, innerCellWidth, cell->GetOutput().c_str());
@@ -182,16 +206,23 @@ void CONSOLE_TABLE::PrintCellList() const {
 
 void CONSOLE_TABLE::UpdateCell(const CELL::CELL_POSITION pos) const {
 	if (!cellDiagnostics) { return; }
-	auto cell = cellData.GetCellProxy(pos);
+	auto cell = cellData.GetCellView(pos);
 	if (!cell) { return; }
 	cout << "Update Cell: R" << pos.row << 'C' << pos.column << " -> " << cell->GetOutput()
 		<< '\t' << cell->GetRawContent() << endl;
 }
 
+// The table is redrawn after each command anyway, so a change only needs reporting when diagnosing.
+void CONSOLE_TABLE::UpdateCells(span<const CELL::CELL_POSITION> positions) const {
+	if (!cellDiagnostics) { return; }
+	cout << "Update " << positions.size() << " Cell(s)" << endl;
+	for (auto pos : positions) { UpdateCell(pos); }
+}
+
 CELL::CELL_PROXY CONSOLE_TABLE::CreateNewCell() const {
 	auto input = string{ };
 	auto pos = RequestCellPos();
-	auto current = cellData.GetCellProxy(pos);
+	auto current = cellData.GetCellView(pos);
 	auto display = string{ };	auto raw = string{ };
 	if (current) {
 		display = current->GetOutput();
@@ -208,16 +239,37 @@ CELL::CELL_PROXY CONSOLE_TABLE::CreateNewCell() const {
 }
 
 CELL::CELL_PROXY CONSOLE_TABLE::CreateNewCell(const CELL::CELL_POSITION pos, const string& rawInput) const {
-	auto oldCell = cellData.GetCellProxy(pos);
-	auto nCell = CELL::NewCell(&cellData, pos, rawInput);
-	auto oldText = string{ };
-	!oldCell ? oldText = ""s : oldText = oldCell->GetRawContent();
-	if (rawInput != oldText) { undoStack.emplace_back(oldCell, nCell); redoStack.clear(); }
-	return nCell;
+	return history.NewCell(pos, rawInput);
+}
+
+void CONSOLE_TABLE::CreateNewCells(const vector<pair<CELL::CELL_POSITION, string>>& inputs) const {
+	auto batch = CELL::BATCH{ &cellData };
+	for (auto& [pos, rawInput] : inputs) { batch.NewCell(pos, rawInput); }
+	history.Record(batch.Commit());
 }
 
 void CONSOLE_TABLE::ClearCell(const CELL::CELL_POSITION pos) const { CreateNewCell(pos, ""s); }
 
+// An import is not recorded as an undo step, so earlier steps are dropped rather than replayed over it.
+void CONSOLE_TABLE::ImportCsv() const {
+	auto path = string{ };
+	cout << "Import from: ";
+	cin >> path;
+	auto file = ifstream{ path, ios::binary };
+	if (!file) { cout << "Could not open " << path << endl; return; }
+	cout << CSV_FILE::Import(cellData, file) << " cell(s) imported." << endl;
+	history.Clear();
+}
+
+void CONSOLE_TABLE::ExportCsv() const {
+	auto path = string{ };
+	cout << "Export to: ";
+	cin >> path;
+	auto file = ofstream{ path, ios::binary | ios::trunc };
+	try { CSV_FILE::Export(*cellData.Snapshot(), file); cout << "Exported to " << path << endl; }
+	catch (const exception& e) { cout << e.what() << endl; }
+}
+
 CELL::CELL_POSITION CONSOLE_TABLE::RequestCellPos() const {
 	auto input = string{ };
 	auto pos = CELL::CELL_POSITION{ };
@@ -235,26 +287,7 @@ CELL::CELL_POSITION CONSOLE_TABLE::RequestCellPos() const {
 	return pos;
 }
 
-void CONSOLE_TABLE::Undo() const {
-	if (undoStack.empty()) { return; }
-	auto cell = undoStack.back().first;
-	auto otherCell = undoStack.back().second;
-	auto pos = CELL::CELL_POSITION{ };
-	if (cell) { pos = cell->GetPosition(); }
-	else { pos = otherCell->GetPosition(); }
-	CELL::RecreateCell(&cellData, cell, pos);			// Null cells need their position
-	redoStack.push_back(undoStack.back());
-	undoStack.pop_back();
-}
+// Each step is undone or redone inside one batch, so it recalculates once (see Edit_History.hpp).
+void CONSOLE_TABLE::Undo() const { history.Undo(); }
 
-void CONSOLE_TABLE::Redo() const {
-	if (redoStack.empty()) { return; }
-	auto cell = redoStack.back().second;
-	auto otherCell = redoStack.back().first;
-	auto pos = CELL::CELL_POSITION{ };
-	if (cell) { pos = cell->GetPosition(); }
-	else { pos = otherCell->GetPosition(); }
-	CELL::RecreateCell(&cellData, cell, pos);
-	undoStack.push_back(redoStack.back());
-	redoStack.pop_back();
-}
+void CONSOLE_TABLE::Redo() const { history.Redo(); }
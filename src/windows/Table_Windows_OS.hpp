@@ -1,8 +1,10 @@
 #include "framework.hpp"
 
+#include "Edit_History.hpp"
 #include "Utilities.hpp"
 #include "Table.hpp"
 #include "WINDOW.hpp"
+#include <thread>
 
 using namespace std;
 using namespace RYANS_UTILITIES;
@@ -29,13 +31,12 @@ protected:
 	int m_X0{ 0 };
 	int m_Y0{ 25 };
 	HWND hParent{ nullptr };
-	mutable CELL::CELL_DATA m_CellData;
+	mutable CELL::CELL_DATA m_CellData{ std::thread::hardware_concurrency() };
 	mutable CELL::CELL_POSITION m_Origin{ 0, 0 };		// Origin is the "off-the-begining" cell to the upper-left of the upper-left cell
 	mutable CELL::CELL_POSITION m_PosTargetCell{ };	// Tracks position of cell currently associated with upper edit box, may be blank
 	mutable CELL::CELL_POSITION m_MostRecentCell{ };	// Tracks position of most recently selected cell for either target selection or new cell creation
 
-	mutable std::vector<std::pair<CELL::CELL_PROXY, CELL::CELL_PROXY>> m_UndoStack{ };
-	mutable std::vector<std::pair<CELL::CELL_PROXY, CELL::CELL_PROXY>> m_RedoStack{ };
+	mutable EDIT_HISTORY m_History{ &m_CellData };		// Each step holds every edit made by one command
 public:
 	~WINDOWS_TABLE();						// Hook for any on-exit logic
 	void AddRow() override;
@@ -61,6 +62,7 @@ public:
 
 	CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const;
 	void UpdateCell(const CELL::CELL_POSITION) const override;
+	void UpdateCells(std::span<const CELL::CELL_POSITION>) const override;
 	void LockTargetCell(const CELL::CELL_POSITION) const override;
 	void ReleaseTargetCell() const override;
 	CELL::CELL_POSITION TargetCellGet() const override;
@@ -143,12 +145,7 @@ void WINDOWS_TABLE::InitializeTable() {
 
 // Logic for Cell Windows to construct and display the appropriate CELL based upon user input string
 CELL::CELL_PROXY WINDOWS_TABLE::CreateNewCell(const CELL::CELL_POSITION pos, const string& rawInput) const {
-	auto oldCell = m_CellData.GetCellProxy(pos);
-	auto nCell = CELL::NewCell(&m_CellData, pos, rawInput);
-	auto oldText = string{ };
-	!oldCell ? oldText = ""s : oldText = oldCell->GetRawContent();
-	if (rawInput != oldText) { m_UndoStack.emplace_back(oldCell, nCell); m_RedoStack.clear(); }
-	return nCell;
+	return m_History.NewCell(pos, rawInput);
 }
 
 WINDOWS_TABLE::~WINDOWS_TABLE() { }		// Hook for any on-exit logic
@@ -237,16 +234,24 @@ void WINDOWS_TABLE::Resize() {
 }
 
 void WINDOWS_TABLE::UpdateCell(const CELL::CELL_POSITION position) const {
-	auto cell = m_CellData.GetCellProxy(position);
+	auto cell = m_CellData.GetCellView(position);
 	auto text = string{ };
 	!cell ? text = ""s : text = cell->GetOutput();
 	WINDOW{ CELL_ID{ position } }.Text(text);
 }
 
+// Redraw the cells changed by one edit, suspending painting of the table until all of them hold their new text.
+void WINDOWS_TABLE::UpdateCells(std::span<const CELL::CELL_POSITION> positions) const {
+	SendMessage(m_Table, WM_SETREDRAW, FALSE, 0);
+	for (auto pos : positions) { UpdateCell(pos); }
+	SendMessage(m_Table, WM_SETREDRAW, TRUE, 0);
+	RedrawWindow(m_Table, nullptr, nullptr, RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN);
+}
+
 // Manage Focusing a cell in various contexts
 void WINDOWS_TABLE::FocusCell(const CELL::CELL_POSITION pos) const {
 	auto window = WINDOW{ CELL_ID{ pos } };
-	auto cell = m_CellData.GetCellProxy(pos);
+	auto cell = m_CellData.GetCellView(pos);
 	auto text = string{ };
 	m_MostRecentCell = pos;
 	if (pos == m_PosTargetCell) {						// If returning focus from upper-entry box...
@@ -317,32 +322,7 @@ void WINDOWS_TABLE::ReleaseTargetCell() const { m_PosTargetCell = CELL::CELL_POS
 
 CELL::CELL_POSITION WINDOWS_TABLE::TargetCellGet() const { return m_PosTargetCell; }
 
-// Transition: Cell B -> Cell A
-// Move the transition pair {Cell A -> Cell B} onto redo stack
-// If Cell A is NULL, then infer its position from Cell B
-void WINDOWS_TABLE::Undo() const {
-	if (m_UndoStack.empty()) { return; }
-	auto cell = m_UndoStack.back().first;
-	auto otherCell = m_UndoStack.back().second;
-	auto pos = CELL::CELL_POSITION{ };
-	if (cell) { pos = cell->GetPosition(); }
-	else { pos = otherCell->GetPosition(); }
-	CELL::RecreateCell(&m_CellData, cell, pos);			// Null cells need their position
-	m_RedoStack.push_back(m_UndoStack.back());
-	m_UndoStack.pop_back();
-}
+// Each step is undone or redone inside one batch, so it recalculates once (see Edit_History.hpp).
+void WINDOWS_TABLE::Undo() const { m_History.Undo(); }
 
-// Transition: Cell A -> Cell B
-// Move the transition pair {Cell A -> Cell B} onto undo stack
-// If Cell B is NULL, then infer its position from the Cell A
-void WINDOWS_TABLE::Redo() const {
-	if (m_RedoStack.empty()) { return; }
-	auto cell = m_RedoStack.back().second;
-	auto otherCell = m_RedoStack.back().first;
-	auto pos = CELL::CELL_POSITION{ };
-	if (cell) { pos = cell->GetPosition(); }
-	else { pos = otherCell->GetPosition(); }
-	CELL::RecreateCell(&m_CellData, cell, pos);
-	m_UndoStack.push_back(m_RedoStack.back());
-	m_RedoStack.pop_back();
-}
+void WINDOWS_TABLE::Redo() const { m_History.Redo(); }
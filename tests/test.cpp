@@ -1,7 +1,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include "Cell.hpp"
+#include "Snapshot.hpp"
 #include "Table.hpp"
+#include <atomic>
 #include <optional>
+#include <span>
+#include <thread>
 
 class TEST_TABLE : public TABLE_BASE {
 public:
@@ -16,6 +20,8 @@ public:
 	CELL::CELL_POSITION RequestCellPos() const { return CELL::CELL_POSITION{ }; };
 
 	mutable std::optional<CELL::CELL_POSITION> lastUpdatedPosition_;
+	mutable std::size_t updateCount_{ 0 };		// Positions reported
+	mutable std::size_t notificationCount_{ 0 };	// Calls made
 protected:
 	// Unused functions
 	// @todo, remove unused functions from base class interface
@@ -37,7 +43,8 @@ protected:
 	void FocusLeft1(const CELL::CELL_POSITION) const override { }
 	void LockTargetCell(const CELL::CELL_POSITION) const override { }
 	void ReleaseTargetCell() const override { }
-	void UpdateCell(const CELL::CELL_POSITION position) const override { lastUpdatedPosition_ = position; };
+	void UpdateCell(const CELL::CELL_POSITION position) const override { lastUpdatedPosition_ = position; ++updateCount_; };
+	void UpdateCells(std::span<const CELL::CELL_POSITION> positions) const override { for (auto pos : positions) { UpdateCell(pos); } ++notificationCount_; };
 	CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
 };
 
@@ -144,3 +151,484 @@ TEST_CASE("Preceeding Apostrophe Forces Interpretation As Text") {
 	REQUIRE(bool{ functionTextCell });
 	CHECK(functionTextCell->GetOutput() == functionAsText.data());
 }
+
+TEST_CASE("Numerical Cell Reports Typed Value") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto position = CELL::CELL_POSITION{ 1, 1 };
+
+	auto cell = CELL::NewCell(&cellData, position, "2.5");
+	REQUIRE(bool{ cell });
+	auto value = cell->GetValue();
+	REQUIRE(std::holds_alternative<double>(value));
+	CHECK(std::get<double>(value) == 2.5);
+}
+
+TEST_CASE("Function Reads Referenced Value Without Precision Loss") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	constexpr auto preciseText = std::string_view{ "0.1234567890123" };
+
+	CELL::NewCell(&cellData, { 1, 1 }, std::string{ preciseText });
+	auto function = CELL::NewCell(&cellData, { 1, 2 }, "=SUM(&R1C1)");
+	auto reference = CELL::NewCell(&cellData, { 1, 3 }, "&R1C1");
+	REQUIRE(bool{ function });
+	REQUIRE(bool{ reference });
+	CHECK(std::get<double>(function->GetValue()) == 0.1234567890123);
+	CHECK(std::get<double>(reference->GetValue()) == 0.1234567890123);
+}
+
+TEST_CASE("Reference To Text Or Missing Cell Is An Error") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	auto dangling = CELL::NewCell(&cellData, { 1, 1 }, "&R5C5");
+	REQUIRE(bool{ dangling });
+	CHECK(dangling->GetOutput() == "!REF!");
+
+	CELL::NewCell(&cellData, { 2, 1 }, "label");
+	auto function = CELL::NewCell(&cellData, { 3, 1 }, "=SUM(&R1C2)");
+	REQUIRE(bool{ function });
+	CHECK(std::holds_alternative<CELL::CELL_ERROR>(function->GetValue()));
+	CHECK(function->GetOutput() == "!ERROR!");
+}
+
+TEST_CASE("Diamond Dependency Recalculates Each Cell Once") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	// R1C1 feeds R2C1 and R3C1, which both feed R4C1
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	auto left = CELL::NewCell(&cellData, { 1, 2 }, "=SUM(&R1C1, 1)");
+	auto right = CELL::NewCell(&cellData, { 1, 3 }, "=SUM(&R1C1, 2)");
+	auto bottom = CELL::NewCell(&cellData, { 1, 4 }, "=SUM(&R2C1, &R3C1)");
+	REQUIRE(bool{ bottom });
+	CHECK(std::get<double>(bottom->GetValue()) == 5.0);
+
+	auto leftBefore = left->GetRecalculationCount();
+	auto rightBefore = right->GetRecalculationCount();
+	auto bottomBefore = bottom->GetRecalculationCount();
+	auto totalBefore = cellData.RecalculationCount();
+	CELL::NewCell(&cellData, { 1, 1 }, "10");
+	CHECK(left->GetRecalculationCount() - leftBefore == 1);
+	CHECK(right->GetRecalculationCount() - rightBefore == 1);
+	CHECK(bottom->GetRecalculationCount() - bottomBefore == 1);
+	CHECK(cellData.RecalculationCount() - totalBefore == 3);
+	CHECK(std::get<double>(bottom->GetValue()) == 23.0);
+}
+
+TEST_CASE("Each Edit Notifies The Table Once") {
+	table = std::make_unique<TEST_TABLE>();
+	auto testTable = static_cast<TEST_TABLE*>(table.get());
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	CELL::NewCell(&cellData, { 1, 2 }, "=SUM(&R1C1, 1)");
+	CELL::NewCell(&cellData, { 1, 3 }, "=SUM(&R1C1, 2)");
+	CELL::NewCell(&cellData, { 1, 4 }, "=SUM(&R2C1, &R3C1)");
+
+	auto notifications = testTable->notificationCount_;
+	auto updates = testTable->updateCount_;
+	CELL::NewCell(&cellData, { 1, 1 }, "10");
+	CHECK(testTable->notificationCount_ - notifications == 1);
+	CHECK(testTable->updateCount_ - updates == 4);		// The edited cell & its 3 dependents, each once
+
+	notifications = testTable->notificationCount_;
+	CELL::NewCell(&cellData, { 2, 1 }, "1.5x");			// Failed number falls back to text through a second, nested edit
+	CELL::NewCell(&cellData, { 1, 1 }, "");				// Erasing reports the emptied position too
+	CHECK(testTable->notificationCount_ - notifications == 2);
+	CHECK(testTable->lastUpdatedPosition_ == CELL::CELL_POSITION{ 1, 4 });
+}
+
+TEST_CASE("Reading Cells Never Notifies") {
+	table = std::make_unique<TEST_TABLE>();
+	auto testTable = static_cast<TEST_TABLE*>(table.get());
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "2");
+	auto formula = CELL::NewCell(&cellData, { 1, 2 }, "=&R1C1 * 3");
+	auto recalculations = cellData.RecalculationCount();
+	auto notifications = testTable->notificationCount_;
+
+	auto view = cellData.GetCellView({ 1, 2 });
+	auto copy = view;
+	auto proxies = std::vector<CELL::CELL_PROXY>{ };
+	for (auto i = 0; i < 10; ++i) { proxies.push_back(cellData.GetCellProxy({ 1, 1 })); }
+	auto another = proxies.front();
+	another = formula;
+	REQUIRE(bool{ copy });
+	CHECK(copy->GetOutput() == formula->GetOutput());
+	CHECK(copy == formula.View());
+	CHECK(cellData.RecalculationCount() == recalculations);
+	CHECK(testTable->notificationCount_ == notifications);
+	CHECK_FALSE(bool{ cellData.GetCellView({ 9, 9 }) });
+}
+
+TEST_CASE("Long Reference Chain Updates Without Recursion") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	constexpr auto chainLength = 20000u;
+
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	for (auto r = 2u; r <= chainLength; ++r) { CELL::NewCell(&cellData, { 1, r }, "&R" + std::to_string(r - 1) + "C1"); }
+	CELL::NewCell(&cellData, { 1, 1 }, "42");
+	auto tail = cellData.GetCellProxy({ 1, chainLength });
+	REQUIRE(bool{ tail });
+	CHECK(std::get<double>(tail->GetValue()) == 42.0);
+}
+
+TEST_CASE("Two Cell Reference Loop Reports Circular Error") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	auto first = CELL::NewCell(&cellData, { 1, 1 }, "&R1C2");
+	auto second = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1, 1)");
+	REQUIRE(bool{ first });
+	REQUIRE(bool{ second });
+	CHECK(first->GetOutput() == "!CIRC!");
+	CHECK(second->GetOutput() == "!CIRC!");
+}
+
+TEST_CASE("Breaking A Reference Loop Clears Circular Error") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	// R1C1 -> R1C2 -> R1C3 -> R1C1, plus R2C1 downstream of the loop
+	CELL::NewCell(&cellData, { 1, 1 }, "=SUM(&R1C3, 1)");
+	CELL::NewCell(&cellData, { 2, 1 }, "&R1C1");
+	CELL::NewCell(&cellData, { 3, 1 }, "=SUM(&R1C2, 1)");
+	auto downstream = CELL::NewCell(&cellData, { 1, 2 }, "=SUM(&R1C3)");
+	REQUIRE(bool{ downstream });
+	CHECK(cellData.GetCellProxy({ 1, 1 })->GetOutput() == "!CIRC!");
+	CHECK(cellData.GetCellProxy({ 2, 1 })->GetOutput() == "!CIRC!");
+	CHECK(cellData.GetCellProxy({ 3, 1 })->GetOutput() == "!CIRC!");
+	CHECK(downstream->GetOutput() == "!ERROR!");		// Depends on the loop, but is not part of it
+
+	CELL::NewCell(&cellData, { 3, 1 }, "5");
+	CHECK(std::get<double>(cellData.GetCellProxy({ 1, 1 })->GetValue()) == 6.0);
+	CHECK(std::get<double>(cellData.GetCellProxy({ 2, 1 })->GetValue()) == 6.0);
+	CHECK(std::get<double>(downstream->GetValue()) == 5.0);
+}
+
+TEST_CASE("Reference To Self Is Circular") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	auto cell = CELL::NewCell(&cellData, { 1, 1 }, "=SUM(&R1C1, 1)");
+	REQUIRE(bool{ cell });
+	CHECK(cell->GetOutput() == "!CIRC!");
+}
+
+TEST_CASE("Replacing A Cell Keeps Subscriptions Of The New Cell") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	auto oldCell = CELL::NewCell(&cellData, { 2, 1 }, "&R1C1");
+	auto newCell = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1)");
+	oldCell = CELL::CELL_PROXY{ };		// Releasing the replaced cell must not unsubscribe its replacement
+	CELL::NewCell(&cellData, { 1, 1 }, "7");
+	CHECK(std::get<double>(newCell->GetValue()) == 7.0);
+}
+
+TEST_CASE("Function Recovers Once Missing Reference Is Filled") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	auto function = CELL::NewCell(&cellData, { 1, 1 }, "=SUM(&R2C1, 1)");
+	REQUIRE(bool{ function });
+	CHECK(function->GetOutput() == "!ERROR!");
+	CELL::NewCell(&cellData, { 1, 2 }, "2");
+	CHECK(std::get<double>(function->GetValue()) == 3.0);
+}
+
+TEST_CASE("Parallel Recalculation Matches Serial Recalculation") {
+	table = std::make_unique<TEST_TABLE>();
+	auto serial = CELL::CELL_DATA{ };
+	auto parallel = CELL::CELL_DATA{ 4 };
+	REQUIRE(parallel.WorkerCount() == 4);
+
+	// Wide fan-out from R1C1, followed by a second level reading the first.
+	for (auto cellData : { &serial, &parallel }) {
+		CELL::NewCell(cellData, { 1, 1 }, "1");
+		for (auto r = 1u; r <= 1000; ++r) {
+			CELL::NewCell(cellData, { 2, r }, "=SUM(&R1C1, " + std::to_string(r) + ")");
+			CELL::NewCell(cellData, { 3, r }, "=PRODUCT(&R" + std::to_string(r) + "C2, 2)");
+		}
+		CELL::NewCell(cellData, { 1, 1 }, "10");
+	}
+
+	CHECK(serial.RecalculationCount() == parallel.RecalculationCount());
+	auto allMatch = true;
+	for (auto r = 1u; r <= 1000; ++r) {
+		auto expected = (10.0 + r) * 2;
+		if (std::get<double>(parallel.GetCellProxy({ 3, r })->GetValue()) != expected) { allMatch = false; }
+		if (std::get<double>(serial.GetCellProxy({ 3, r })->GetValue()) != expected) { allMatch = false; }
+	}
+	CHECK(allMatch);
+}
+
+TEST_CASE("Function Cell Evaluates Operators") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	CELL::NewCell(&cellData, { 1, 1 }, "6");
+	CELL::NewCell(&cellData, { 2, 2 }, "5");
+	auto cell = CELL::NewCell(&cellData, { 3, 3 }, "=SUM(&R1C1, 2) * (3 + &R2C2) / 4");
+	REQUIRE(bool{ cell });
+	CHECK(std::get<double>(cell->GetValue()) == 16.0);
+
+	CELL::NewCell(&cellData, { 2, 2 }, "1");
+	CHECK(std::get<double>(cell->GetValue()) == 8.0);
+}
+
+TEST_CASE("Filled Down Formulas Share One Compiled Program") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	for (auto r = 1u; r <= 100; ++r) {
+		CELL::NewCell(&cellData, { 1, r }, std::to_string(r));
+		CELL::NewCell(&cellData, { 2, r }, "=SUM(&R" + std::to_string(r) + "C1, 1)");
+	}
+	CHECK(cellData.CachedFormulaCount() == 1);
+	CHECK(std::get<double>(cellData.GetCellProxy({ 2, 50 })->GetValue()) == 51.0);
+
+	CELL::NewCell(&cellData, { 1, 50 }, "7");
+	CHECK(std::get<double>(cellData.GetCellProxy({ 2, 50 })->GetValue()) == 8.0);
+	CHECK(std::get<double>(cellData.GetCellProxy({ 2, 49 })->GetValue()) == 50.0);
+}
+
+TEST_CASE("Range Functions Follow Their Cells") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	for (auto r = 1u; r <= 100; ++r) { CELL::NewCell(&cellData, { 1, r }, std::to_string(r)); }
+	CELL::NewCell(&cellData, { 1, 50 }, "text is skipped");
+	auto sum = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1:R200C1)");
+	auto count = CELL::NewCell(&cellData, { 2, 2 }, "=COUNT(&R1C1:R200C1)");
+	auto maximum = CELL::NewCell(&cellData, { 2, 3 }, "=MAX(&R1C1:R200C1)");
+	CHECK(std::get<double>(sum->GetValue()) == 5050.0 - 50);
+	CHECK(std::get<double>(count->GetValue()) == 99.0);
+	CHECK(std::get<double>(maximum->GetValue()) == 100.0);
+
+	CELL::NewCell(&cellData, { 1, 150 }, "1000");		// Previously empty cell inside the range
+	CHECK(std::get<double>(sum->GetValue()) == 6000.0);
+	CHECK(std::get<double>(count->GetValue()) == 100.0);
+	CHECK(std::get<double>(maximum->GetValue()) == 1000.0);
+
+	CELL::NewCell(&cellData, { 1, 10 }, "&R999C9");		// Dangling reference: error fails the range
+	CHECK(sum->GetOutput() == "!ERROR!");
+}
+
+TEST_CASE("Range Recalculates After Formulas Inside It") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+
+	auto input = CELL::NewCell(&cellData, { 3, 1 }, "1");
+	for (auto r = 1u; r <= 10; ++r) { CELL::NewCell(&cellData, { 1, r }, "=&R1C3 * " + std::to_string(r)); }
+	auto sum = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1:R10C1)");
+	CHECK(std::get<double>(sum->GetValue()) == 55.0);
+
+	auto before = sum->GetRecalculationCount();
+	CELL::NewCell(&cellData, { 3, 1 }, "2");
+	CHECK(std::get<double>(sum->GetValue()) == 110.0);
+	CHECK(sum->GetRecalculationCount() == before + 1);		// Once, after every formula it covers
+
+	CELL::NewCell(&cellData, { 1, 4 }, "=&R1C2");				// Formula inside the range reading the range
+	CHECK(sum->GetOutput() == "!CIRC!");
+	CELL::NewCell(&cellData, { 1, 4 }, "0");
+	CHECK(std::get<double>(sum->GetValue()) == 102.0);
+}
+
+TEST_CASE("Snapshots Never Show A Half-Applied Change") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	constexpr auto dependents{ 50u };
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	for (auto r = 1u; r <= dependents; ++r) { CELL::NewCell(&cellData, { 2, r }, "=&R1C1 * " + std::to_string(r)); }
+
+	auto stop = std::atomic<bool>{ false };
+	auto torn = std::atomic<int>{ 0 };
+	auto versions = std::atomic<int>{ 0 };
+	auto reader = std::thread([&cellData, &stop, &torn, &versions] {
+		auto lastVersion = std::uint64_t{ 0 };
+		while (!stop) {
+			auto snapshot = cellData.Snapshot();
+			if (snapshot->Version() != lastVersion) { ++versions; lastVersion = snapshot->Version(); }
+			auto input = std::get<double>(snapshot->Find({ 1, 1 })->Value());
+			for (auto r = 1u; r <= dependents; ++r) { if (std::get<double>(snapshot->Find({ 2, r })->Value()) != input * r) { ++torn; } }
+		}
+	});
+	for (auto i = 2; i <= 300; ++i) { CELL::NewCell(&cellData, { 1, 1 }, std::to_string(i)); }
+	stop = true;
+	reader.join();
+	CHECK(torn == 0);
+	CHECK(versions > 0);
+	CHECK(std::get<double>(cellData.Snapshot()->Find({ 2, 7 })->Value()) == 2100.0);
+}
+
+TEST_CASE("Pinned Snapshot Keeps Its Version Until Released") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "5");
+	CELL::NewCell(&cellData, { 1, 2 }, "=&R1C1 + 1");
+	auto pinned = cellData.Snapshot();
+	auto version = pinned->Version();
+
+	CELL::NewCell(&cellData, { 1, 1 }, "7");
+	CELL::NewCell(&cellData, { 1, 3 }, "text");
+	CELL::NewCell(&cellData, { 1, 2 }, "");
+	CHECK(std::get<double>(pinned->Find({ 1, 2 })->Value()) == 6.0);
+	CHECK(pinned->Find({ 1, 2 })->RawContent() == "=&R1C1 + 1");
+	CHECK(pinned->Find({ 1, 3 }) == nullptr);
+
+	auto latest = cellData.Snapshot();
+	CHECK(latest->Version() == version + 3);
+	CHECK(latest->Find({ 1, 2 }) == nullptr);
+	CHECK(latest->Find({ 1, 3 })->GetOutput() == "text");
+
+	auto watch = std::weak_ptr<const SHEET_SNAPSHOT>{ pinned };
+	pinned.reset();
+	EPOCH::Collect();
+	CHECK(watch.expired());		// Reclaimed once unpinned
+}
+
+TEST_CASE("Batch Recalculates Each Dependent Once At Commit") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto sum = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1:R100C1)");
+	auto twice = CELL::NewCell(&cellData, { 2, 2 }, "=&R2C1 * 2");
+	auto before = sum->GetRecalculationCount();
+	auto version = cellData.Snapshot()->Version();
+	auto testTable = static_cast<TEST_TABLE*>(table.get());
+	auto updates = testTable->updateCount_;
+	auto notifications = testTable->notificationCount_;
+
+	auto batch = CELL::BATCH{ &cellData };
+	for (auto r = 1u; r <= 100; ++r) { batch.NewCell({ 1, r }, std::to_string(r)); }
+	CHECK(std::get<double>(sum->GetValue()) == 0.0);		// Nothing propagates before the commit
+	CHECK(testTable->updateCount_ == updates);
+	auto edits = batch.Commit();
+
+	CHECK(edits.size() == 100);
+	CHECK(std::get<double>(sum->GetValue()) == 5050.0);
+	CHECK(std::get<double>(twice->GetValue()) == 4.0);
+	CHECK(sum->GetRecalculationCount() == before + 1);
+	CHECK(cellData.Snapshot()->Version() == version + 1);
+	CHECK(testTable->updateCount_ - updates == 102);		// Once per changed cell: 100 values & 2 formulas
+	CHECK(testTable->notificationCount_ == notifications + 1);
+}
+
+TEST_CASE("Batch Orders Cells Entered Before Their Inputs") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto total = cellData.RecalculationCount();
+	{
+		auto batch = CELL::BATCH{ &cellData };
+		batch.NewCell({ 1, 1 }, "=&R1C2 * 2");
+		batch.NewCell({ 2, 1 }, "&R1C3");
+		batch.NewCell({ 3, 1 }, "5");
+		batch.NewCell({ 4, 1 }, "12abc");			// Numerical fallback creates a text cell inside the batch
+		{
+			auto inner = CELL::BATCH{ &cellData };	// Nested batches commit with the outermost one
+			inner.NewCell({ 5, 1 }, "=&R1C1 + 1");
+		}
+		CHECK(cellData.RecalculationCount() == total);
+	}
+	CHECK(std::get<double>(cellData.GetCellProxy({ 1, 1 })->GetValue()) == 10.0);
+	CHECK(std::get<double>(cellData.GetCellProxy({ 5, 1 })->GetValue()) == 11.0);
+	CHECK(cellData.GetCellProxy({ 4, 1 })->GetOutput() == "12abc");
+	CHECK(cellData.RecalculationCount() - total == 3);		// Each formula & reference once
+}
+
+TEST_CASE("Batch Edits Undo As One Step") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	auto sum = CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1:R3C1)");
+
+	auto edits = std::vector<CELL::EDIT>{ };
+	{
+		auto batch = CELL::BATCH{ &cellData };
+		batch.NewCell({ 1, 1 }, "10");
+		batch.NewCell({ 1, 2 }, "20");
+		batch.NewCell({ 1, 3 }, "30");
+		batch.NewCell({ 1, 3 }, "30");				// Unchanged, so not recorded
+		edits = batch.Commit();
+	}
+	REQUIRE(edits.size() == 3);
+	CHECK(std::get<double>(sum->GetValue()) == 60.0);
+
+	auto before = sum->GetRecalculationCount();
+	{
+		auto batch = CELL::BATCH{ &cellData };
+		for (auto it = edits.rbegin(); it != edits.rend(); ++it) {
+			auto pos = it->first ? it->first->GetPosition() : it->second->GetPosition();
+			batch.RecreateCell(it->first, pos);
+		}
+	}
+	CHECK(std::get<double>(sum->GetValue()) == 1.0);
+	CHECK(sum->GetRecalculationCount() == before + 1);
+	CHECK_FALSE(bool{ cellData.GetCellProxy({ 1, 2 }) });
+}
+
+TEST_CASE("Plain Values Are Kept In The Grid") {
+	table = std::make_unique<TEST_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto number = CELL::NewCell(&cellData, { 1, 1 }, "2.5");
+	CELL::NewCell(&cellData, { 1, 2 }, "label");
+	CELL::NewCell(&cellData, { 1, 3 }, "label");
+	CELL::NewCell(&cellData, { 1, 4 }, "'label");
+	CHECK(cellData.CellCount() == 4);
+	CHECK(cellData.ObjectCount() == 0);
+	CHECK(cellData.TextCount() == 2);
+	CHECK(std::get<double>(number->GetValue()) == 2.5);
+	CHECK(std::get<std::string>(cellData.GetCellView({ 1, 4 })->GetValue()) == "label");
+	CHECK(number == cellData.GetCellProxy({ 1, 1 }));
+	CHECK(number.View() == cellData.GetCellView({ 1, 1 }));
+
+	// A number a plain value would not write back the same way keeps its cell. A failed number becomes text, as before.
+	CHECK(CELL::NewCell(&cellData, { 2, 1 }, "1.50")->GetRawContent() == "1.50");
+	CHECK(CELL::NewCell(&cellData, { 2, 2 }, "12abc")->GetRawContent() == "'12abc");
+	auto sum = CELL::NewCell(&cellData, { 2, 3 }, "=SUM(&R1C1:R2C1)");
+	CHECK(cellData.ObjectCount() == 2);
+	CHECK(std::get<double>(sum->GetValue()) == 2.5);
+
+	CELL::NewCell(&cellData, { 1, 1 }, "4");
+	CHECK(std::get<double>(sum->GetValue()) == 4.0);
+	CHECK_FALSE(number == cellData.GetCellProxy({ 1, 1 }));
+	CELL::RecreateCell(&cellData, number, { 1, 1 });		// As an undo would
+	CHECK(std::get<double>(sum->GetValue()) == 2.5);
+	CHECK(cellData.ObjectCount() == 2);
+
+	CELL::NewCell(&cellData, { 1, 2 }, "");
+	CELL::NewCell(&cellData, { 1, 3 }, "");
+	CHECK(cellData.TextCount() == 3);				// 'label, '12abc & 1.50. Formulas keep their own.
+}
+
+TEST_CASE("Equal Text Is Stored Once Per Sheet") {
+	table = std::make_unique<TEST_TABLE>();
+	auto snapshot = std::shared_ptr<const SHEET_SNAPSHOT>{ };
+	{
+		auto cellData = CELL::CELL_DATA{ };
+		const auto label = std::string{ "Quarterly total for the northern region" };
+		for (auto r = 1u; r <= 100; ++r) {
+			CELL::NewCell(&cellData, { 1, r }, label);
+			CELL::NewCell(&cellData, { 2, r }, "&R1C1");
+		}
+		CHECK(cellData.TextCount() == 1);				// Shared by every cell, reference & snapshot entry showing it
+		CHECK(cellData.TextBytes() == label.size());
+		CHECK(std::get<std::string>(cellData.GetCellView({ 2, 50 })->GetValue()) == label);
+
+		CELL::NewCell(&cellData, { 1, 1 }, "'" + label);
+		CHECK(cellData.TextCount() == 2);
+		snapshot = cellData.Snapshot();
+		CHECK(std::get<std::string>(snapshot->Find({ 1, 1 })->Value()) == label);
+		CHECK(snapshot->Find({ 1, 1 })->RawContent() == "'" + label);
+		CHECK(snapshot->Find({ 2, 1 })->RawContent() == "&R1C1");
+
+		for (auto r = 1u; r <= 100; ++r) { CELL::NewCell(&cellData, { 1, r }, ""); }
+		CHECK(std::get<CELL::CELL_ERROR>(cellData.GetCellView({ 2, 1 })->GetValue()) == CELL::CELL_ERROR::REFERENCE);
+	}
+	// A snapshot outlives its sheet, and keeps its text.
+	CHECK(snapshot->Find({ 1, 2 })->GetOutput() == "Quarterly total for the northern region");
+	CHECK(snapshot->Find({ 2, 2 })->GetOutput() == "Quarterly total for the northern region");
+}
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Csv_File.hpp"
+#include "Snapshot.hpp"
+#include "Table.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+
+namespace {
+	// Counts calls to UpdateCells & ignores everything else.
+	class COUNTING_TABLE : public TABLE_BASE {
+	public:
+		void InitializeTable() override { }
+		void Redraw() const override { }
+		void Undo() const override { }
+		void Redo() const override { }
+		CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override { return CELL::CELL_PROXY{ nullptr }; }
+		void UpdateCell(const CELL::CELL_POSITION) const override { }
+		void UpdateCells(std::span<const CELL::CELL_POSITION>) const override { ++notifications; }
+		mutable std::size_t notifications{ 0 };
+	protected:
+		void Resize() override { }
+		void AddRow() override { }
+		void AddColumn() override { }
+		void RemoveRow() override { }
+		void RemoveColumn() override { }
+		unsigned int GetNumColumns() const override { return 0; }
+		unsigned int GetNumRows() const override { return 0; }
+		void FocusCell(const CELL::CELL_POSITION) const override { }
+		void UnfocusCell(const CELL::CELL_POSITION) const override { }
+		void FocusEntryBox() const override { }
+		void UnfocusEntryBox(const CELL::CELL_POSITION) const override { }
+		void FocusUp1(const CELL::CELL_POSITION) const override { }
+		void FocusDown1(const CELL::CELL_POSITION) const override { }
+		void FocusRight1(const CELL::CELL_POSITION) const override { }
+		void FocusLeft1(const CELL::CELL_POSITION) const override { }
+		void LockTargetCell(const CELL::CELL_POSITION) const override { }
+		void ReleaseTargetCell() const override { }
+		CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
+	};
+
+	double Number(const CELL::CELL_DATA& cellData, const CELL::CELL_POSITION pos) { return std::get<double>(cellData.GetCellView(pos)->GetValue()); }
+	std::string Output(const CELL::CELL_DATA& cellData, const CELL::CELL_POSITION pos) { return cellData.GetCellView(pos)->GetOutput(); }
+}
+
+TEST_CASE("CSV Import Enters Fields As Typed") {
+	const auto input = std::string{
+		"1,2,=SUM(&R1C1:R1C2)\r\n"
+		"text,\"quoted, with comma\",\"say \"\"hi\"\"\"\n"
+		"\n"
+		",,&R1C3\n"
+		"\"multi\nline\",12abc,-3.5\n"
+		"12\" tv,1\n"													// A stray quote inside a field quotes nothing
+		"15\" tv,2\n"
+		"e,3\n"
+		"f,4" };
+
+	for (auto chunkSize : { std::size_t{ 3 }, std::size_t{ 8 }, std::size_t{ 16 }, CSV_FILE::DefaultChunkSize }) {		// Chunks cut inside quotes, fields & records alike
+		auto counting = std::make_unique<COUNTING_TABLE>();
+		auto& notifications = counting->notifications;
+		table = std::move(counting);
+		auto cellData = CELL::CELL_DATA{ 2 };
+		auto in = std::istringstream{ input };
+		CHECK(CSV_FILE::Import(cellData, in, { 1, 1 }, chunkSize) == 18);
+
+		CHECK(Number(cellData, { 1, 1 }) == 1.0);
+		CHECK(Number(cellData, { 2, 1 }) == 2.0);
+		CHECK(Number(cellData, { 3, 1 }) == 3.0);
+		CHECK(Output(cellData, { 1, 2 }) == "text");
+		CHECK(Output(cellData, { 2, 2 }) == "quoted, with comma");
+		CHECK(Output(cellData, { 3, 2 }) == "say \"hi\"");
+		CHECK_FALSE(bool{ cellData.GetCellView({ 1, 3 }) });
+		CHECK_FALSE(bool{ cellData.GetCellView({ 1, 4 }) });
+		CHECK(Number(cellData, { 3, 4 }) == 3.0);
+		CHECK(Output(cellData, { 1, 5 }) == "multi\nline");
+		CHECK(cellData.GetCellView({ 2, 5 })->GetRawContent() == "'12abc");		// Falls back to text, as if typed
+		CHECK(Number(cellData, { 3, 5 }) == -3.5);
+		CHECK(Output(cellData, { 1, 6 }) == "12\" tv");
+		CHECK(Output(cellData, { 1, 7 }) == "15\" tv");
+		CHECK(Output(cellData, { 1, 8 }) == "e");
+		CHECK(Output(cellData, { 1, 9 }) == "f");
+		CHECK(Number(cellData, { 2, 9 }) == 4.0);
+
+		CHECK(cellData.RecalculationCount() == 2);			// The formula & the reference, once each
+		CHECK(cellData.Snapshot()->Size() == 18);
+		CHECK(notifications == 1);
+	}
+}
+
+TEST_CASE("CSV Import At An Origin Leaves Other Cells Alone") {
+	table = std::make_unique<COUNTING_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "5");
+	CELL::NewCell(&cellData, { 3, 3 }, "old");
+	CELL::NewCell(&cellData, { 5, 5 }, "=&R4C3 + 1");		// Reads a cell the import fills in
+
+	auto in = std::istringstream{ "=&R1C1 * 2,\n,7\n" };
+	CHECK(CSV_FILE::Import(cellData, in, { 2, 3 }) == 2);
+	CHECK(Number(cellData, { 2, 3 }) == 10.0);
+	CHECK(Output(cellData, { 3, 3 }) == "old");				// Empty field
+	CHECK(Number(cellData, { 3, 4 }) == 7.0);
+	CHECK(Number(cellData, { 5, 5 }) == 8.0);
+	CHECK(Number(cellData, { 1, 1 }) == 5.0);
+}
+
+TEST_CASE("CSV Export Writes Outputs Row By Row") {
+	table = std::make_unique<COUNTING_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	CELL::NewCell(&cellData, { 1, 1 }, "1");
+	CELL::NewCell(&cellData, { 3, 1 }, "=&R1C1 * 2");
+	CELL::NewCell(&cellData, { 2, 3 }, "a,b");
+	CELL::NewCell(&cellData, { 1, 4 }, "say \"hi\"");
+	CELL::NewCell(&cellData, { 2, 4 }, "=&R3C2 + 1");		// Text in a formula is an error
+
+	auto out = std::ostringstream{ };
+	CSV_FILE::Export(*cellData.Snapshot(), out);
+	CHECK(out.str() == "1.000000,,2.000000\n\n,\"a,b\"\n\"say \"\"hi\"\"\",!ERROR!\n");
+
+	auto imported = CELL::CELL_DATA{ };
+	auto in = std::istringstream{ out.str() };
+	CHECK(CSV_FILE::Import(imported, in) == 5);
+	cellData.Snapshot()->ForEach([&imported](const SHEET_SNAPSHOT::ENTRY& entry) { CHECK(Output(imported, entry.position) == entry.GetOutput()); });
+
+	auto empty = std::ostringstream{ };
+	CSV_FILE::Export(*CELL::CELL_DATA{ }.Snapshot(), empty);
+	CHECK(empty.str().empty());
+}
@@ -0,0 +1,183 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Dependency_Graph.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+	using EDGES = std::set<std::pair<unsigned int, unsigned int>>;
+
+	CELL::CELL_POSITION Node(const unsigned int n) { return CELL::CELL_POSITION{ 1, n }; }
+
+	// Brute force: is the node reachable from itself?
+	bool OnLoop(const EDGES& edges, const unsigned int start) {
+		auto seen = std::set<unsigned int>{ };
+		auto pending = std::vector<unsigned int>{ start };
+		while (!pending.empty()) {
+			auto n = pending.back();
+			pending.pop_back();
+			for (auto& [subject, observer] : edges) {
+				if (subject != n) { continue; }
+				if (observer == start) { return true; }
+				if (seen.insert(observer).second) { pending.push_back(observer); }
+			}
+		}
+		return false;
+	}
+}
+
+TEST_CASE("Graph Orders Dependents After Their Subjects") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	graph.AddEdge(Node(3), Node(4));
+	graph.AddEdge(Node(2), Node(3));
+	graph.AddEdge(Node(1), Node(2));		// Each insertion runs against the previous order
+	auto order = graph.RecalculationOrder(Node(1));
+	CHECK(order == std::vector<CELL::CELL_POSITION>{ Node(2), Node(3), Node(4) });
+}
+
+TEST_CASE("Graph Marks Loop And Unmarks It When Broken") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	graph.AddEdge(Node(1), Node(2));
+	graph.AddEdge(Node(2), Node(3));
+	graph.AddEdge(Node(3), Node(1));
+	CHECK(graph.IsCircular(Node(1)));
+	CHECK(graph.IsCircular(Node(2)));
+	CHECK(graph.IsCircular(Node(3)));
+
+	graph.RemoveEdge(Node(1), Node(2));
+	CHECK_FALSE(graph.IsCircular(Node(1)));
+	CHECK_FALSE(graph.IsCircular(Node(2)));
+	CHECK_FALSE(graph.IsCircular(Node(3)));
+	CHECK(graph.RecalculationOrder(Node(2)) == std::vector<CELL::CELL_POSITION>{ Node(3), Node(1) });
+}
+
+TEST_CASE("Graph Grows A Loop Through A New Path") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	for (auto n = 10u; n < 100; n += 2) {					// Other loops, which the edits below need not look at
+		graph.AddEdge(Node(n), Node(n + 1));
+		graph.AddEdge(Node(n + 1), Node(n));
+	}
+	graph.AddEdge(Node(1), Node(2));
+	graph.AddEdge(Node(2), Node(1));
+	graph.AddEdge(Node(1), Node(3));
+	CHECK_FALSE(graph.IsCircular(Node(3)));
+	graph.AddEdge(Node(3), Node(2));						// Now on a path around the loop
+	CHECK(graph.IsCircular(Node(3)));
+
+	graph.RemoveEdge(Node(1), Node(3));
+	CHECK_FALSE(graph.IsCircular(Node(3)));
+	CHECK(graph.IsCircular(Node(1)));
+	CHECK(graph.IsCircular(Node(2)));
+	CHECK(graph.IsCircular(Node(50)));
+}
+
+TEST_CASE("Graph Loop Marks Stay Consistent Under Random Edits") {
+	constexpr auto nodes = 12u;
+	auto graph = DEPENDENCY_GRAPH{ };
+	auto edges = EDGES{ };
+	auto random = std::mt19937{ 12345 };
+	auto pick = std::uniform_int_distribution<unsigned int>{ 1, nodes };
+
+	for (auto step = 0; step < 2000; ++step) {
+		auto edge = std::pair{ pick(random), pick(random) };
+		if (edges.count(edge)) { graph.RemoveEdge(Node(edge.first), Node(edge.second)); edges.erase(edge); }
+		else { graph.AddEdge(Node(edge.first), Node(edge.second)); edges.insert(edge); }
+
+		for (auto n = 1u; n <= nodes; ++n) {
+			if (graph.IsCircular(Node(n))) { REQUIRE(OnLoop(edges, n)); }		// Never a false alarm
+			if (edges.count({ n, n })) { REQUIRE(graph.IsCircular(Node(n))); }
+		}
+
+		// Outside of loops, every cell must be recalculated after each of its subjects
+		auto order = graph.RecalculationOrder(Node(pick(random)));
+		for (auto& [subject, observer] : edges) {
+			if (graph.IsCircular(Node(subject)) || graph.IsCircular(Node(observer))) { continue; }
+			auto itSubject = std::find(order.begin(), order.end(), Node(subject));
+			auto itObserver = std::find(order.begin(), order.end(), Node(observer));
+			if (itSubject == order.end() || itObserver == order.end()) { continue; }
+			REQUIRE(itSubject < itObserver);
+		}
+	}
+
+	for (auto& [subject, observer] : edges) { graph.RemoveEdge(Node(subject), Node(observer)); }
+	for (auto n = 1u; n <= nodes; ++n) { CHECK_FALSE(graph.IsCircular(Node(n))); }
+}
+
+TEST_CASE("Graph Levels Cells Of Two Loops Sharing A Cell Apart") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	for (auto n = 100u; n < 400; ++n) { graph.AddEdge(Node(1), Node(n)); }		// A level wide enough to run in parallel
+	graph.AddEdge(Node(1), Node(2));
+	graph.AddEdge(Node(2), Node(3));
+	graph.AddEdge(Node(3), Node(2));						// One loop
+	graph.AddEdge(Node(3), Node(4));
+	graph.AddEdge(Node(4), Node(5));
+	graph.AddEdge(Node(5), Node(3));						// A second loop through the same cell
+	graph.AddEdge(Node(5), Node(6));
+	auto edges = EDGES{ { 1, 2 }, { 2, 3 }, { 3, 2 }, { 3, 4 }, { 4, 5 }, { 5, 3 }, { 5, 6 } };
+	for (auto n = 100u; n < 400; ++n) { edges.emplace(1, n); }
+
+	auto levels = graph.RecalculationLevels(Node(1));
+	auto levelOf = std::vector<std::size_t>(400, levels.size());
+	for (auto level = std::size_t{ 0 }; level < levels.size(); ++level) {
+		for (auto& pos : levels[level]) {
+			levelOf[pos.row] = level;
+			if (graph.IsCircular(pos)) { CHECK(levels[level].size() == 1); }
+		}
+	}
+	for (auto n = 2u; n <= 5; ++n) { CHECK(graph.IsCircular(Node(n))); }
+	for (auto& [subject, observer] : edges) {
+		if (subject == 1) { continue; }
+		CHECK(levelOf[subject] != levelOf[observer]);		// No cell reads another from its own level, loop or not
+	}
+	CHECK(levelOf[6] > levelOf[5]);
+}
+
+TEST_CASE("Graph Stores A Range As One Entry") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	graph.AddRangeEdge({ 1, 1 }, { 1, 60000 }, { 2, 1 });
+	CHECK(graph.RangeCount() == 1);
+	CHECK(graph.EdgeCount() == 0);
+	CHECK(graph.RecalculationOrder({ 1, 12345 }) == std::vector<CELL::CELL_POSITION>{ { 2, 1 } });
+	CHECK(graph.RecalculationOrder({ 1, 60001 }).empty());
+
+	graph.RemoveObserver({ 2, 1 });
+	CHECK(graph.RangeCount() == 0);
+	CHECK(graph.RecalculationOrder({ 1, 12345 }).empty());
+}
+
+TEST_CASE("Graph Orders Observing Cells Inside A Range") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	graph.AddRangeEdge({ 1, 1 }, { 1, 100 }, { 2, 1 });		// Range first
+	graph.AddEdge({ 3, 1 }, { 1, 50 });						// Then a cell inside it starts observing
+	graph.AddEdge({ 3, 2 }, { 1, 60 });
+	graph.AddRangeEdge({ 1, 40 }, { 1, 70 }, { 4, 1 });		// Observing cells first, then the range
+	CHECK(graph.EdgeCount() == 6);
+
+	auto order = graph.RecalculationOrder({ 3, 1 });
+	CHECK(order.size() == 3);
+	CHECK(order.front() == CELL::CELL_POSITION{ 1, 50 });
+
+	graph.RemoveObserver({ 1, 50 });						// Back to a plain value: no longer ordered, still covered
+	CHECK(graph.EdgeCount() == 3);
+	CHECK(graph.RecalculationOrder({ 1, 50 }).size() == 2);
+}
+
+TEST_CASE("Graph Finds Loops Through Ranges") {
+	auto graph = DEPENDENCY_GRAPH{ };
+	graph.AddRangeEdge({ 1, 1 }, { 1, 10 }, { 1, 20 });
+	graph.AddEdge({ 1, 20 }, { 1, 5 });						// Cell inside the range reads the range's observer
+	CHECK(graph.IsCircular({ 1, 5 }));
+	CHECK(graph.IsCircular({ 1, 20 }));
+	graph.RemoveObserver({ 1, 5 });
+	CHECK_FALSE(graph.IsCircular({ 1, 20 }));
+
+	graph.AddRangeEdge({ 2, 1 }, { 2, 10 }, { 2, 3 });		// Range covering its own observer
+	CHECK(graph.IsCircular({ 2, 3 }));
+
+	graph.AddEdge({ 9, 9 }, { 1, 7 });						// Explicit & derived edge between the same cells
+	graph.AddEdge({ 1, 7 }, { 1, 20 });
+	graph.RemoveEdge({ 1, 7 }, { 1, 20 });					// Still derived from the range
+	CHECK(graph.RecalculationOrder({ 9, 9 }).size() == 2);
+}
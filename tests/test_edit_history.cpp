@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Edit_History.hpp"
+#include "Table.hpp"
+#include <memory>
+#include <span>
+#include <string>
+
+namespace {
+	// Ignores every call. Edits only need somewhere to send their notifications.
+	class SILENT_TABLE : public TABLE_BASE {
+	public:
+		void InitializeTable() override { }
+		void Redraw() const override { }
+		void Undo() const override { }
+		void Redo() const override { }
+		CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override { return CELL::CELL_PROXY{ nullptr }; }
+		void UpdateCell(const CELL::CELL_POSITION) const override { }
+		void UpdateCells(std::span<const CELL::CELL_POSITION>) const override { }
+	protected:
+		void Resize() override { }
+		void AddRow() override { }
+		void AddColumn() override { }
+		void RemoveRow() override { }
+		void RemoveColumn() override { }
+		unsigned int GetNumColumns() const override { return 0; }
+		unsigned int GetNumRows() const override { return 0; }
+		void FocusCell(const CELL::CELL_POSITION) const override { }
+		void UnfocusCell(const CELL::CELL_POSITION) const override { }
+		void FocusEntryBox() const override { }
+		void UnfocusEntryBox(const CELL::CELL_POSITION) const override { }
+		void FocusUp1(const CELL::CELL_POSITION) const override { }
+		void FocusDown1(const CELL::CELL_POSITION) const override { }
+		void FocusRight1(const CELL::CELL_POSITION) const override { }
+		void FocusLeft1(const CELL::CELL_POSITION) const override { }
+		void LockTargetCell(const CELL::CELL_POSITION) const override { }
+		void ReleaseTargetCell() const override { }
+		CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
+	};
+
+	std::string Raw(const CELL::CELL_DATA& cellData, const CELL::CELL_POSITION pos) { auto cell = cellData.GetCellView(pos); return cell ? cell->GetRawContent() : std::string{ }; }
+	double Number(const CELL::CELL_DATA& cellData, const CELL::CELL_POSITION pos) { return std::get<double>(cellData.GetCellView(pos)->GetValue()); }
+}
+
+TEST_CASE("Edit History Undoes & Redoes Steps") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto history = EDIT_HISTORY{ &cellData };
+	history.NewCell({ 1, 1 }, "2");
+	history.NewCell({ 1, 2 }, "=&R1C1 * 10");
+	history.NewCell({ 1, 1 }, "2");					// Unchanged, so not a step
+	history.NewCell({ 0, 1 }, "nowhere");			// Not a position, so not a step
+	CHECK(history.UndoCount() == 2);
+	{
+		auto batch = CELL::BATCH{ &cellData };
+		batch.NewCell({ 1, 1 }, "3");
+		batch.NewCell({ 2, 1 }, "words");
+		batch.NewCell({ 1, 1 }, "4");				// Twice in one step
+		history.Record(batch.Commit());
+	}
+	history.NewCell({ 2, 1 }, "");
+	CHECK(Number(cellData, { 1, 2 }) == 40.0);
+
+	auto recalculations = cellData.RecalculationCount();
+	CHECK(history.Undo());							// The erase
+	CHECK(Raw(cellData, { 2, 1 }) == "words");
+	CHECK(history.Undo());							// The batch, recalculated once
+	CHECK(Raw(cellData, { 2, 1 }).empty());
+	CHECK(Number(cellData, { 1, 2 }) == 20.0);
+	CHECK(cellData.RecalculationCount() - recalculations == 1);		// The formula, once
+	CHECK(history.UndoCount() == 2);
+	CHECK(history.RedoCount() == 2);
+
+	CHECK(history.Redo());
+	CHECK(Raw(cellData, { 2, 1 }) == "words");
+	CHECK(Number(cellData, { 1, 2 }) == 40.0);
+	history.NewCell({ 3, 1 }, "new");				// Drops redo
+	CHECK(history.RedoCount() == 0);
+	CHECK_FALSE(history.Redo());
+
+	while (history.Undo()) { }
+	CHECK_FALSE(bool{ cellData.GetCellView({ 1, 1 }) });
+	CHECK_FALSE(bool{ cellData.GetCellView({ 1, 2 }) });
+	while (history.Redo()) { }
+	CHECK(Raw(cellData, { 3, 1 }) == "new");
+	CHECK(Number(cellData, { 1, 2 }) == 40.0);
+}
+
+TEST_CASE("Edit History Stays Within Its Budget") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto history = EDIT_HISTORY{ &cellData, 512 };
+	for (auto i = 1u; i <= 1000; ++i) { history.NewCell({ 1, 1 + i % 7 }, "=SUM(&R1C2:R" + std::to_string(i) + "C2) + 1"); }
+	CHECK(history.Size() <= 512);
+	CHECK(history.UndoCount() > 10);
+	CHECK(history.UndoCount() < 1000);
+
+	auto kept = history.UndoCount();				// Only the newest steps are kept, and each still undoes exactly
+	for (auto i = 0u; i < kept; ++i) { REQUIRE(history.Undo()); }
+	CHECK_FALSE(history.Undo());
+	CHECK(Raw(cellData, { 1, 1 + 1000 % 7 }) == "=SUM(&R1C2:R" + std::to_string(1000 - 7 * ((kept - 1) / 7 + 1)) + "C2) + 1");
+
+	history.NewCell({ 1, 1 }, std::string(600, 'x'));		// Too large to keep, so nothing before it can be undone either
+	CHECK(history.UndoCount() == 0);
+	CHECK(history.Size() == 0);
+}
+
+TEST_CASE("Edit History Stores What Changed") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto cellData = CELL::CELL_DATA{ };
+	auto history = EDIT_HISTORY{ &cellData };
+	auto formula = "=SUM(&R1C1:R100C1) + " + std::string(200, '1');
+	history.NewCell({ 2, 1 }, formula);
+	auto before = history.Size();
+	formula[16] = '9';
+	history.NewCell({ 2, 1 }, formula);				// One character changed
+	CHECK(history.Size() - before < formula.size() + 32);
+	history.Undo();
+	CHECK(Raw(cellData, { 2, 1 })[16] == '1');
+	history.Redo();
+	CHECK(Raw(cellData, { 2, 1 }) == formula);
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Epoch.hpp"
+#include "Slot_Grid.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Poisons itself on destruction, so a reader touching a destroyed object is caught.
+	struct CANARY {
+		std::atomic<bool>* destroyed{ nullptr };
+		int value{ 0 };
+		unsigned int alive{ 0xA11FE };
+		~CANARY() { alive = 0; if (destroyed) { *destroyed = true; } }
+	};
+}
+
+TEST_CASE("Epoch Destroys Retired Objects Once Unpinned") {
+	auto destroyed = std::atomic<bool>{ false };
+	auto object = std::make_shared<CANARY>();
+	object->destroyed = &destroyed;
+	EPOCH::Collect();
+	{
+		auto guard = EPOCH::GUARD{ };
+		auto nested = EPOCH::GUARD{ };
+		EPOCH::Retire(std::move(object));
+		CHECK_FALSE(destroyed);		// A reader is still pinned
+		CHECK(EPOCH::PendingCount() == 1);
+	}
+	EPOCH::Collect();
+	CHECK(destroyed);
+	CHECK(EPOCH::PendingCount() == 0);
+
+	auto unpinned = std::atomic<bool>{ false };
+	auto other = std::make_shared<CANARY>();
+	other->destroyed = &unpinned;
+	EPOCH::Retire(std::move(other));
+	CHECK(unpinned);				// Nobody reading: destroyed straight away
+}
+
+TEST_CASE("Epoch Retires Cheaply While A Reader Stays Pinned") {
+	constexpr auto count{ 200000u };
+	auto destroyed = std::atomic<unsigned int>{ 0 };
+	struct COUNTED { std::atomic<unsigned int>* destroyed; ~COUNTED() { ++*destroyed; } };
+	EPOCH::Collect();
+	{
+		auto guard = EPOCH::GUARD{ };
+		for (auto i = 0u; i < count; ++i) { EPOCH::Retire(std::make_shared<COUNTED>(&destroyed)); }		// Quadratic if each retire rescanned the others
+		CHECK(destroyed == 0);
+		CHECK(EPOCH::PendingCount() == count);
+	}
+	EPOCH::Collect();
+	CHECK(destroyed == count);
+	CHECK(EPOCH::PendingCount() == 0);
+}
+
+TEST_CASE("Slot Grid Readers Survive Concurrent Writers") {
+	using GRID = SLOT_GRID<const CANARY*, CELL::CELL_POSITION>;
+	auto grid = std::make_unique<GRID>();
+	constexpr auto rows{ 200u };
+	auto stop = std::atomic<bool>{ false };
+	auto failures = std::atomic<int>{ 0 };
+
+	auto readers = std::vector<std::thread>{ };
+	for (auto t = 0; t < 3; ++t) {
+		readers.emplace_back([&grid, &stop, &failures] {
+			while (!stop) {
+				auto guard = EPOCH::GUARD{ };
+				for (auto r = 1u; r <= rows; ++r) {
+					auto item = grid->Find({ 1, r });
+					if (item && (item->alive != 0xA11FE || item->value != int(r))) { ++failures; }
+				}
+				grid->ForEachIn({ 1, 1 }, { 1, rows }, [&failures](const CELL::CELL_POSITION pos, const CANARY* item) { if (item->alive != 0xA11FE || item->value != int(pos.row)) { ++failures; } });
+			}
+		});
+	}
+	auto retire = [](const CANARY* item) { if (item) { EPOCH::Retire(std::shared_ptr<const CANARY>(item)); } };		// The grid owns nothing: the writer retires what it replaces
+	for (auto pass = 0; pass < 200; ++pass) {
+		for (auto r = 1u; r <= rows; ++r) {
+			if ((pass + r) % 3 == 0) { retire(grid->Erase({ 1, r })); continue; }		// Also releases & recreates the tile
+			auto item = new CANARY{ };
+			item->value = int(r);
+			retire(grid->Assign({ 1, r }, item));
+		}
+	}
+	stop = true;
+	for (auto& reader : readers) { reader.join(); }
+	CHECK(failures == 0);
+	for (auto r = 1u; r <= rows; ++r) { retire(grid->Erase({ 1, r })); }
+	EPOCH::Collect();
+	CHECK(EPOCH::PendingCount() == 0);
+}
@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Formula.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace {
+	constexpr auto anchor = CELL::CELL_POSITION{ 10, 10 };		// Position of the cell holding each formula
+
+	// Loader used by formulas with no references.
+	FORMULA_PROGRAM::RESULT NoReferences(CELL::CELL_POSITION) { return FORMULA_PROGRAM::RESULT{ 0, "Reference Error" }; }
+}
+
+TEST_CASE("Formula Compiles To Postfix Instructions") {
+	auto program = FORMULA_PROGRAM::Compile("SUM(1, PRODUCT(2, 3))", anchor);
+	using OPCODE = FORMULA_PROGRAM::OPCODE;
+	auto& code = program.Code();
+	REQUIRE(code.size() == 5);
+	CHECK(code[0].opcode == OPCODE::CONSTANT);
+	CHECK(code[1].opcode == OPCODE::CONSTANT);
+	CHECK(code[2].opcode == OPCODE::CONSTANT);
+	CHECK(code[3].opcode == OPCODE::CALL);
+	CHECK(code[3].function == FORMULA_PROGRAM::FUNCTION_ID::PRODUCT);
+	CHECK(code[4].opcode == OPCODE::CALL);
+	CHECK(code[4].argumentCount == 2);
+	CHECK(program.Run(anchor, NoReferences).value == 7.0);
+}
+
+TEST_CASE("Formula Loads Each Reference Through The Loader") {
+	auto program = FORMULA_PROGRAM::Compile("AVERAGE(&R1C2, &R3C4, &R1C2)", anchor);
+	REQUIRE(program.References(anchor).size() == 2);		// Repeated references are listed once
+	CHECK(program.References(anchor)[0] == CELL::CELL_POSITION{ 2, 1 });
+	CHECK(program.References(anchor)[1] == CELL::CELL_POSITION{ 4, 3 });
+
+	auto loads = 0;
+	auto result = program.Run(anchor, [&loads](const CELL::CELL_POSITION pos) { ++loads; return FORMULA_PROGRAM::RESULT{ double(pos.column) }; });
+	CHECK(loads == 3);
+	CHECK(result.error == nullptr);
+	CHECK(result.value == 8.0 / 3);
+}
+
+TEST_CASE("Formula Stops At The First Failed Load") {
+	auto program = FORMULA_PROGRAM::Compile("SUM(&R1C1, INVERSE(&R2C1))", anchor);
+	auto result = program.Run(anchor, NoReferences);
+	REQUIRE(result.error != nullptr);
+	CHECK(std::string{ result.error } == "Reference Error");
+}
+
+TEST_CASE("Formula Rejects Malformed Text When Compiled") {
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("SUM()", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("INVERSE(1, 2)", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("PI(1)", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("SUM(1", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("#", anchor), std::invalid_argument);
+	CHECK(FORMULA_PROGRAM::Compile("PI()", anchor).Run(anchor, NoReferences).value == 3.14159);
+}
+
+TEST_CASE("Formula Applies Operator Precedence And Parentheses") {
+	CHECK(FORMULA_PROGRAM::Compile("1 + 2 * 3", anchor).Run(anchor, NoReferences).value == 7.0);
+	CHECK(FORMULA_PROGRAM::Compile("(1 + 2) * 3", anchor).Run(anchor, NoReferences).value == 9.0);
+	CHECK(FORMULA_PROGRAM::Compile("8 - 4 - 2", anchor).Run(anchor, NoReferences).value == 2.0);		// Left associative
+	CHECK(FORMULA_PROGRAM::Compile("8 / 4 / 2", anchor).Run(anchor, NoReferences).value == 1.0);
+	CHECK(FORMULA_PROGRAM::Compile("-2 * -(1 + 2)", anchor).Run(anchor, NoReferences).value == 6.0);
+	CHECK(FORMULA_PROGRAM::Compile("SUM(1, 2 * 3, (4))", anchor).Run(anchor, NoReferences).value == 11.0);
+}
+
+TEST_CASE("Formula Mixes Functions, References And Operators") {
+	auto program = FORMULA_PROGRAM::Compile("SUM(&R1C1, 2) * (3 + &R2C2) / 4", anchor);
+	auto result = program.Run(anchor, [](const CELL::CELL_POSITION pos) { return FORMULA_PROGRAM::RESULT{ pos.row == 1 ? 6.0 : 5.0 }; });
+	CHECK(result.error == nullptr);
+	CHECK(result.value == 16.0);
+}
+
+TEST_CASE("Formula Rejects Malformed Operators") {
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("1 +", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("(1 + 2", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("1 2", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("&R1", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile(std::string(1000, '(') + "1" + std::string(1000, ')'), anchor), std::invalid_argument);
+}
+
+TEST_CASE("Formula Accepts Any Run Of Signs") {
+	CHECK(FORMULA_PROGRAM::Compile("--2 + -+3 + +-4", anchor).Run(anchor, NoReferences).value == -5.0);
+	CHECK(FORMULA_PROGRAM::Compile(std::string(300001, '-') + "1", anchor).Run(anchor, NoReferences).value == -1.0);		// Far past the nesting limit
+	CHECK(FORMULA_PROGRAM::Compile(std::string(300000, '+') + "-(1)", anchor).Run(anchor, NoReferences).value == -1.0);
+}
+
+TEST_CASE("Formulas Differing Only By Position Share A Canonical Form") {
+	CHECK(FORMULA_PROGRAM::Canonical("SUM(&R1C1, &R1C2)", { 3, 1 }) == FORMULA_PROGRAM::Canonical("SUM(&R2C1,&R2C2)", { 3, 2 }));
+	CHECK(FORMULA_PROGRAM::Canonical("SUM(&R1C1, &R1C2)", { 3, 1 }) != FORMULA_PROGRAM::Canonical("SUM(&R1C1, &R1C2)", { 3, 2 }));
+	CHECK(FORMULA_PROGRAM::Canonical("1 2", anchor) != FORMULA_PROGRAM::Canonical("12", anchor));
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Canonical("&R0C1", anchor), std::invalid_argument);
+}
+
+TEST_CASE("Formula Cache Shares Programs Between Anchors") {
+	auto cache = FORMULA_CACHE{ };
+	auto first = cache.Get("&R1C1 * 2", { 2, 1 });
+	auto second = cache.Get("&R2C1 * 2", { 2, 2 });
+	auto other = cache.Get("&R2C1 * 3", { 2, 2 });
+	CHECK(first == second);
+	CHECK(first != other);
+	CHECK(cache.Size() == 2);
+	CHECK(second->References({ 2, 2 })[0] == CELL::CELL_POSITION{ 1, 2 });
+
+	first.reset(); second.reset();
+	CHECK(cache.Size() == 1);		// Entries only live while some cell uses them
+}
+
+TEST_CASE("Formula Gathers Ranges For Aggregate Functions") {
+	auto load = [](const CELL::CELL_POSITION pos) { return FORMULA_PROGRAM::RESULT{ double(pos.row) }; };		// Value of each cell is its row
+	CHECK(FORMULA_PROGRAM::Compile("SUM(&R1C1:R100C1)", anchor).Run(anchor, load).value == 5050.0);
+	CHECK(FORMULA_PROGRAM::Compile("SUM(&R100C1:&R1C1, 1)", anchor).Run(anchor, load).value == 5051.0);		// Corners in either order
+	CHECK(FORMULA_PROGRAM::Compile("AVERAGE(&R1C1:R3C2)", anchor).Run(anchor, load).value == 2.0);
+	CHECK(FORMULA_PROGRAM::Compile("PRODUCT(&R1C1:R5C1)", anchor).Run(anchor, load).value == 120.0);
+	CHECK(FORMULA_PROGRAM::Compile("MIN(&R3C1:R9C1, 7)", anchor).Run(anchor, load).value == 3.0);
+	CHECK(FORMULA_PROGRAM::Compile("MAX(&R3C1:R9C1, 7)", anchor).Run(anchor, load).value == 9.0);
+	CHECK(FORMULA_PROGRAM::Compile("COUNT(&R1C1:R10C3)", anchor).Run(anchor, load).value == 30.0);
+	CHECK(FORMULA_PROGRAM::Compile("SUM(&R1C1:R4C1) * 2 + SUM(1, SUM(&R1C1:R2C1))", anchor).Run(anchor, load).value == 24.0);
+}
+
+TEST_CASE("Formula Rejects Misplaced Ranges") {
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("&R1C1:R2C1 + 1", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("SUM(&R1C1:R2C1 + 1)", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("INVERSE(&R1C1:R2C1)", anchor), std::invalid_argument);
+	CHECK_THROWS_AS(FORMULA_PROGRAM::Compile("SUM(&R1C1:R65535C100)", anchor), std::invalid_argument);		// Too large
+	CHECK(FORMULA_PROGRAM::Canonical("SUM(&R1C1:R2C1)", { 2, 1 }) == FORMULA_PROGRAM::Canonical("SUM(&R2C1:R3C1)", { 2, 2 }));
+}
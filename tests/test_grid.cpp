@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Slot_Grid.hpp"
+#include <vector>
+
+using GRID = SLOT_GRID<const int*, CELL::CELL_POSITION>;
+
+TEST_CASE("Grid Finds Nothing Before First Write") {
+	auto grid = GRID{ };
+	CHECK(grid.Find({ 1, 1 }) == nullptr);
+	CHECK(grid.Size() == 0);
+}
+
+TEST_CASE("Grid Stores And Erases Values") {
+	auto grid = GRID{ };
+	auto position = CELL::CELL_POSITION{ 3, 70 };
+	auto seven = 7, eight = 8;
+	CHECK(grid.Assign(position, &seven) == nullptr);
+	REQUIRE(grid.Find(position) != nullptr);
+	CHECK(*grid.Find(position) == 7);
+	CHECK(grid.Size() == 1);
+	CHECK(grid.Assign(position, &eight) == &seven);		// The word replaced is handed back
+	CHECK(grid.Size() == 1);
+
+	CHECK(grid.Erase(position) == &eight);
+	CHECK(grid.Size() == 0);
+	CHECK(grid.Find(position) == nullptr);				// Emptied tile is released
+	CHECK(grid.Erase(position) == nullptr);
+}
+
+TEST_CASE("Grid Keeps Neighbouring Tiles Independent") {
+	auto grid = GRID{ };
+	auto lastInTile = CELL::CELL_POSITION{ GRID::TileSize - 1, GRID::TileSize - 1 };
+	auto firstInNext = CELL::CELL_POSITION{ GRID::TileSize, GRID::TileSize };
+	auto one = 1, two = 2;
+	grid.Assign(lastInTile, &one);
+	grid.Assign(firstInNext, &two);
+	grid.Erase(lastInTile);
+	CHECK(grid.Find(lastInTile) == nullptr);
+	REQUIRE(grid.Find(firstInNext) != nullptr);
+	CHECK(*grid.Find(firstInNext) == 2);
+}
+
+TEST_CASE("Grid Covers Full Position Range") {
+	auto grid = GRID{ };
+	auto corner = CELL::CELL_POSITION{ MaxColumn_, MaxRow_ };
+	auto nine = 9, zero = 0;
+	grid.Assign(corner, &nine);
+	REQUIRE(grid.Find(corner) != nullptr);
+	CHECK(*grid.Find(corner) == 9);
+	CHECK(grid.Find({ MaxColumn_ + 1, 1 }) == nullptr);
+	CHECK_THROWS(grid.Assign({ MaxColumn_ + 1, 1 }, &zero));
+}
+
+TEST_CASE("Grid Visits Columns In Order Within A Tile") {
+	auto grid = GRID{ };
+	auto one = 1, two = 2, three = 3;
+	grid.Assign({ 2, 1 }, &three);
+	grid.Assign({ 1, 2 }, &two);
+	grid.Assign({ 1, 1 }, &one);
+	auto visited = std::vector<int>{ };
+	grid.ForEachIn({ 0, 0 }, { MaxColumn_, MaxRow_ }, [&visited](CELL::CELL_POSITION, const int* value) { visited.push_back(*value); });
+	CHECK(visited == std::vector<int>{ 1, 2, 3 });
+}
+
+TEST_CASE("Grid Visits Only The Requested Rectangle") {
+	auto grid = GRID{ };
+	auto values = std::vector<int>(4 * 1000);
+	for (auto c = 1u; c <= 3; ++c) {
+		for (auto r = 1u; r <= 200; r += 3) { values[c * 1000 + r] = int(c * 1000 + r); grid.Assign({ c, r }, &values[c * 1000 + r]); }
+	}
+	grid.Assign({ 70, 70 }, &values[0]);		// Outside the rectangle, in another tile
+
+	auto visited = std::vector<CELL::CELL_POSITION>{ };
+	grid.ForEachIn({ 2, 60 }, { 3, 130 }, [&visited](const CELL::CELL_POSITION pos, const int* value) {
+		CHECK(*value == int(pos.column * 1000 + pos.row));
+		visited.push_back(pos);
+	});
+	REQUIRE(visited.size() == 2 * 24);		// Rows 61, 64, ... 130 in each column
+	CHECK(visited.front() == CELL::CELL_POSITION{ 2, 61 });
+	CHECK(visited.back() == CELL::CELL_POSITION{ 3, 130 });
+	for (auto i = size_t{ 1 }; i < visited.size(); ++i) {		// Column-major order
+		auto& a = visited[i - 1]; auto& b = visited[i];
+		CHECK((a.column < b.column || (a.column == b.column && a.row < b.row)));
+	}
+}
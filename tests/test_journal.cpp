@@ -0,0 +1,265 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Journal.hpp"
+#include "Table.hpp"
+#include "Workbook_File.hpp"
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace {
+	// Ignores every call. Recovery only needs somewhere to send its notifications.
+	class SILENT_TABLE : public TABLE_BASE {
+	public:
+		void InitializeTable() override { }
+		void Redraw() const override { }
+		void Undo() const override { }
+		void Redo() const override { }
+		CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override { return CELL::CELL_PROXY{ nullptr }; }
+		void UpdateCell(const CELL::CELL_POSITION) const override { }
+		void UpdateCells(std::span<const CELL::CELL_POSITION>) const override { }
+	protected:
+		void Resize() override { }
+		void AddRow() override { }
+		void AddColumn() override { }
+		void RemoveRow() override { }
+		void RemoveColumn() override { }
+		unsigned int GetNumColumns() const override { return 0; }
+		unsigned int GetNumRows() const override { return 0; }
+		void FocusCell(const CELL::CELL_POSITION) const override { }
+		void UnfocusCell(const CELL::CELL_POSITION) const override { }
+		void FocusEntryBox() const override { }
+		void UnfocusEntryBox(const CELL::CELL_POSITION) const override { }
+		void FocusUp1(const CELL::CELL_POSITION) const override { }
+		void FocusDown1(const CELL::CELL_POSITION) const override { }
+		void FocusRight1(const CELL::CELL_POSITION) const override { }
+		void FocusLeft1(const CELL::CELL_POSITION) const override { }
+		void LockTargetCell(const CELL::CELL_POSITION) const override { }
+		void ReleaseTargetCell() const override { }
+		CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
+	};
+
+	std::string TempPath(const std::string& name) {
+		auto path = (std::filesystem::temp_directory_path() / name).string();
+		std::filesystem::remove(path);
+		std::filesystem::remove(JOURNAL::PathFor(path));
+		return path;
+	}
+
+	void Remove(const std::string& path) {
+		std::filesystem::remove(path);
+		std::filesystem::remove(JOURNAL::PathFor(path));
+	}
+
+	// What a crash would leave behind: the files as they are on disk right now, while the journal is still attached.
+	void CopyFiles(const std::string& from, const std::string& to) {
+		if (std::filesystem::exists(from)) { std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing); }
+		std::filesystem::copy_file(JOURNAL::PathFor(from), JOURNAL::PathFor(to), std::filesystem::copy_options::overwrite_existing);
+	}
+
+	void RequireSameCells(CELL::CELL_DATA& expected, CELL::CELL_DATA& actual) {
+		for (auto c = 1u; c <= 4; ++c) {
+			for (auto r = 1u; r <= 5; ++r) {
+				auto lhs = expected.GetCellView({ c, r });
+				auto rhs = actual.GetCellView({ c, r });
+				REQUIRE(bool{ lhs } == bool{ rhs });
+				if (!lhs) { continue; }
+				CHECK(lhs->GetRawContent() == rhs->GetRawContent());
+				CHECK(lhs->GetValue() == rhs->GetValue());
+			}
+		}
+	}
+
+	double Number(const CELL::CELL_DATA& cellData, const CELL::CELL_POSITION pos) { return std::get<double>(cellData.GetCellView(pos)->GetValue()); }
+}
+
+TEST_CASE("Journal Recovers Every Change After A Crash") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal.sheet");
+	auto crashed = TempPath("journal_crashed.sheet");
+	auto original = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ original, path };
+
+	CELL::NewCell(&original, { 1, 1 }, "2");
+	CELL::NewCell(&original, { 1, 2 }, "3");
+	CELL::NewCell(&original, { 2, 1 }, "=SUM(&R1C1:R2C1) * 2");
+	CELL::NewCell(&original, { 2, 2 }, "12abc");					// Falls back to text
+	auto before = journal.SyncCount();
+	{
+		auto batch = CELL::BATCH{ &original };
+		batch.NewCell({ 3, 1 }, "&R1C2");
+		batch.NewCell({ 3, 2 }, "words");
+		batch.NewCell({ 1, 2 }, "5");
+		batch.Commit();
+	}
+	CHECK(journal.SyncCount() == before + 1);						// One frame for the whole batch
+	auto erased = CELL::NewCell(&original, { 3, 2 }, "gone");
+	CELL::NewCell(&original, { 3, 2 }, "");
+	CELL::RecreateCell(&original, erased, { 3, 2 });				// As undo does
+	CELL::NewCell(&original, { 1, 3 }, "7");
+	CELL::NewCell(&original, { 1, 3 }, "");
+
+	CopyFiles(path, crashed);										// Every change has returned, so every change is on disk
+	auto recovered = CELL::CELL_DATA{ };
+	auto recoveredJournal = JOURNAL{ recovered, crashed };
+	RequireSameCells(original, recovered);
+	CHECK(Number(recovered, { 3, 1 }) == 14.0);
+	CHECK(recovered.GetCellView({ 2, 2 })->GetRawContent() == "'12abc");
+
+	CELL::NewCell(&recovered, { 1, 1 }, "10");						// Recalculates as before
+	CHECK(Number(recovered, { 3, 1 }) == 30.0);
+	Remove(path);
+	Remove(crashed);
+}
+
+TEST_CASE("Journal Drops A Torn Frame") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal_torn.sheet");
+	auto crashed = TempPath("journal_torn_crashed.sheet");
+	{
+		auto original = CELL::CELL_DATA{ };
+		auto journal = JOURNAL{ original, path };
+		CELL::NewCell(&original, { 1, 1 }, "1");
+		CELL::NewCell(&original, { 1, 2 }, "=&R1C1 + 1");
+		CELL::NewCell(&original, { 1, 1 }, "41");
+		CopyFiles(path, crashed);
+	}
+	std::filesystem::resize_file(JOURNAL::PathFor(crashed), std::filesystem::file_size(JOURNAL::PathFor(crashed)) - 3);		// The last frame was cut short
+
+	{
+		auto recovered = CELL::CELL_DATA{ };
+		auto journal = JOURNAL{ recovered, crashed };
+		CHECK(Number(recovered, { 1, 1 }) == 1.0);
+		CHECK(Number(recovered, { 1, 2 }) == 2.0);
+		CELL::NewCell(&recovered, { 2, 1 }, "=&R2C1 * 3");			// Written where the torn frame was
+	}
+	auto recovered = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ recovered, crashed };
+	CHECK(Number(recovered, { 2, 1 }) == 6.0);
+
+	auto damaged = std::ofstream{ JOURNAL::PathFor(path), std::ios::binary | std::ios::trunc };
+	damaged << "not a journal at all";
+	damaged.close();
+	auto other = CELL::CELL_DATA{ };
+	CHECK_THROWS_AS(JOURNAL(other, path), std::runtime_error);
+	Remove(path);
+	Remove(crashed);
+}
+
+TEST_CASE("Journal Compacts Into The Workbook") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal_compact.sheet");
+	auto original = CELL::CELL_DATA{ };
+	{
+		auto journal = JOURNAL{ original, path, std::chrono::milliseconds{ 0 }, 256 };
+		for (auto r = 1u; r <= 40; ++r) { CELL::NewCell(&original, { 1, r }, std::to_string(r)); }
+		CELL::NewCell(&original, { 2, 1 }, "=SUM(&R1C1:R40C1)");
+		journal.Flush();
+		journal.WaitForCompaction();
+		CHECK(journal.CompactionCount() != 0);
+		CHECK(journal.Size() < 256);
+		CHECK(std::filesystem::file_size(JOURNAL::PathFor(path)) == journal.Size());
+		CELL::NewCell(&original, { 1, 41 }, std::string(300, 'x'));		// Outgrows the journal alone, so whatever came before is compacted too
+		journal.Flush();
+		journal.WaitForCompaction();
+		CELL::NewCell(&original, { 1, 1 }, "101");
+	}
+
+	auto saved = CELL::CELL_DATA{ };
+	WORKBOOK_FILE::Load(saved, path);								// The workbook alone holds what was compacted
+	CHECK(Number(saved, { 1, 40 }) == 40.0);
+	CHECK(saved.GetCellView({ 1, 41 })->GetRawContent() == std::string(300, 'x'));
+
+	auto recovered = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ recovered, path };
+	RequireSameCells(original, recovered);
+	CHECK(Number(recovered, { 2, 1 }) == 920.0);
+	Remove(path);
+}
+
+TEST_CASE("Journal Reports A Failed Compaction") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal_failed.sheet");
+	auto original = CELL::CELL_DATA{ };
+	{
+		auto journal = JOURNAL{ original, path, std::chrono::milliseconds{ 0 }, 256 };
+		auto damaged = std::ofstream{ path, std::ios::binary | std::ios::trunc };		// Compaction cannot read the workbook back
+		damaged << "not a workbook at all";
+		damaged.close();
+		for (auto r = 1u; r <= 40; ++r) { CELL::NewCell(&original, { 1, r }, std::to_string(r)); }
+		journal.Flush();
+		journal.WaitForCompaction();
+		CHECK(journal.CompactionCount() == 0);
+		CHECK(journal.CompactionFailures() != 0);
+		CHECK_FALSE(journal.CompactionError().empty());
+		CHECK(journal.Size() >= 256);										// Still holds every edit
+
+		std::filesystem::remove(path);
+		CELL::NewCell(&original, { 1, 41 }, std::string(300, 'x'));			// Outgrows the journal again, so compaction is retried
+		journal.Flush();
+		journal.WaitForCompaction();
+		CHECK(journal.CompactionCount() == 1);
+		CHECK(journal.Size() < 256);
+	}
+	auto recovered = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ recovered, path };
+	CHECK(Number(recovered, { 1, 40 }) == 40.0);
+	Remove(path);
+}
+
+#ifndef _WIN32
+TEST_CASE("Journal Refuses Edits Once A Write Fails") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal_write_failed.sheet");
+	auto original = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ original, path };
+	CELL::NewCell(&original, { 1, 1 }, "1");
+	CHECK_FALSE(journal.Failed());
+
+	auto limit = rlimit{ };											// Files may grow no further, so the next frame cannot be written
+	getrlimit(RLIMIT_FSIZE, &limit);
+	auto previous = signal(SIGXFSZ, SIG_IGN);
+	auto capped = limit;
+	capped.rlim_cur = journal.Size();
+	setrlimit(RLIMIT_FSIZE, &capped);
+	CELL::NewCell(&original, { 1, 2 }, "2");						// Returns, since the change is already made
+	setrlimit(RLIMIT_FSIZE, &limit);
+	signal(SIGXFSZ, previous);
+
+	CHECK(journal.Failed());
+	CHECK_THROWS_AS(journal.Flush(), std::runtime_error);
+	CHECK_THROWS_AS(CELL::NewCell(&original, { 1, 3 }, "3"), std::runtime_error);
+	CHECK_FALSE(bool{ original.GetCellView({ 1, 3 }) });			// Refused before anything changed
+	Remove(path);
+}
+#endif
+
+TEST_CASE("Journal Groups Syncs Within Its Window") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("journal_group.sheet");
+	auto original = CELL::CELL_DATA{ };
+	{
+		auto journal = JOURNAL{ original, path, std::chrono::milliseconds{ 200 } };
+		for (auto r = 1u; r <= 50; ++r) { CELL::NewCell(&original, { 1, r }, std::to_string(r)); }
+		journal.Flush();
+		CHECK(journal.SyncCount() < 50);
+	}
+	auto recovered = CELL::CELL_DATA{ };
+	auto journal = JOURNAL{ recovered, path };
+	CHECK(Number(recovered, { 1, 50 }) == 50.0);
+
+	auto full = CELL::CELL_DATA{ };
+	CELL::NewCell(&full, { 1, 1 }, "1");
+	CHECK_THROWS_AS(JOURNAL(full, TempPath("journal_full.sheet")), std::logic_error);
+	Remove(path);
+}
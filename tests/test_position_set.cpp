@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Position_Set.hpp"
+#include <random>
+#include <set>
+
+namespace {
+	using SET = POSITION_SET<CELL::CELL_POSITION>;
+
+	std::set<CELL::CELL_POSITION> Contents(const SET& positions) {
+		auto contents = std::set<CELL::CELL_POSITION>{ };
+		for (auto pos : positions) { REQUIRE(contents.insert(pos).second); }		// Each position visited once
+		return contents;
+	}
+}
+
+TEST_CASE("Position Set Grows Through Each Form") {
+	auto positions = SET{ };
+	auto expected = std::set<CELL::CELL_POSITION>{ };
+	for (auto r = 1u; r <= 1000; ++r) {
+		CHECK(positions.insert({ 3, r }));
+		CHECK_FALSE(positions.insert({ 3, r }));
+		expected.insert({ 3, r });
+		if (r == 2 || r == 16 || r == 17 || r == 1000) { CHECK(Contents(positions) == expected); }		// Inline, linear & hashed
+	}
+	CHECK(positions.size() == 1000);
+	CHECK(positions.contains({ 3, 500 }));
+	CHECK_FALSE(positions.contains({ 4, 500 }));
+
+	auto copy = positions;
+	for (auto r = 1u; r <= 1000; ++r) { CHECK(positions.erase({ 3, r }) == 1); }
+	CHECK(positions.empty());
+	CHECK(positions.HeapUsage() == 0);
+	CHECK(Contents(copy) == expected);
+}
+
+TEST_CASE("Position Set Matches std::set Under Random Edits") {
+	auto positions = SET{ };
+	auto expected = std::set<CELL::CELL_POSITION>{ };
+	auto random = std::mt19937{ 77 };
+	auto coordinate = std::uniform_int_distribution<unsigned int>{ 65500, 65535 };		// Includes the largest packable position
+
+	for (auto step = 0; step < 20000; ++step) {
+		auto pos = CELL::CELL_POSITION{ coordinate(random), coordinate(random) };
+		if (random() % 2) { REQUIRE(positions.insert(pos) == expected.insert(pos).second); }
+		else { REQUIRE(positions.erase(pos) == expected.erase(pos)); }
+		REQUIRE(positions.size() == expected.size());
+		if (step % 500 == 0) { REQUIRE(Contents(positions) == expected); }
+	}
+	for (auto& pos : expected) { REQUIRE(positions.contains(pos)); }
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Range_Index.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+	using POSITIONS = std::vector<CELL::CELL_POSITION>;
+
+	POSITIONS Observers(const RANGE_INDEX& index, const CELL::CELL_POSITION pos) {
+		auto found = POSITIONS{ };
+		index.Query(pos, [&found](const RANGE_INDEX::ENTRY& entry) { found.push_back(entry.observer); });
+		std::sort(found.begin(), found.end());
+		return found;
+	}
+}
+
+TEST_CASE("Range Index Finds Covering Ranges") {
+	auto index = RANGE_INDEX{ };
+	CHECK(index.Insert({ 1, 1 }, { 1, 100 }, { 2, 1 }));
+	CHECK(index.Insert({ 1, 50 }, { 3, 60 }, { 5, 5 }));
+	CHECK_FALSE(index.Insert({ 1, 1 }, { 1, 100 }, { 2, 1 }));		// Already present
+	CHECK(index.Size() == 2);
+
+	CHECK(Observers(index, { 1, 1 }) == POSITIONS{ { 2, 1 } });
+	CHECK(Observers(index, { 1, 55 }) == POSITIONS{ { 2, 1 }, { 5, 5 } });
+	CHECK(Observers(index, { 3, 60 }) == POSITIONS{ { 5, 5 } });
+	CHECK(Observers(index, { 2, 101 }).empty());
+
+	CHECK(index.Erase({ 1, 1 }, { 1, 100 }, { 2, 1 }));
+	CHECK_FALSE(index.Erase({ 1, 1 }, { 1, 100 }, { 2, 1 }));
+	CHECK(Observers(index, { 1, 55 }) == POSITIONS{ { 5, 5 } });
+	CHECK(index.Size() == 1);
+}
+
+TEST_CASE("Range Index Matches Brute Force Under Random Edits") {
+	auto index = RANGE_INDEX{ };
+	auto entries = std::vector<RANGE_INDEX::ENTRY>{ };
+	auto random = std::mt19937{ 2024 };
+	auto coordinate = std::uniform_int_distribution<unsigned int>{ 1, 40 };
+
+	for (auto step = 0; step < 3000; ++step) {
+		if (!entries.empty() && random() % 3 == 0) {
+			auto i = random() % entries.size();
+			REQUIRE(index.Erase(entries[i].first, entries[i].last, entries[i].observer));
+			entries.erase(entries.begin() + i);
+		}
+		else {
+			auto a = CELL::CELL_POSITION{ coordinate(random), coordinate(random) };
+			auto b = CELL::CELL_POSITION{ coordinate(random), coordinate(random) };
+			auto entry = RANGE_INDEX::ENTRY{ { std::min(a.column, b.column), std::min(a.row, b.row) }, { std::max(a.column, b.column), std::max(a.row, b.row) }, { 50, unsigned(step) } };
+			REQUIRE(index.Insert(entry.first, entry.last, entry.observer));
+			entries.push_back(entry);
+		}
+
+		auto pos = CELL::CELL_POSITION{ coordinate(random), coordinate(random) };
+		auto expected = POSITIONS{ };
+		for (auto& entry : entries) { if (entry.Contains(pos)) { expected.push_back(entry.observer); } }
+		std::sort(expected.begin(), expected.end());
+		REQUIRE(Observers(index, pos) == expected);
+	}
+	CHECK(index.Size() == entries.size());
+}
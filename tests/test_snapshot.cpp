@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Snapshot.hpp"
+#include <map>
+#include <optional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using ENTRY = SHEET_SNAPSHOT::ENTRY;
+
+	std::shared_ptr<const ENTRY> Entry(const CELL::CELL_POSITION pos, const double value) { return std::make_shared<const ENTRY>(pos, value); }
+
+	std::map<CELL::CELL_POSITION, double> Contents(const SHEET_SNAPSHOT& snapshot) {
+		auto contents = std::map<CELL::CELL_POSITION, double>{ };
+		auto previous = std::optional<CELL::CELL_POSITION>{ };
+		snapshot.ForEach([&contents, &previous](const ENTRY& entry) {
+			if (previous) { REQUIRE(*previous < entry.position); }		// Column by column
+			previous = entry.position;
+			contents[entry.position] = std::get<double>(entry.Value());
+		});
+		return contents;
+	}
+}
+
+TEST_CASE("Snapshot Versions Leave Earlier Versions Untouched") {
+	auto empty = std::make_shared<const SHEET_SNAPSHOT>();
+	auto first = empty->Apply({ { { 1, 1 }, Entry({ 1, 1 }, 1) }, { { 65535, 65535 }, Entry({ 65535, 65535 }, 2) } });
+	auto second = first->Apply({ { { 1, 1 }, Entry({ 1, 1 }, 10) }, { { 65535, 65535 }, nullptr }, { { 3, 7 }, Entry({ 3, 7 }, 3) } });
+
+	CHECK(empty->Size() == 0);
+	CHECK(first->Version() == 1);
+	CHECK(second->Version() == 2);
+	CHECK(Contents(*first) == std::map<CELL::CELL_POSITION, double>{ { { 1, 1 }, 1 }, { { 65535, 65535 }, 2 } });
+	CHECK(Contents(*second) == std::map<CELL::CELL_POSITION, double>{ { { 1, 1 }, 10 }, { { 3, 7 }, 3 } });
+	CHECK(second->Find({ 65535, 65535 }) == nullptr);
+	CHECK(std::get<double>(second->Find({ 3, 7 })->Value()) == 3);
+	CHECK(second->Find({ 3, 8 }) == nullptr);
+}
+
+TEST_CASE("Snapshot Matches std::map Under Random Edits") {
+	auto snapshot = std::make_shared<const SHEET_SNAPSHOT>();
+	auto expected = std::map<CELL::CELL_POSITION, double>{ };
+	auto history = std::vector<std::pair<std::shared_ptr<const SHEET_SNAPSHOT>, std::map<CELL::CELL_POSITION, double>>>{ };
+	auto random = std::mt19937{ 99 };
+	auto column = std::uniform_int_distribution<unsigned int>{ 1, 70 };
+	auto row = std::uniform_int_distribution<unsigned int>{ 1, 3000 };
+
+	for (auto step = 0; step < 300; ++step) {
+		auto changes = std::vector<SHEET_SNAPSHOT::CHANGE>{ };
+		for (auto i = 0; i < 20; ++i) {
+			auto pos = CELL::CELL_POSITION{ column(random), row(random) };
+			if (random() % 4 == 0) { changes.emplace_back(pos, nullptr); expected.erase(pos); }
+			else { auto value = double(step * 100 + i); changes.emplace_back(pos, Entry(pos, value)); expected[pos] = value; }
+		}
+		snapshot = snapshot->Apply(changes);
+		REQUIRE(snapshot->Size() == expected.size());
+		if (step % 30 == 0) { history.emplace_back(snapshot, expected); }
+	}
+	for (auto& [version, contents] : history) { REQUIRE(Contents(*version) == contents); }		// Old versions unaffected by later ones
+
+	auto inside = std::vector<CELL::CELL_POSITION>{ };
+	snapshot->ForEachIn({ 10, 100 }, { 12, 200 }, [&inside](const ENTRY& entry) { inside.push_back(entry.position); });
+	auto expectedInside = std::vector<CELL::CELL_POSITION>{ };
+	for (auto& [pos, value] : expected) { if (pos.column >= 10 && pos.column <= 12 && pos.row >= 100 && pos.row <= 200) { expectedInside.push_back(pos); } }
+	CHECK(inside == expectedInside);
+}
@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Thread_Pool.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Thread Pool Runs Every Index Once") {
+	for (auto workers : { 0u, 1u, 4u }) {
+		auto pool = THREAD_POOL{ workers };
+		auto hits = std::vector<std::atomic<int>>(10000);
+		pool.ParallelFor(hits.size(), [&hits](std::size_t i) { ++hits[i]; }, 7);
+		auto allOnce = true;
+		for (auto& hit : hits) { if (hit != 1) { allOnce = false; } }
+		CHECK(allOnce);
+		CHECK(pool.WorkerCount() == workers);
+	}
+}
+
+TEST_CASE("Thread Pool Rethrows Task Exceptions") {
+	auto pool = THREAD_POOL{ 3 };
+	auto run = [&pool] { pool.ParallelFor(1000, [](std::size_t i) { if (i == 500) { throw std::runtime_error{ "task failed" }; } }); };
+	CHECK_THROWS_AS(run(), std::runtime_error);
+
+	auto count = std::atomic<std::size_t>{ 0 };		// Pool is still usable afterwards
+	pool.ParallelFor(1000, [&count](std::size_t) { ++count; });
+	CHECK(count == 1000);
+}
+
+TEST_CASE("Thread Pool Runs Nested Calls Serially") {
+	auto pool = THREAD_POOL{ 2 };
+	auto count = std::atomic<std::size_t>{ 0 };
+	pool.ParallelFor(100, [&pool, &count](std::size_t) { pool.ParallelFor(10, [&count](std::size_t) { ++count; }); });
+	CHECK(count == 1000);
+}
+
+TEST_CASE("Thread Pool Finishes Short Batches Back To Back") {
+	auto pool = THREAD_POOL{ 4 };
+	auto count = std::atomic<std::size_t>{ 0 };
+	for (auto round = 0; round < 2000; ++round) { pool.ParallelFor(8, [&count](std::size_t) { ++count; }); }		// Each batch lives on the caller's stack
+	CHECK(count == 16000);
+}
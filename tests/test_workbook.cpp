@@ -0,0 +1,218 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Cell.hpp"
+#include "Snapshot.hpp"
+#include "Table.hpp"
+#include "Workbook_File.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	// Ignores every call. Loading only needs somewhere to send its notifications.
+	class SILENT_TABLE : public TABLE_BASE {
+	public:
+		void InitializeTable() override { }
+		void Redraw() const override { }
+		void Undo() const override { }
+		void Redo() const override { }
+		CELL::CELL_PROXY CreateNewCell(const CELL::CELL_POSITION, const std::string&) const override { return CELL::CELL_PROXY{ nullptr }; }
+		void UpdateCell(const CELL::CELL_POSITION) const override { }
+		void UpdateCells(std::span<const CELL::CELL_POSITION> positions) const override { updated += positions.size(); }
+		mutable std::size_t updated{ 0 };
+	protected:
+		void Resize() override { }
+		void AddRow() override { }
+		void AddColumn() override { }
+		void RemoveRow() override { }
+		void RemoveColumn() override { }
+		unsigned int GetNumColumns() const override { return 0; }
+		unsigned int GetNumRows() const override { return 0; }
+		void FocusCell(const CELL::CELL_POSITION) const override { }
+		void UnfocusCell(const CELL::CELL_POSITION) const override { }
+		void FocusEntryBox() const override { }
+		void UnfocusEntryBox(const CELL::CELL_POSITION) const override { }
+		void FocusUp1(const CELL::CELL_POSITION) const override { }
+		void FocusDown1(const CELL::CELL_POSITION) const override { }
+		void FocusRight1(const CELL::CELL_POSITION) const override { }
+		void FocusLeft1(const CELL::CELL_POSITION) const override { }
+		void LockTargetCell(const CELL::CELL_POSITION) const override { }
+		void ReleaseTargetCell() const override { }
+		CELL::CELL_POSITION TargetCellGet() const override { return CELL::CELL_POSITION{ }; }
+	};
+
+	std::string TempPath(const std::string& name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+	void BuildSheet(CELL::CELL_DATA& cellData) {
+		CELL::NewCell(&cellData, { 1, 1 }, "2");
+		CELL::NewCell(&cellData, { 1, 2 }, "3.5");
+		CELL::NewCell(&cellData, { 1, 3 }, "words");
+		CELL::NewCell(&cellData, { 1, 4 }, "'42");
+		CELL::NewCell(&cellData, { 2, 1 }, "=SUM(&R1C1:R2C1) * 2");
+		CELL::NewCell(&cellData, { 2, 2 }, "&R1C2");					// Copies the sum
+		CELL::NewCell(&cellData, { 2, 3 }, "=&R3C1 + 1");			// Text is an error in a formula
+		CELL::NewCell(&cellData, { 2, 4 }, "&R99C99");				// Dangling reference
+		CELL::NewCell(&cellData, { 3, 1 }, "=&R2C3");				// Loop of two
+		CELL::NewCell(&cellData, { 3, 2 }, "=&R1C3");
+		CELL::NewCell(&cellData, { 3, 3 }, "=SUM(");				// Does not compile
+		CELL::NewCell(&cellData, { 3, 4 }, "12abc");				// Falls back to text
+	}
+
+	void RequireSameCells(CELL::CELL_DATA& expected, CELL::CELL_DATA& actual) {
+		for (auto c = 1u; c <= 4; ++c) {
+			for (auto r = 1u; r <= 5; ++r) {
+				auto lhs = expected.GetCellView({ c, r });
+				auto rhs = actual.GetCellView({ c, r });
+				REQUIRE(bool{ lhs } == bool{ rhs });
+				if (!lhs) { continue; }
+				CHECK(lhs->GetRawContent() == rhs->GetRawContent());
+				CHECK(lhs->GetValue() == rhs->GetValue());
+			}
+		}
+	}
+}
+
+TEST_CASE("Workbook Round Trip Keeps Contents & Values") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("round_trip.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+
+	for (auto includeGraph : { true, false }) {
+		WORKBOOK_FILE::Save(original, path, includeGraph);
+		auto loaded = CELL::CELL_DATA{ };
+		WORKBOOK_FILE::Load(loaded, path);
+		RequireSameCells(original, loaded);
+		CHECK(loaded.RecalculationCount() == 0);				// Values come from the file
+		CHECK(loaded.Snapshot()->Size() == original.Snapshot()->Size());
+		CHECK(std::get<double>(loaded.Snapshot()->Find({ 2, 1 })->Value()) == 11.0);
+		CHECK(loaded.GetCellView({ 3, 1 })->GetOutput() == "!CIRC!");
+	}
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Loaded Workbook Recalculates As Before") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("recalculate.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+
+	for (auto includeGraph : { true, false }) {
+		WORKBOOK_FILE::Save(original, path, includeGraph);
+		auto loaded = CELL::CELL_DATA{ };
+		WORKBOOK_FILE::Load(loaded, path);
+		CELL::NewCell(&loaded, { 1, 1 }, "10");
+		CELL::NewCell(&loaded, { 1, 2 }, "1");
+		CHECK(std::get<double>(loaded.GetCellView({ 2, 1 })->GetValue()) == 22.0);
+		CHECK(std::get<double>(loaded.GetCellView({ 2, 2 })->GetValue()) == 22.0);
+
+		CELL::NewCell(&loaded, { 3, 2 }, "5");					// Break the loop
+		CHECK(std::get<double>(loaded.GetCellView({ 3, 1 })->GetValue()) == 5.0);
+		CELL::NewCell(&loaded, { 2, 3 }, "=&R3C1 + 1");		// Unchanged text, so nothing happens
+		CHECK(loaded.GetCellView({ 2, 3 })->GetOutput() == "!ERROR!");
+	}
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Workbook Load Rejects Damaged Or Newer Files") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("damaged.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+	WORKBOOK_FILE::Save(original, path);
+
+	auto patch = [&path](const std::streamoff offset, const char byte) {
+		auto file = std::fstream{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(offset);
+		file.put(byte);
+	};
+	auto loaded = CELL::CELL_DATA{ };
+	patch(offsetof(WORKBOOK_FILE::HEADER, version), WORKBOOK_FILE::Version + 1);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Load(loaded, path), std::runtime_error);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Open(loaded, path), std::runtime_error);
+	patch(offsetof(WORKBOOK_FILE::HEADER, version), WORKBOOK_FILE::Version);
+	patch(sizeof(WORKBOOK_FILE::HEADER) + offsetof(WORKBOOK_FILE::RECORD, kind), 9);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Load(loaded, path), std::runtime_error);
+	CHECK_FALSE(bool{ loaded.GetCellView({ 1, 1 }) });			// Nothing is loaded from a damaged file
+	std::filesystem::resize_file(path, 40);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Load(loaded, path), std::runtime_error);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Load(loaded, TempPath("missing.sheet")), std::runtime_error);
+
+	WORKBOOK_FILE::Save(original, path);
+	CHECK_THROWS_AS(WORKBOOK_FILE::Load(original, path), std::logic_error);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Opened Workbook Builds Cells Only When Read") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("open.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+	WORKBOOK_FILE::Save(original, path);
+
+	auto opened = CELL::CELL_DATA{ };
+	WORKBOOK_FILE::Open(opened, path);
+	CHECK(opened.HasImage());
+	CHECK(opened.CellCount() == 0);
+	CHECK(std::get<double>(opened.GetCellView({ 2, 1 })->GetValue()) == 11.0);
+	CHECK(opened.GetCellView({ 3, 1 })->GetOutput() == "!CIRC!");
+	CHECK_FALSE(bool{ opened.GetCellView({ 4, 4 }) });
+	CHECK(opened.CellCount() == 2);
+	CHECK(opened.RecalculationCount() == 0);
+
+	RequireSameCells(original, opened);
+	CHECK(opened.CellCount() == original.CellCount());
+	CHECK(opened.Snapshot()->Size() == 0);				// Nothing has been published yet
+	opened.Materialize({ 1, 1 }, { MaxColumn_, MaxRow_ });
+	CHECK(opened.Snapshot()->Size() == original.Snapshot()->Size());
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Changes Reach Opened Cells Not Yet Built") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("open_changes.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+	WORKBOOK_FILE::Save(original, path);
+
+	auto opened = CELL::CELL_DATA{ };
+	WORKBOOK_FILE::Open(opened, path);
+	CELL::NewCell(&opened, { 1, 1 }, "10");						// Read through a range, then through a reference to it
+	CHECK(opened.CellCount() == 4);								// The edit, the other cell in the range & the two downstream
+	CHECK(std::get<double>(opened.Snapshot()->Find({ 2, 1 })->Value()) == 27.0);
+	CHECK(std::get<double>(opened.Snapshot()->Find({ 2, 2 })->Value()) == 27.0);
+	CELL::NewCell(&opened, { 1, 2 }, "0.5");
+	CHECK(std::get<double>(opened.GetCellView({ 2, 2 })->GetValue()) == 21.0);
+
+	CELL::NewCell(&opened, { 3, 2 }, "5");						// Break the loop
+	CHECK(std::get<double>(opened.GetCellView({ 3, 1 })->GetValue()) == 5.0);
+	CELL::NewCell(&opened, { 1, 3 }, "");
+	CHECK_FALSE(bool{ opened.GetCellView({ 1, 3 }) });			// Erased cells are not built again
+	CELL::NewCell(&opened, { 1, 3 }, "2");
+	CHECK(std::get<double>(opened.GetCellView({ 2, 3 })->GetValue()) == 3.0);
+
+	WORKBOOK_FILE::Save(opened, path);							// Over the file it was opened from
+	auto reloaded = CELL::CELL_DATA{ };
+	WORKBOOK_FILE::Load(reloaded, path);
+	RequireSameCells(opened, reloaded);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Workbook Without Graph Opens In Full") {
+	table = std::make_unique<SILENT_TABLE>();
+	auto path = TempPath("open_no_graph.sheet");
+	auto original = CELL::CELL_DATA{ };
+	BuildSheet(original);
+	WORKBOOK_FILE::Save(original, path, false);
+
+	auto opened = CELL::CELL_DATA{ };
+	WORKBOOK_FILE::Open(opened, path);
+	CHECK_FALSE(opened.HasImage());
+	CHECK(opened.CellCount() == original.CellCount());
+	CHECK_THROWS_AS(WORKBOOK_FILE::Open(opened, path), std::logic_error);
+	std::remove(path.c_str());
+}